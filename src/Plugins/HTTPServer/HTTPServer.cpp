@@ -16,17 +16,1887 @@
  * Written by Jessica James <jessica.aj@outlook.com>
  */
 
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#if defined __linux__
+#include <cerrno>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#endif // __linux__
+#if defined HTTPSERVER_ZLIB
+#include <zlib.h>
+#endif // HTTPSERVER_ZLIB
 #include "HTTPServer.h"
 
 using namespace Jupiter::literals;
 
+struct HTTPServerPlugin::Data
+{
+	/** Token bucket limiting the rate at which a client may request content */
+	struct Bucket
+	{
+		double tokens;
+		std::chrono::steady_clock::time_point last_update;
+	};
+
+	/** Content hooked through the plugin */
+	struct Entry
+	{
+		Jupiter::HTTP::Server::Content *content;
+		HTTPServerPlugin::Page *page;
+		bool thread_safe;
+		bool coalesce;
+		double rate_limit; /** Requests per second allowed from each client; 0 for no limit */
+		double rate_limit_burst;
+		size_t active = 0;
+		std::unordered_map<std::string, Bucket> buckets; /** Keyed by client address */
+	};
+
+	/** Parsed request, queued for a worker or the main thread */
+	struct Job : HTTPServerPlugin::Request
+	{
+		uint64_t connection_id;
+		uint64_t sequence;
+		bool keep_alive;
+		bool chunked; /** True if the client accepts chunked transfer encoding (HTTP/1.1) */
+		bool coalesce = true;
+		bool probe = false; /** True if marshalled to find out whether it resolves to content hooked directly into the server */
+	};
+
+	/** Flow control shared by the writer of a streamed response and the event loop */
+	struct StreamState
+	{
+		std::mutex mutex;
+		std::condition_variable condition;
+		size_t queued = 0; /** Bytes posted to the event loop which have not been sent yet */
+		std::atomic<bool> closed{ false };
+
+		void release(size_t size);
+		void cancel();
+	};
+
+	class Writer;
+
+	/** Streamed response whose body is written once it reaches the front of its connection's pipeline */
+	struct StreamJob
+	{
+		HTTPServerPlugin::Data &data;
+		Job request;
+		Entry *entry; /** Kept active until the stream is written or discarded */
+		HTTPServerPlugin::Response response;
+
+		~StreamJob();
+	};
+
+	/** Serialized response (or part of a streamed response), posted back to the event loop */
+	struct Response
+	{
+		uint64_t connection_id;
+		uint64_t sequence;
+		std::string data;
+		bool close;
+		bool partial;
+		std::shared_ptr<StreamState> stream;
+		std::unique_ptr<StreamJob> stream_job;
+	};
+
+	/** Response slot; pipelined responses are written in request order */
+	struct Pending
+	{
+		uint64_t sequence;
+		std::chrono::steady_clock::time_point start_time;
+		bool ready;
+		bool close;
+		std::string data;
+		std::shared_ptr<StreamState> stream; /** Set once a streamed response starts; its data is sent as it arrives */
+		std::unique_ptr<StreamJob> stream_job; /** Streamed response waiting to reach the front of the pipeline */
+	};
+
+	/** Streamed data in a connection's output buffer, released once it is sent */
+	struct StreamMark
+	{
+		size_t end_offset;
+		size_t size;
+		std::shared_ptr<StreamState> stream;
+	};
+
+	struct Connection
+	{
+		int fd;
+		uint64_t id;
+		std::string address;
+		uint32_t events;
+		std::string in_buffer;
+		std::string out_buffer;
+		size_t out_offset = 0;
+		std::deque<Pending> pending;
+		uint64_t next_sequence = 0;
+		bool read_closed = false;
+		bool stop_parsing = false;
+		bool close_after_write = false;
+		bool stream_waiting = false; /** True while listed in waiting_streams */
+		std::chrono::steady_clock::time_point last_activity;
+		std::chrono::steady_clock::time_point request_start;
+		std::deque<StreamMark> stream_marks;
+
+		~Connection();
+	};
+
+	static const uint64_t listen_id = 0;
+	static const uint64_t wake_id = 1;
+
+	/** Content registry; shared between the main thread and the workers */
+	std::mutex registry_mutex;
+	std::condition_variable registry_condition;
+	std::unordered_map<std::string, std::unique_ptr<Entry>> registry;
+
+	/** Requests waiting on an identical request which is being executed, keyed by flight_key(); guarded by registry_mutex */
+	std::unordered_map<std::string, std::vector<Job>> flights;
+
+	/** Server which content is also hooked into; only accessed from the main thread */
+	Jupiter::HTTP::Server *server = nullptr;
+
+	/** Requests which miss the registry are only marshalled to the main thread once content may have been hooked directly into the server
+	* (i.e: getHTTPServer() was called), and then only if they resolved when last executed there; misses are otherwise answered by the workers.
+	* Guarded by registry_mutex */
+	bool foreign_content = false;
+	std::unordered_map<std::string, bool> unregistered; /** Keyed by make_key(); true if the request resolved when last executed */
+	std::unordered_map<std::string, std::chrono::steady_clock::time_point> unregistered_times; /** When each result was learned */
+	size_t probes = 0; /** Misses marshalled to the main thread whose results are not yet known */
+	void learn_unregistered(const Job &request, bool resolved);
+	void forget_unregistered();
+
+	/** Settings */
+	size_t worker_count;
+	size_t max_connections;
+	size_t max_request_size;
+	size_t max_pipeline;
+	std::chrono::steady_clock::duration request_timeout;
+	std::chrono::steady_clock::duration keep_alive_timeout;
+	int compression_level;
+	size_t compression_min_size;
+	size_t stream_block_size;
+	size_t max_streams;
+	std::chrono::steady_clock::duration stream_timeout;
+
+	/** Threads and queues */
+	std::atomic<bool> running{ false };
+	int listen_fd = -1;
+	int epoll_fd = -1;
+	int wake_fd = -1;
+	std::thread loop_thread;
+	std::vector<std::thread> workers;
+	std::mutex job_mutex;
+	std::condition_variable job_condition;
+	std::deque<Job> jobs;
+	std::deque<std::unique_ptr<StreamJob>> stream_jobs;
+	std::atomic<size_t> active_streams{ 0 };
+	std::mutex main_mutex;
+	std::deque<Job> main_jobs;
+	std::mutex response_mutex;
+	std::vector<Response> responses;
+
+	/** Only accessed from the event loop thread */
+	std::unordered_map<uint64_t, std::unique_ptr<Connection>> connections;
+	std::deque<uint64_t> waiting_streams; /** Connections whose next stream waits for MaxStreams */
+	uint64_t next_connection_id = wake_id + 1;
+
+	Entry *find(const std::string &host, const std::string &path);
+	double take_token(Entry &entry, const std::string &address);
+	void execute(Job &request, bool on_main_thread);
+	bool execute_unregistered(const Job &request);
+	void stream(const Job &request, const Jupiter::HTTP::Server::Content *content, const HTTPServerPlugin::Response &page_response, bool on_main_thread);
+	void run_stream(std::unique_ptr<StreamJob> &&job);
+	void respond(const Job &request, std::string &&data, bool close);
+	void post(Response &&response);
+	void wake();
+
+#if defined __linux__
+	bool start(const Jupiter::ReadableString &address, uint16_t port);
+	void stop();
+	void loop();
+	void worker_loop();
+	void accept_connections();
+	bool read_connection(Connection &connection);
+	void parse_requests(Connection &connection);
+	bool service(Connection &connection);
+	void start_stream(Connection &connection, Pending &pending);
+	void dispatch_streams();
+	void collect_responses();
+	void sweep(std::chrono::steady_clock::time_point now);
+#endif // __linux__
+};
+
+/** Helpers */
+
+static std::string normalize_url(const char *path, size_t path_size, const char *name = nullptr, size_t name_size = 0)
+{
+	std::string url;
+	url.reserve(path_size + name_size + 2);
+	url += '/';
+
+	auto append = [&url](const char *ptr, size_t size)
+	{
+		while (size != 0)
+		{
+			if (*ptr != '/' || url.back() != '/')
+				url += *ptr;
+			++ptr, --size;
+		}
+	};
+
+	append(path, path_size);
+	if (name_size != 0)
+	{
+		if (url.back() != '/')
+			url += '/';
+		append(name, name_size);
+	}
+
+	while (url.size() > 1 && url.back() == '/')
+		url.pop_back();
+
+	return url;
+}
+
+static std::string make_key(const std::string &host, const std::string &url)
+{
+	std::string key;
+	key.reserve(host.size() + url.size() + 1);
+	for (char chr : host)
+		key += static_cast<char>(tolower(static_cast<unsigned char>(chr)));
+	key += '\n';
+	key += url;
+	return key;
+}
+
+static std::string make_key(const Jupiter::ReadableString &hostname, const Jupiter::ReadableString &path, const Jupiter::ReadableString &name)
+{
+	return make_key(static_cast<std::string>(hostname), normalize_url(path.ptr(), path.size(), name.ptr(), name.size()));
+}
+
+static bool equalsi(const char *lhs, size_t lhs_size, const char *rhs)
+{
+	size_t rhs_size = strlen(rhs);
+	if (lhs_size != rhs_size)
+		return false;
+
+	while (lhs_size-- != 0)
+		if (tolower(static_cast<unsigned char>(lhs[lhs_size])) != tolower(static_cast<unsigned char>(rhs[lhs_size])))
+			return false;
+
+	return true;
+}
+
+static bool containsi(const char *str, size_t size, const char *token)
+{
+	size_t token_size = strlen(token);
+	while (size >= token_size)
+	{
+		if (equalsi(str, token_size, token))
+			return true;
+		++str, --size;
+	}
+	return false;
+}
+
+static const char *get_status_text(int status)
+{
+	switch (status)
+	{
+	case 200: return "OK";
+	case 304: return "Not Modified";
+	case 400: return "Bad Request";
+	case 404: return "Not Found";
+	case 405: return "Method Not Allowed";
+	case 408: return "Request Timeout";
+	case 413: return "Payload Too Large";
+	case 429: return "Too Many Requests";
+	case 431: return "Request Header Fields Too Large";
+	case 501: return "Not Implemented";
+	case 503: return "Service Unavailable";
+	default: return "Internal Server Error";
+	}
+}
+
+static void append_header(std::string &out, const char *name, const Jupiter::ReadableString *value)
+{
+	if (value != nullptr)
+	{
+		out += name;
+		out.append(value->ptr(), value->size());
+		out += "\r\n";
+	}
+}
+
+/** Appends a response's status line and headers, up to the framing headers */
+static void append_head(std::string &result, int status, const Jupiter::HTTP::Server::Content *content, const std::string &headers)
+{
+	result += "HTTP/1.1 ";
+	result += std::to_string(status);
+	result += ' ';
+	result += get_status_text(status);
+	result += "\r\nDate: ";
+	result += formatHTTPDate(time(nullptr));
+	result += "\r\nServer: Jupiter\r\n";
+
+	if (content != nullptr)
+	{
+		if (content->type != nullptr)
+		{
+			result += "Content-Type: ";
+			result.append(content->type->ptr(), content->type->size());
+			if (content->charset != nullptr)
+			{
+				result += "; charset=";
+				result.append(content->charset->ptr(), content->charset->size());
+			}
+			result += "\r\n";
+		}
+		append_header(result, "Content-Language: ", content->language);
+	}
+	else
+		result += "Content-Type: text/plain\r\n";
+
+	if (status == 405)
+		result += "Allow: GET, HEAD\r\n";
+
+	result += headers;
+}
+
+static std::string make_response(int status, const Jupiter::HTTP::Server::Content *content, const std::string &headers, const char *body, size_t body_size, bool head, bool keep_alive)
+{
+	std::string result;
+	result.reserve(256 + (head ? 0 : body_size));
+	append_head(result, status, content, headers);
+
+	// 304 responses carry no body
+	if (status != 304)
+	{
+		result += "Content-Length: ";
+		result += std::to_string(body_size);
+		result += "\r\n";
+	}
+	result += keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+
+	if (!head && status != 304)
+		result.append(body, body_size);
+
+	return result;
+}
+
+/** Headers of a streamed response; without chunked encoding, the body ends when the connection closes */
+static std::string make_stream_head(int status, const Jupiter::HTTP::Server::Content *content, const std::string &headers, bool chunked, bool keep_alive)
+{
+	std::string result;
+	result.reserve(256);
+	append_head(result, status, content, headers);
+	if (chunked)
+		result += "Transfer-Encoding: chunked\r\n";
+	result += keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+	return result;
+}
+
+static std::string make_error_response(int status, bool head, bool keep_alive, const std::string &headers = std::string())
+{
+	std::string body = std::to_string(status);
+	body += ' ';
+	body += get_status_text(status);
+	return make_response(status, nullptr, headers, body.data(), body.size(), head, keep_alive);
+}
+
+/** Picks the best encoding which the client accepts; gzip is preferred when both are equally acceptable */
+static HTTPServerPlugin::SharedBody::Encoding get_accepted_encoding(const HTTPServerPlugin::Request &request)
+{
+	const std::string *accept_encoding = request.getHeader("Accept-Encoding");
+	if (accept_encoding == nullptr)
+		return HTTPServerPlugin::SharedBody::Encoding::Identity;
+
+	double gzip_quality = -1.0, deflate_quality = -1.0, wildcard_quality = -1.0;
+	const char *itr = accept_encoding->c_str();
+	while (*itr != '\0')
+	{
+		while (*itr == ' ' || *itr == '\t' || *itr == ',')
+			++itr;
+
+		const char *name = itr;
+		while (*itr != '\0' && *itr != ',' && *itr != ';' && *itr != ' ' && *itr != '\t')
+			++itr;
+		size_t name_size = itr - name;
+
+		// parameters; only the quality value is meaningful
+		double quality = 1.0;
+		while (*itr != '\0' && *itr != ',')
+		{
+			if (*itr == ';')
+			{
+				do
+					++itr;
+				while (*itr == ' ' || *itr == '\t');
+
+				if ((*itr == 'q' || *itr == 'Q') && itr[1] == '=')
+					quality = strtod(itr + 2, nullptr);
+			}
+			else
+				++itr;
+		}
+
+		if (equalsi(name, name_size, "gzip") || equalsi(name, name_size, "x-gzip"))
+			gzip_quality = quality;
+		else if (equalsi(name, name_size, "deflate"))
+			deflate_quality = quality;
+		else if (equalsi(name, name_size, "*"))
+			wildcard_quality = quality;
+	}
+
+	if (gzip_quality < 0.0)
+		gzip_quality = wildcard_quality;
+	if (deflate_quality < 0.0)
+		deflate_quality = wildcard_quality;
+
+	if (gzip_quality > 0.0 && gzip_quality >= deflate_quality)
+		return HTTPServerPlugin::SharedBody::Encoding::Gzip;
+	if (deflate_quality > 0.0)
+		return HTTPServerPlugin::SharedBody::Encoding::Deflate;
+	return HTTPServerPlugin::SharedBody::Encoding::Identity;
+}
+
+#if defined HTTPSERVER_ZLIB
+/** Compresses data in the gzip format (window_bits 31), or the zlib format used by HTTP's deflate (window_bits 15) */
+static bool compress_body(const std::string &in, std::string &out, int window_bits, int level)
+{
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	if (deflateInit2(&stream, level, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return false;
+
+	out.resize(deflateBound(&stream, static_cast<uLong>(in.size())));
+	stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(in.data()));
+	stream.avail_in = static_cast<uInt>(in.size());
+	stream.next_out = reinterpret_cast<Bytef *>(&out[0]);
+	stream.avail_out = static_cast<uInt>(out.size());
+
+	int result = deflate(&stream, Z_FINISH);
+	out.resize(stream.total_out);
+	deflateEnd(&stream);
+	return result == Z_STREAM_END;
+}
+#endif // HTTPSERVER_ZLIB
+
+/** Serializes a page's response for one request; shared bodies are sent in the best encoding the client accepts */
+static std::string make_page_response(const HTTPServerPlugin::Request &request, bool keep_alive, const Jupiter::HTTP::Server::Content *content, const HTTPServerPlugin::Response &page_response)
+{
+	if (page_response.shared_body == nullptr)
+		return make_response(page_response.status, content, page_response.headers, page_response.body.data(), page_response.body.size(), request.head, keep_alive);
+
+	// the representation depends on the client, so caches must key on Accept-Encoding
+	const std::string *body = &page_response.shared_body->plain;
+	std::string headers = page_response.headers;
+	headers += "Vary: Accept-Encoding\r\n";
+	if (page_response.status != 304)
+	{
+		HTTPServerPlugin::SharedBody::Encoding encoding = get_accepted_encoding(request);
+		body = &page_response.shared_body->get(encoding);
+		if (body != &page_response.shared_body->plain)
+			headers += encoding == HTTPServerPlugin::SharedBody::Encoding::Gzip ? "Content-Encoding: gzip\r\n" : "Content-Encoding: deflate\r\n";
+	}
+
+	return make_response(page_response.status, content, headers, body->data(), body->size(), request.head, keep_alive);
+}
+
+/** Identifies requests which are answered identically: the same content, query string and validators */
+static std::string flight_key(const void *entry, const HTTPServerPlugin::Request &request)
+{
+	const std::string *if_none_match = request.getHeader("If-None-Match");
+	const std::string *if_modified_since = request.getHeader("If-Modified-Since");
+
+	std::string key = std::to_string(reinterpret_cast<uintptr_t>(entry));
+	key += '\n';
+	key += request.query_string;
+	key += '\n';
+	if (if_none_match != nullptr)
+		key += *if_none_match;
+	key += '\n';
+	if (if_modified_since != nullptr)
+		key += *if_modified_since;
+	return key;
+}
+
+/** Streamed responses */
+
+void HTTPServerPlugin::Data::StreamState::release(size_t size)
+{
+	std::lock_guard<std::mutex> guard(StreamState::mutex);
+	StreamState::queued -= std::min(size, StreamState::queued);
+	StreamState::condition.notify_all();
+}
+
+void HTTPServerPlugin::Data::StreamState::cancel()
+{
+	std::lock_guard<std::mutex> guard(StreamState::mutex);
+	StreamState::closed = true;
+	StreamState::condition.notify_all();
+}
+
+/** Collects a streamed body into blocks, and posts each block to the event loop once it fills */
+class HTTPServerPlugin::Data::Writer : public HTTPServerPlugin::OutputStream
+{
+public:
+	using HTTPServerPlugin::OutputStream::write;
+
+	Writer(HTTPServerPlugin::Data &in_data, const Job &in_request, bool in_chunked, bool in_close, bool in_wait)
+		: data(in_data), request(in_request), chunked(in_chunked), close(in_close), wait(in_wait), state(std::make_shared<StreamState>())
+	{
+		Writer::deadline = std::chrono::steady_clock::now() + Writer::data.stream_timeout;
+		Writer::block.reserve(Writer::data.stream_block_size);
+	}
+
+	/** Sends the headers straight away, ahead of the first block */
+	void begin(std::string &&head)
+	{
+		Writer::send(std::move(head), false);
+	}
+
+	void write(const char *in_data, size_t size) override
+	{
+		// the client is gone; the rest of the body is discarded
+		if (Writer::state->closed)
+			return;
+
+		while (size != 0)
+		{
+			size_t length = std::min(size, Writer::data.stream_block_size - Writer::block.size());
+			Writer::block.append(in_data, length);
+			in_data += length;
+			size -= length;
+
+			if (Writer::block.size() == Writer::data.stream_block_size)
+				Writer::flush(false);
+		}
+	}
+
+	void finish()
+	{
+		// a response cut short by StreamTimeout must not look complete, so its connection is closed instead
+		if (Writer::timed_out)
+		{
+			Writer::data.post({ Writer::request.connection_id, Writer::request.sequence, std::string(), true, false, Writer::state, nullptr });
+			return;
+		}
+
+		Writer::flush(true);
+	}
+
+private:
+	void flush(bool last)
+	{
+		std::string out;
+		if (Writer::chunked)
+		{
+			if (Writer::block.empty() == false)
+			{
+				char size_line[32];
+				out.reserve(Writer::block.size() + 32);
+				out.append(size_line, snprintf(size_line, sizeof(size_line), "%llx\r\n", static_cast<unsigned long long>(Writer::block.size())));
+				out += Writer::block;
+				out += "\r\n";
+			}
+			if (last)
+				out += "0\r\n\r\n";
+		}
+		else
+			out = Writer::block;
+
+		Writer::block.clear();
+		Writer::send(std::move(out), last);
+	}
+
+	void send(std::string &&out, bool last)
+	{
+		{
+			std::lock_guard<std::mutex> guard(Writer::state->mutex);
+			Writer::state->queued += out.size();
+		}
+		Writer::data.post({ Writer::request.connection_id, Writer::request.sequence, std::move(out), last && Writer::close, last == false, Writer::state, nullptr });
+
+		// Keep at most a few blocks queued for a slow client, for no longer than StreamTimeout; the main thread never waits
+		if (last == false && Writer::wait)
+		{
+			std::unique_lock<std::mutex> guard(Writer::state->mutex);
+			if (std::chrono::steady_clock::now() >= Writer::deadline || Writer::state->condition.wait_until(guard, Writer::deadline, [this]()
+			{
+				return Writer::state->closed || Writer::state->queued <= Writer::data.stream_block_size * 4;
+			}) == false)
+			{
+				Writer::timed_out = true;
+				Writer::state->closed = true;
+			}
+		}
+	}
+
+	HTTPServerPlugin::Data &data;
+	const Job &request;
+	bool chunked;
+	bool close;
+	bool wait;
+	bool timed_out = false;
+	std::chrono::steady_clock::time_point deadline;
+	std::string block;
+	std::shared_ptr<StreamState> state;
+};
+
+/** Collects a streamed body into a string, for when requests are served from the main loop */
+class StringOutputStream : public HTTPServerPlugin::OutputStream
+{
+public:
+	using HTTPServerPlugin::OutputStream::write;
+
+	StringOutputStream(std::string &in_out) : out(in_out) {}
+
+	void write(const char *data, size_t size) override
+	{
+		StringOutputStream::out.append(data, size);
+	}
+
+private:
+	std::string &out;
+};
+
+HTTPServerPlugin::Data::Connection::~Connection()
+{
+	// writers of streamed responses must not wait on a connection which is gone
+	for (auto &pending : Connection::pending)
+		if (pending.stream != nullptr)
+			pending.stream->cancel();
+	for (auto &mark : Connection::stream_marks)
+		mark.stream->cancel();
+}
+
+void HTTPServerPlugin::Data::stream(const Job &request, const Jupiter::HTTP::Server::Content *content, const HTTPServerPlugin::Response &page_response, bool on_main_thread)
+{
+	bool keep_alive = request.keep_alive && request.chunked;
+	std::string head = make_stream_head(page_response.status, content, page_response.headers, request.chunked, keep_alive);
+	if (request.head)
+	{
+		HTTPServerPlugin::Data::respond(request, std::move(head), !keep_alive);
+		return;
+	}
+
+	Writer writer(*this, request, request.chunked, !keep_alive, on_main_thread == false);
+	writer.begin(std::move(head));
+	page_response.stream(writer);
+	writer.finish();
+}
+
+HTTPServerPlugin::Data::StreamJob::~StreamJob()
+{
+	std::lock_guard<std::mutex> guard(StreamJob::data.registry_mutex);
+	if (--StreamJob::entry->active == 0)
+		StreamJob::data.registry_condition.notify_all();
+}
+
+void HTTPServerPlugin::Data::run_stream(std::unique_ptr<StreamJob> &&job)
+{
+	HTTPServerPlugin::Data::stream(job->request, job->entry->content, job->response, false);
+	job.reset();
+
+	// Let the event loop start the next waiting stream
+	--HTTPServerPlugin::Data::active_streams;
+	HTTPServerPlugin::Data::wake();
+}
+
+/** Shared request execution */
+
+HTTPServerPlugin::Data::Entry *HTTPServerPlugin::Data::find(const std::string &host, const std::string &path)
+{
+	auto itr = HTTPServerPlugin::Data::registry.find(make_key(host, path));
+	if (itr == HTTPServerPlugin::Data::registry.end())
+	{
+		if (host.empty())
+			return nullptr;
+
+		itr = HTTPServerPlugin::Data::registry.find(make_key(std::string(), path));
+		if (itr == HTTPServerPlugin::Data::registry.end())
+			return nullptr;
+	}
+
+	return itr->second.get();
+}
+
+bool HTTPServerPlugin::Data::execute_unregistered(const Job &request)
+{
+	Jupiter::ReferenceString host(request.host.data(), request.host.size());
+	Jupiter::ReferenceString path(request.path.data(), request.path.size());
+	Jupiter::HTTP::Server::Content *content = HTTPServerPlugin::Data::server->find(host, path);
+	if (content == nullptr && request.host.empty() == false)
+		content = HTTPServerPlugin::Data::server->find(path);
+
+	if (content == nullptr)
+	{
+		HTTPServerPlugin::Data::respond(request, make_error_response(404, request.head, request.keep_alive), !request.keep_alive);
+		return false;
+	}
+
+	HTTPServerPlugin::Response page_response;
+	Jupiter::ReadableString *result = content->execute(Jupiter::ReferenceString(request.query_string.data(), request.query_string.size()));
+	if (result != nullptr)
+	{
+		page_response.body.assign(result->ptr(), result->size());
+		if (content->free_result)
+			delete result;
+	}
+
+	HTTPServerPlugin::Data::respond(request, make_page_response(request, request.keep_alive, content, page_response), !request.keep_alive);
+	return true;
+}
+
+/** Results of unregistered requests are relearned after this long, in case content was hooked into or removed from the server since */
+constexpr std::chrono::steady_clock::duration UNREGISTERED_LIFETIME = std::chrono::minutes(1);
+
+/** Maximum number of remembered results of unregistered requests, and of unregistered requests waiting on the main thread to learn theirs */
+constexpr size_t MAX_UNREGISTERED = 4096;
+constexpr size_t MAX_PROBES = 16;
+
+void HTTPServerPlugin::Data::learn_unregistered(const Job &request, bool resolved)
+{
+	std::lock_guard<std::mutex> guard(HTTPServerPlugin::Data::registry_mutex);
+	if (request.probe)
+		--HTTPServerPlugin::Data::probes;
+
+	if (HTTPServerPlugin::Data::foreign_content == false)
+		return;
+
+	if (HTTPServerPlugin::Data::unregistered.size() >= MAX_UNREGISTERED)
+	{
+		HTTPServerPlugin::Data::unregistered.clear();
+		HTTPServerPlugin::Data::unregistered_times.clear();
+	}
+
+	std::string key = make_key(request.host, request.path);
+	HTTPServerPlugin::Data::unregistered[key] = resolved;
+	HTTPServerPlugin::Data::unregistered_times[key] = std::chrono::steady_clock::now();
+}
+
+void HTTPServerPlugin::Data::forget_unregistered()
+{
+	std::lock_guard<std::mutex> guard(HTTPServerPlugin::Data::registry_mutex);
+	HTTPServerPlugin::Data::foreign_content = true;
+	HTTPServerPlugin::Data::unregistered.clear();
+	HTTPServerPlugin::Data::unregistered_times.clear();
+}
+
+double HTTPServerPlugin::Data::take_token(Entry &entry, const std::string &address)
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	auto result = entry.buckets.emplace(address, Bucket{ entry.rate_limit_burst, now });
+	Bucket &bucket = result.first->second;
+	if (result.second == false)
+	{
+		bucket.tokens = std::min(entry.rate_limit_burst, bucket.tokens + std::chrono::duration<double>(now - bucket.last_update).count() * entry.rate_limit);
+		bucket.last_update = now;
+	}
+
+	if (bucket.tokens >= 1.0)
+	{
+		bucket.tokens -= 1.0;
+		return 0.0;
+	}
+
+	// seconds until a token is available
+	return (1.0 - bucket.tokens) / entry.rate_limit;
+}
+
+void HTTPServerPlugin::Data::execute(Job &request, bool on_main_thread)
+{
+	std::unique_lock<std::mutex> guard(HTTPServerPlugin::Data::registry_mutex);
+	Entry *entry = HTTPServerPlugin::Data::find(request.host, request.path);
+	if (entry == nullptr)
+	{
+		if (on_main_thread)
+		{
+			guard.unlock();
+			HTTPServerPlugin::Data::learn_unregistered(request, HTTPServerPlugin::Data::execute_unregistered(request));
+			return;
+		}
+
+		// Content may have been hooked directly into the server, which only the main thread may access
+		bool marshal = false;
+		if (HTTPServerPlugin::Data::foreign_content)
+		{
+			std::string key = make_key(request.host, request.path);
+			auto result = HTTPServerPlugin::Data::unregistered.find(key);
+			if (result != HTTPServerPlugin::Data::unregistered.end() && std::chrono::steady_clock::now() - HTTPServerPlugin::Data::unregistered_times[key] < UNREGISTERED_LIFETIME)
+				marshal = result->second;
+			else if (HTTPServerPlugin::Data::probes < MAX_PROBES)
+			{
+				++HTTPServerPlugin::Data::probes;
+				request.probe = true;
+				marshal = true;
+			}
+		}
+		guard.unlock();
+
+		if (marshal == false)
+		{
+			HTTPServerPlugin::Data::respond(request, make_error_response(404, request.head, request.keep_alive), !request.keep_alive);
+			return;
+		}
+
+		std::lock_guard<std::mutex> main_guard(HTTPServerPlugin::Data::main_mutex);
+		HTTPServerPlugin::Data::main_jobs.push_back(std::move(request));
+		return;
+	}
+
+	// Rate limits are checked once, before any request is marshalled to the main thread
+	if (on_main_thread == false && entry->rate_limit > 0.0)
+	{
+		double retry_after = HTTPServerPlugin::Data::take_token(*entry, request.remote_address);
+		if (retry_after > 0.0)
+		{
+			guard.unlock();
+			std::string headers = "Retry-After: " + std::to_string(static_cast<long long>(std::ceil(retry_after))) + "\r\n";
+			HTTPServerPlugin::Data::respond(request, make_error_response(429, request.head, request.keep_alive, headers), !request.keep_alive);
+			return;
+		}
+	}
+
+	if (on_main_thread == false && entry->thread_safe == false)
+	{
+		// Marshal to the main thread; think() executes it
+		guard.unlock();
+		std::lock_guard<std::mutex> main_guard(HTTPServerPlugin::Data::main_mutex);
+		HTTPServerPlugin::Data::main_jobs.push_back(std::move(request));
+		return;
+	}
+
+	// Identical requests which arrive while this one executes wait for its response instead of executing again
+	std::string key;
+	if (entry->coalesce && request.coalesce)
+	{
+		key = flight_key(entry, request);
+		auto flight = HTTPServerPlugin::Data::flights.find(key);
+		if (flight != HTTPServerPlugin::Data::flights.end())
+		{
+			flight->second.push_back(std::move(request));
+			return;
+		}
+		HTTPServerPlugin::Data::flights[key];
+	}
+
+	++entry->active;
+	guard.unlock();
+
+	Jupiter::HTTP::Server::Content *content = entry->content;
+	HTTPServerPlugin::Response page_response;
+	bool executed = false;
+	try
+	{
+		if (entry->page != nullptr)
+			entry->page->page_function(request, page_response);
+		else
+		{
+			Jupiter::ReadableString *result = content->execute(Jupiter::ReferenceString(request.query_string.data(), request.query_string.size()));
+			if (result != nullptr)
+			{
+				page_response.body.assign(result->ptr(), result->size());
+				if (content->free_result)
+					delete result;
+			}
+		}
+		executed = true;
+	}
+	catch (...)
+	{
+		// the flight must still be removed and the entry released, or waiting requests and remove() would wait forever
+		fprintf(stderr, "[HTTPServer] ERROR: Content at %s threw an exception while generating a response" ENDL, request.path.c_str());
+	}
+
+	std::vector<Job> waiters;
+	if (key.empty() == false)
+	{
+		guard.lock();
+		auto flight = HTTPServerPlugin::Data::flights.find(key);
+		waiters.swap(flight->second);
+		HTTPServerPlugin::Data::flights.erase(flight);
+		guard.unlock();
+	}
+
+	if (executed == false)
+	{
+		HTTPServerPlugin::Data::respond(request, make_error_response(500, request.head, request.keep_alive), !request.keep_alive);
+		for (auto &waiter : waiters)
+			HTTPServerPlugin::Data::respond(waiter, make_error_response(500, waiter.head, waiter.keep_alive), !waiter.keep_alive);
+
+		guard.lock();
+		if (--entry->active == 0)
+			HTTPServerPlugin::Data::registry_condition.notify_all();
+		return;
+	}
+
+	// Responses are serialized while the content is still active, as they refer to its type
+	if (page_response.stream)
+	{
+		// a streamed body is generated as it is sent, so waiting requests are executed separately
+		if (waiters.empty() == false)
+		{
+			std::lock_guard<std::mutex> job_guard(HTTPServerPlugin::Data::job_mutex);
+			for (auto &waiter : waiters)
+			{
+				waiter.coalesce = false;
+				HTTPServerPlugin::Data::jobs.push_back(std::move(waiter));
+			}
+			HTTPServerPlugin::Data::job_condition.notify_all();
+		}
+
+		if (on_main_thread || request.head)
+			HTTPServerPlugin::Data::stream(request, content, page_response, on_main_thread);
+		else
+		{
+			// The event loop queues the body once every response ahead of it has been sent, so that its writer only waits on its own client
+			uint64_t connection_id = request.connection_id;
+			uint64_t sequence = request.sequence;
+			std::unique_ptr<StreamJob> job(new StreamJob{ *this, std::move(request), entry, std::move(page_response) });
+			HTTPServerPlugin::Data::post({ connection_id, sequence, std::string(), false, true, nullptr, std::move(job) });
+			return; // the job keeps the entry active
+		}
+	}
+	else
+	{
+		HTTPServerPlugin::Data::respond(request, make_page_response(request, request.keep_alive, content, page_response), !request.keep_alive);
+		for (auto &waiter : waiters)
+			HTTPServerPlugin::Data::respond(waiter, make_page_response(waiter, waiter.keep_alive, content, page_response), !waiter.keep_alive);
+	}
+
+	guard.lock();
+	if (--entry->active == 0)
+		HTTPServerPlugin::Data::registry_condition.notify_all();
+}
+
+void HTTPServerPlugin::Data::respond(const Job &request, std::string &&data, bool close)
+{
+	HTTPServerPlugin::Data::post({ request.connection_id, request.sequence, std::move(data), close, false, nullptr, nullptr });
+}
+
+void HTTPServerPlugin::Data::post(Response &&response)
+{
+	{
+		std::lock_guard<std::mutex> guard(HTTPServerPlugin::Data::response_mutex);
+		if (HTTPServerPlugin::Data::running == false)
+		{
+			// The loop is gone and stop() may have already cancelled queued streams; the writer must not wait on this one
+			if (response.stream != nullptr)
+				response.stream->cancel();
+			return;
+		}
+
+		HTTPServerPlugin::Data::responses.push_back(std::move(response));
+	}
+
+	HTTPServerPlugin::Data::wake();
+}
+
+void HTTPServerPlugin::Data::wake()
+{
+#if defined __linux__
+	uint64_t value = 1;
+	if (write(HTTPServerPlugin::Data::wake_fd, &value, sizeof(value)) < 0)
+		return; // The loop is already awake, or shutting down
+#endif // __linux__
+}
+
+#if defined __linux__
+
+/** Threaded server */
+
+bool HTTPServerPlugin::Data::start(const Jupiter::ReadableString &address, uint16_t port)
+{
+	addrinfo hints;
+	addrinfo *info;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = AI_PASSIVE;
+
+	if (getaddrinfo(static_cast<std::string>(address).c_str(), std::to_string(port).c_str(), &hints, &info) != 0)
+		return false;
+
+	for (addrinfo *itr = info; itr != nullptr; itr = itr->ai_next)
+	{
+		int fd = socket(itr->ai_family, itr->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, itr->ai_protocol);
+		if (fd < 0)
+			continue;
+
+		int value = 1;
+		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &value, sizeof(value));
+		if (bind(fd, itr->ai_addr, itr->ai_addrlen) == 0 && listen(fd, SOMAXCONN) == 0)
+		{
+			HTTPServerPlugin::Data::listen_fd = fd;
+			break;
+		}
+
+		close(fd);
+	}
+	freeaddrinfo(info);
+
+	if (HTTPServerPlugin::Data::listen_fd < 0)
+		return false;
+
+	HTTPServerPlugin::Data::epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	HTTPServerPlugin::Data::wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (HTTPServerPlugin::Data::epoll_fd < 0 || HTTPServerPlugin::Data::wake_fd < 0)
+	{
+		HTTPServerPlugin::Data::stop();
+		return false;
+	}
+
+	epoll_event event;
+	event.events = EPOLLIN;
+	event.data.u64 = HTTPServerPlugin::Data::listen_id;
+	epoll_ctl(HTTPServerPlugin::Data::epoll_fd, EPOLL_CTL_ADD, HTTPServerPlugin::Data::listen_fd, &event);
+	event.data.u64 = HTTPServerPlugin::Data::wake_id;
+	epoll_ctl(HTTPServerPlugin::Data::epoll_fd, EPOLL_CTL_ADD, HTTPServerPlugin::Data::wake_fd, &event);
+
+	HTTPServerPlugin::Data::running = true;
+	HTTPServerPlugin::Data::loop_thread = std::thread(&HTTPServerPlugin::Data::loop, this);
+	for (size_t index = 0; index != HTTPServerPlugin::Data::worker_count; ++index)
+		HTTPServerPlugin::Data::workers.emplace_back(&HTTPServerPlugin::Data::worker_loop, this);
+
+	return true;
+}
+
+void HTTPServerPlugin::Data::stop()
+{
+	if (HTTPServerPlugin::Data::running)
+	{
+		HTTPServerPlugin::Data::running = false;
+		{
+			std::lock_guard<std::mutex> guard(HTTPServerPlugin::Data::job_mutex);
+			HTTPServerPlugin::Data::job_condition.notify_all();
+		}
+
+		uint64_t value = 1;
+		if (write(HTTPServerPlugin::Data::wake_fd, &value, sizeof(value)) < 0)
+			value = 0;
+
+		HTTPServerPlugin::Data::loop_thread.join();
+
+		// Writers of streamed responses may be waiting on their clients
+		for (auto &pair : HTTPServerPlugin::Data::connections)
+			close(pair.second->fd);
+		HTTPServerPlugin::Data::connections.clear();
+		{
+			std::lock_guard<std::mutex> guard(HTTPServerPlugin::Data::response_mutex);
+			for (auto &response : HTTPServerPlugin::Data::responses)
+				if (response.stream != nullptr)
+					response.stream->cancel();
+		}
+
+		for (auto &worker : HTTPServerPlugin::Data::workers)
+			worker.join();
+		HTTPServerPlugin::Data::workers.clear();
+	}
+
+	for (auto &pair : HTTPServerPlugin::Data::connections)
+		close(pair.second->fd);
+	HTTPServerPlugin::Data::connections.clear();
+
+	if (HTTPServerPlugin::Data::listen_fd >= 0)
+		close(HTTPServerPlugin::Data::listen_fd);
+	if (HTTPServerPlugin::Data::epoll_fd >= 0)
+		close(HTTPServerPlugin::Data::epoll_fd);
+	if (HTTPServerPlugin::Data::wake_fd >= 0)
+		close(HTTPServerPlugin::Data::wake_fd);
+
+	HTTPServerPlugin::Data::listen_fd = -1;
+	HTTPServerPlugin::Data::epoll_fd = -1;
+	HTTPServerPlugin::Data::wake_fd = -1;
+}
+
+void HTTPServerPlugin::Data::loop()
+{
+	epoll_event events[64];
+	std::chrono::steady_clock::time_point last_sweep = std::chrono::steady_clock::now();
+
+	while (HTTPServerPlugin::Data::running)
+	{
+		int count = epoll_wait(HTTPServerPlugin::Data::epoll_fd, events, sizeof(events) / sizeof(*events), 1000);
+		if (count < 0 && errno != EINTR)
+			break;
+
+		for (int index = 0; index < count; ++index)
+		{
+			uint64_t id = events[index].data.u64;
+			if (id == HTTPServerPlugin::Data::listen_id)
+				HTTPServerPlugin::Data::accept_connections();
+			else if (id == HTTPServerPlugin::Data::wake_id)
+			{
+				uint64_t value;
+				if (read(HTTPServerPlugin::Data::wake_fd, &value, sizeof(value)) < 0)
+					continue;
+			}
+			else
+			{
+				auto itr = HTTPServerPlugin::Data::connections.find(id);
+				if (itr == HTTPServerPlugin::Data::connections.end())
+					continue;
+
+				Connection &connection = *itr->second;
+				bool alive = (events[index].events & (EPOLLHUP | EPOLLERR)) == 0;
+				if (alive && (events[index].events & EPOLLIN))
+				{
+					alive = HTTPServerPlugin::Data::read_connection(connection);
+					if (alive)
+						HTTPServerPlugin::Data::parse_requests(connection);
+				}
+
+				if (alive)
+					alive = HTTPServerPlugin::Data::service(connection);
+
+				if (alive == false)
+				{
+					close(connection.fd);
+					HTTPServerPlugin::Data::connections.erase(itr);
+				}
+			}
+		}
+
+		HTTPServerPlugin::Data::collect_responses();
+		HTTPServerPlugin::Data::dispatch_streams();
+
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if (now - last_sweep >= std::chrono::seconds(1))
+		{
+			HTTPServerPlugin::Data::sweep(now);
+			last_sweep = now;
+		}
+	}
+}
+
+void HTTPServerPlugin::Data::worker_loop()
+{
+	while (true)
+	{
+		Job request;
+		std::unique_ptr<StreamJob> stream_job;
+		{
+			std::unique_lock<std::mutex> guard(HTTPServerPlugin::Data::job_mutex);
+			HTTPServerPlugin::Data::job_condition.wait(guard, [this]()
+			{
+				return HTTPServerPlugin::Data::running == false || HTTPServerPlugin::Data::jobs.empty() == false || HTTPServerPlugin::Data::stream_jobs.empty() == false;
+			});
+
+			if (HTTPServerPlugin::Data::running == false)
+				return;
+
+			if (HTTPServerPlugin::Data::stream_jobs.empty() == false)
+			{
+				stream_job = std::move(HTTPServerPlugin::Data::stream_jobs.front());
+				HTTPServerPlugin::Data::stream_jobs.pop_front();
+			}
+			else
+			{
+				request = std::move(HTTPServerPlugin::Data::jobs.front());
+				HTTPServerPlugin::Data::jobs.pop_front();
+			}
+		}
+
+		if (stream_job != nullptr)
+			HTTPServerPlugin::Data::run_stream(std::move(stream_job));
+		else
+			HTTPServerPlugin::Data::execute(request, false);
+	}
+}
+
+/** Formats a client's address; IPv4-mapped IPv6 addresses are formatted as IPv4 */
+static std::string format_address(const sockaddr_storage &address)
+{
+	char result[INET6_ADDRSTRLEN];
+	if (address.ss_family == AF_INET)
+	{
+		const sockaddr_in &address4 = reinterpret_cast<const sockaddr_in &>(address);
+		if (inet_ntop(AF_INET, &address4.sin_addr, result, sizeof(result)) != nullptr)
+			return result;
+	}
+	else if (address.ss_family == AF_INET6)
+	{
+		const sockaddr_in6 &address6 = reinterpret_cast<const sockaddr_in6 &>(address);
+		if (IN6_IS_ADDR_V4MAPPED(&address6.sin6_addr))
+		{
+			if (inet_ntop(AF_INET, &address6.sin6_addr.s6_addr[12], result, sizeof(result)) != nullptr)
+				return result;
+		}
+		else if (inet_ntop(AF_INET6, &address6.sin6_addr, result, sizeof(result)) != nullptr)
+			return result;
+	}
+
+	return std::string();
+}
+
+void HTTPServerPlugin::Data::accept_connections()
+{
+	while (true)
+	{
+		sockaddr_storage address;
+		socklen_t address_size = sizeof(address);
+		int fd = accept4(HTTPServerPlugin::Data::listen_fd, reinterpret_cast<sockaddr *>(&address), &address_size, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return;
+		}
+
+		if (HTTPServerPlugin::Data::connections.size() >= HTTPServerPlugin::Data::max_connections)
+		{
+			// Best-effort rejection; the socket is non-blocking
+			std::string response = make_error_response(503, false, false);
+			if (send(fd, response.data(), response.size(), MSG_NOSIGNAL) < 0)
+				response.clear();
+			close(fd);
+			continue;
+		}
+
+		int value = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(value));
+
+		std::unique_ptr<Connection> connection(new Connection());
+		connection->fd = fd;
+		connection->id = HTTPServerPlugin::Data::next_connection_id++;
+		connection->address = format_address(address);
+		connection->events = EPOLLIN;
+		connection->last_activity = std::chrono::steady_clock::now();
+
+		epoll_event event;
+		event.events = connection->events;
+		event.data.u64 = connection->id;
+		if (epoll_ctl(HTTPServerPlugin::Data::epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0)
+		{
+			close(fd);
+			continue;
+		}
+
+		HTTPServerPlugin::Data::connections[connection->id] = std::move(connection);
+	}
+}
+
+bool HTTPServerPlugin::Data::read_connection(Connection &connection)
+{
+	char buffer[16384];
+	ssize_t length = recv(connection.fd, buffer, sizeof(buffer), 0);
+	if (length > 0)
+	{
+		connection.last_activity = std::chrono::steady_clock::now();
+		if (connection.in_buffer.empty())
+			connection.request_start = connection.last_activity;
+		connection.in_buffer.append(buffer, static_cast<size_t>(length));
+		return true;
+	}
+
+	if (length == 0)
+	{
+		connection.read_closed = true;
+		return true;
+	}
+
+	return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+}
+
+void HTTPServerPlugin::Data::parse_requests(Connection &connection)
+{
+	auto reject = [&connection](int status)
+	{
+		Pending pending;
+		pending.sequence = connection.next_sequence++;
+		pending.ready = true;
+		pending.close = true;
+		pending.data = make_error_response(status, false, false);
+		connection.pending.push_back(std::move(pending));
+		connection.in_buffer.clear();
+		connection.stop_parsing = true;
+	};
+
+	while (connection.stop_parsing == false && connection.pending.size() < HTTPServerPlugin::Data::max_pipeline)
+	{
+		size_t header_end = connection.in_buffer.find("\r\n\r\n");
+		if (header_end == std::string::npos)
+		{
+			if (connection.in_buffer.size() > HTTPServerPlugin::Data::max_request_size)
+				reject(431);
+			return;
+		}
+
+		if (header_end + 4 > HTTPServerPlugin::Data::max_request_size)
+		{
+			reject(431);
+			return;
+		}
+
+		// Request line
+		const char *ptr = connection.in_buffer.data();
+		size_t line_end = connection.in_buffer.find("\r\n");
+		const char *method_end = static_cast<const char *>(memchr(ptr, ' ', line_end));
+		const char *target_end = method_end == nullptr ? nullptr : static_cast<const char *>(memchr(method_end + 1, ' ', ptr + line_end - method_end - 1));
+		if (target_end == nullptr || target_end[1] != 'H')
+		{
+			reject(400);
+			return;
+		}
+
+		Job request;
+		request.connection_id = connection.id;
+		request.remote_address = connection.address;
+		size_t method_size = method_end - ptr;
+		request.head = method_size == 4 && memcmp(ptr, "HEAD", 4) == 0;
+		bool is_get = method_size == 3 && memcmp(ptr, "GET", 3) == 0;
+		request.keep_alive = ptr + line_end - target_end - 1 == 8 && memcmp(target_end + 1, "HTTP/1.1", 8) == 0;
+		request.chunked = request.keep_alive;
+
+		const char *target = method_end + 1;
+		const char *query = static_cast<const char *>(memchr(target, '?', target_end - target));
+		if (query == nullptr)
+			request.path = normalize_url(target, target_end - target);
+		else
+		{
+			request.path = normalize_url(target, query - target);
+			request.query_string.assign(query + 1, target_end - query - 1);
+		}
+
+		// Headers
+		size_t content_length = 0;
+		bool chunked = false;
+		size_t offset = line_end + 2;
+		while (offset < header_end)
+		{
+			size_t next = connection.in_buffer.find("\r\n", offset);
+			const char *line = ptr + offset;
+			const char *colon = static_cast<const char *>(memchr(line, ':', next - offset));
+			if (colon != nullptr)
+			{
+				const char *value = colon + 1;
+				const char *value_end = ptr + next;
+				while (value != value_end && (*value == ' ' || *value == '\t'))
+					++value;
+
+				size_t name_size = colon - line;
+				size_t value_size = value_end - value;
+				request.headers.emplace_back(std::string(line, name_size), std::string(value, value_size));
+				if (equalsi(line, name_size, "host"))
+				{
+					const char *port = static_cast<const char *>(memchr(value, ':', value_size));
+					request.host.assign(value, port == nullptr ? value_size : port - value);
+				}
+				else if (equalsi(line, name_size, "connection"))
+				{
+					if (containsi(value, value_size, "close"))
+						request.keep_alive = false;
+					else if (containsi(value, value_size, "keep-alive"))
+						request.keep_alive = true;
+				}
+				else if (equalsi(line, name_size, "content-length"))
+					content_length = strtoull(std::string(value, value_size).c_str(), nullptr, 10);
+				else if (equalsi(line, name_size, "transfer-encoding"))
+					chunked = true;
+			}
+			offset = next + 2;
+		}
+
+		if (chunked)
+		{
+			reject(501);
+			return;
+		}
+
+		if (content_length > HTTPServerPlugin::Data::max_request_size)
+		{
+			reject(413);
+			return;
+		}
+
+		size_t request_size = header_end + 4 + content_length;
+		if (connection.in_buffer.size() < request_size)
+			return; // Wait for the (ignored) body
+
+		connection.in_buffer.erase(0, request_size);
+		if (connection.in_buffer.empty() == false)
+			connection.request_start = std::chrono::steady_clock::now();
+
+		Pending pending;
+		pending.sequence = request.sequence = connection.next_sequence++;
+		pending.start_time = std::chrono::steady_clock::now();
+		if (is_get || request.head)
+		{
+			pending.ready = false;
+			pending.close = false;
+			connection.pending.push_back(std::move(pending));
+
+			std::lock_guard<std::mutex> guard(HTTPServerPlugin::Data::job_mutex);
+			HTTPServerPlugin::Data::jobs.push_back(std::move(request));
+			HTTPServerPlugin::Data::job_condition.notify_one();
+		}
+		else
+		{
+			pending.ready = true;
+			pending.close = !request.keep_alive;
+			pending.data = make_error_response(405, false, request.keep_alive);
+			connection.pending.push_back(std::move(pending));
+		}
+
+		if (request.keep_alive == false)
+			connection.stop_parsing = true;
+	}
+}
+
+bool HTTPServerPlugin::Data::service(Connection &connection)
+{
+	// Move completed responses to the output buffer, in request order; streamed responses are moved as their data arrives
+	while (connection.pending.empty() == false)
+	{
+		Pending &pending = connection.pending.front();
+		if (pending.stream_job != nullptr)
+			HTTPServerPlugin::Data::start_stream(connection, pending);
+
+		if (pending.data.empty() == false)
+		{
+			connection.out_buffer += pending.data;
+			if (pending.stream != nullptr)
+				connection.stream_marks.push_back({ connection.out_buffer.size(), pending.data.size(), pending.stream });
+			pending.data.clear();
+		}
+
+		if (pending.ready == false)
+			break;
+
+		if (pending.close)
+		{
+			connection.close_after_write = true;
+			connection.pending.clear();
+			break;
+		}
+		connection.pending.pop_front();
+	}
+
+	while (connection.out_offset != connection.out_buffer.size())
+	{
+		ssize_t length = send(connection.fd, connection.out_buffer.data() + connection.out_offset, connection.out_buffer.size() - connection.out_offset, MSG_NOSIGNAL);
+		if (length < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+			return false;
+		}
+
+		connection.out_offset += static_cast<size_t>(length);
+		connection.last_activity = std::chrono::steady_clock::now();
+	}
+
+	// Let writers of streamed responses continue
+	while (connection.stream_marks.empty() == false && connection.stream_marks.front().end_offset <= connection.out_offset)
+	{
+		connection.stream_marks.front().stream->release(connection.stream_marks.front().size);
+		connection.stream_marks.pop_front();
+	}
+
+	if (connection.out_offset == connection.out_buffer.size())
+	{
+		connection.out_buffer.clear();
+		connection.out_offset = 0;
+
+		if (connection.close_after_write)
+			return false;
+
+		// Resume parsing requests held back by the pipeline limit
+		if (connection.in_buffer.empty() == false && connection.pending.size() < HTTPServerPlugin::Data::max_pipeline)
+		{
+			size_t pending_count = connection.pending.size();
+			HTTPServerPlugin::Data::parse_requests(connection);
+			if (connection.pending.size() != pending_count)
+				return HTTPServerPlugin::Data::service(connection);
+		}
+
+		if (connection.read_closed && connection.pending.empty())
+			return false;
+	}
+
+	uint32_t events = 0;
+	if (connection.read_closed == false && connection.stop_parsing == false && connection.pending.size() < HTTPServerPlugin::Data::max_pipeline && connection.in_buffer.size() <= HTTPServerPlugin::Data::max_request_size)
+		events |= EPOLLIN;
+	if (connection.out_buffer.empty() == false)
+		events |= EPOLLOUT;
+
+	if (events != connection.events)
+	{
+		epoll_event event;
+		event.events = events;
+		event.data.u64 = connection.id;
+		epoll_ctl(HTTPServerPlugin::Data::epoll_fd, EPOLL_CTL_MOD, connection.fd, &event);
+		connection.events = events;
+	}
+
+	return true;
+}
+
+void HTTPServerPlugin::Data::start_stream(Connection &connection, Pending &pending)
+{
+	if (HTTPServerPlugin::Data::active_streams >= HTTPServerPlugin::Data::max_streams)
+	{
+		// dispatch_streams() retries once a stream finishes; RequestTimeout applies to the wait from here
+		if (connection.stream_waiting == false)
+		{
+			connection.stream_waiting = true;
+			HTTPServerPlugin::Data::waiting_streams.push_back(connection.id);
+			pending.start_time = std::chrono::steady_clock::now();
+		}
+		return;
+	}
+
+	++HTTPServerPlugin::Data::active_streams;
+	pending.start_time = std::chrono::steady_clock::now();
+
+	std::lock_guard<std::mutex> guard(HTTPServerPlugin::Data::job_mutex);
+	HTTPServerPlugin::Data::stream_jobs.push_back(std::move(pending.stream_job));
+	HTTPServerPlugin::Data::job_condition.notify_one();
+}
+
+void HTTPServerPlugin::Data::dispatch_streams()
+{
+	while (HTTPServerPlugin::Data::waiting_streams.empty() == false && HTTPServerPlugin::Data::active_streams < HTTPServerPlugin::Data::max_streams)
+	{
+		auto itr = HTTPServerPlugin::Data::connections.find(HTTPServerPlugin::Data::waiting_streams.front());
+		HTTPServerPlugin::Data::waiting_streams.pop_front();
+		if (itr == HTTPServerPlugin::Data::connections.end())
+			continue;
+
+		Connection &connection = *itr->second;
+		connection.stream_waiting = false;
+		if (HTTPServerPlugin::Data::service(connection) == false)
+		{
+			close(connection.fd);
+			HTTPServerPlugin::Data::connections.erase(itr);
+		}
+	}
+}
+
+void HTTPServerPlugin::Data::collect_responses()
+{
+	std::vector<Response> completed;
+	{
+		std::lock_guard<std::mutex> guard(HTTPServerPlugin::Data::response_mutex);
+		completed.swap(HTTPServerPlugin::Data::responses);
+	}
+
+	for (auto &response : completed)
+	{
+		auto itr = HTTPServerPlugin::Data::connections.find(response.connection_id);
+		if (itr == HTTPServerPlugin::Data::connections.end())
+		{
+			// Closed or timed out
+			if (response.stream != nullptr)
+				response.stream->cancel();
+			continue;
+		}
+
+		Connection &connection = *itr->second;
+		bool delivered = false;
+		for (auto &pending : connection.pending)
+		{
+			if (pending.sequence == response.sequence)
+			{
+				if (pending.ready == false)
+				{
+					if (response.stream_job != nullptr)
+					{
+						pending.stream_job = std::move(response.stream_job);
+						delivered = true;
+						break;
+					}
+
+					pending.data += response.data;
+					pending.stream = response.stream;
+					if (response.partial == false)
+					{
+						pending.ready = true;
+						pending.close = response.close;
+					}
+					delivered = true;
+				}
+				break;
+			}
+		}
+
+		if (delivered == false && response.stream != nullptr)
+			response.stream->cancel();
+
+		if (HTTPServerPlugin::Data::service(connection) == false)
+		{
+			close(connection.fd);
+			HTTPServerPlugin::Data::connections.erase(itr);
+		}
+	}
+}
+
+void HTTPServerPlugin::Data::sweep(std::chrono::steady_clock::time_point now)
+{
+	// Forget clients whose buckets have refilled
+	{
+		std::lock_guard<std::mutex> guard(HTTPServerPlugin::Data::registry_mutex);
+		for (auto &registered : HTTPServerPlugin::Data::registry)
+		{
+			Entry &entry = *registered.second;
+			for (auto bucket = entry.buckets.begin(); bucket != entry.buckets.end();)
+			{
+				if (bucket->second.tokens + std::chrono::duration<double>(now - bucket->second.last_update).count() * entry.rate_limit >= entry.rate_limit_burst)
+					bucket = entry.buckets.erase(bucket);
+				else
+					++bucket;
+			}
+		}
+	}
+
+	auto itr = HTTPServerPlugin::Data::connections.begin();
+	while (itr != HTTPServerPlugin::Data::connections.end())
+	{
+		Connection &connection = *itr->second;
+		bool alive = true;
+
+		if (connection.pending.empty() == false)
+		{
+			// Response took too long to generate
+			Pending &pending = connection.pending.front();
+			if (pending.ready == false && pending.stream == nullptr && now - pending.start_time > HTTPServerPlugin::Data::request_timeout)
+			{
+				pending.stream_job.reset();
+				pending.ready = true;
+				pending.close = true;
+				pending.data = make_error_response(503, false, false);
+				alive = HTTPServerPlugin::Data::service(connection);
+			}
+		}
+		else if (connection.out_buffer.empty() == false)
+		{
+			// Client stopped reading
+			if (now - connection.last_activity > HTTPServerPlugin::Data::request_timeout)
+				alive = false;
+		}
+		else if (connection.in_buffer.empty() == false)
+		{
+			// Request took too long to arrive
+			if (now - connection.request_start > HTTPServerPlugin::Data::request_timeout)
+			{
+				Pending pending;
+				pending.sequence = connection.next_sequence++;
+				pending.ready = true;
+				pending.close = true;
+				pending.data = make_error_response(408, false, false);
+				connection.pending.push_back(std::move(pending));
+				alive = HTTPServerPlugin::Data::service(connection);
+			}
+		}
+		else if (now - connection.last_activity > HTTPServerPlugin::Data::keep_alive_timeout)
+			alive = false;
+
+		if (alive)
+			++itr;
+		else
+		{
+			close(connection.fd);
+			itr = HTTPServerPlugin::Data::connections.erase(itr);
+		}
+	}
+}
+
+#endif // __linux__
+
+/** Request */
+
+const std::string *HTTPServerPlugin::Request::getHeader(const char *name) const
+{
+	for (auto &header : HTTPServerPlugin::Request::headers)
+		if (equalsi(header.first.data(), header.first.size(), name))
+			return &header.second;
+
+	return nullptr;
+}
+
+/** Page */
+
+HTTPServerPlugin::Page::Page(const Jupiter::ReadableString &in_name, PageFunction *in_function)
+	: Jupiter::HTTP::Server::Content(in_name, nullptr)
+{
+	HTTPServerPlugin::Page::page_function = in_function;
+}
+
+Jupiter::ReadableString *HTTPServerPlugin::Page::execute(const Jupiter::ReadableString &query_string)
+{
+	// Served from the main loop; only the query string is known, and the status and headers are lost
+	HTTPServerPlugin::Request request;
+	request.query_string = static_cast<std::string>(query_string);
+
+	HTTPServerPlugin::Response response;
+	HTTPServerPlugin::Page::page_function(request, response);
+	if (response.shared_body != nullptr)
+		return new Jupiter::StringS(response.shared_body->plain.data(), response.shared_body->plain.size());
+	if (response.stream)
+	{
+		StringOutputStream out(response.body);
+		response.stream(out);
+	}
+	return new Jupiter::StringS(response.body.data(), response.body.size());
+}
+
+/** SharedBody */
+
+const std::string &HTTPServerPlugin::SharedBody::get(Encoding encoding) const
+{
+#if defined HTTPSERVER_ZLIB
+	const HTTPServerPlugin::Data &settings = *getHTTPServerPlugin().data;
+	if (encoding == Encoding::Identity || settings.compression_level == 0 || HTTPServerPlugin::SharedBody::plain.size() < settings.compression_min_size)
+		return HTTPServerPlugin::SharedBody::plain;
+
+	std::lock_guard<std::mutex> guard(HTTPServerPlugin::SharedBody::mutex);
+	bool &has_encoded = encoding == Encoding::Gzip ? HTTPServerPlugin::SharedBody::has_gzip : HTTPServerPlugin::SharedBody::has_deflate;
+	std::string &encoded = encoding == Encoding::Gzip ? HTTPServerPlugin::SharedBody::gzip : HTTPServerPlugin::SharedBody::deflate;
+	if (has_encoded == false)
+	{
+		// compressed once, then reused for every client which accepts the encoding; an empty copy means the plain body is sent
+		if (compress_body(HTTPServerPlugin::SharedBody::plain, encoded, encoding == Encoding::Gzip ? 15 + 16 : 15, settings.compression_level) == false
+			|| encoded.size() >= HTTPServerPlugin::SharedBody::plain.size())
+			std::string().swap(encoded);
+		has_encoded = true;
+	}
+
+	if (encoded.empty())
+		return HTTPServerPlugin::SharedBody::plain;
+	return encoded;
+#else // HTTPSERVER_ZLIB
+	static_cast<void>(encoding);
+	return HTTPServerPlugin::SharedBody::plain;
+#endif // HTTPSERVER_ZLIB
+}
+
+/** HTTPServerPlugin */
+
 bool HTTPServerPlugin::initialize()
 {
+	HTTPServerPlugin::data->worker_count = this->config.get<size_t>("WorkerThreads"_jrs, 4);
+	HTTPServerPlugin::data->max_connections = this->config.get<size_t>("MaxConnections"_jrs, 1024);
+	HTTPServerPlugin::data->max_request_size = this->config.get<size_t>("MaxRequestSize"_jrs, 8192);
+	HTTPServerPlugin::data->max_pipeline = std::max<size_t>(this->config.get<size_t>("MaxPipelinedRequests"_jrs, 16), 1);
+	HTTPServerPlugin::data->request_timeout = std::chrono::seconds(this->config.get<long long>("RequestTimeout"_jrs, 10));
+	HTTPServerPlugin::data->keep_alive_timeout = std::chrono::seconds(this->config.get<long long>("KeepAliveTimeout"_jrs, 15));
+	HTTPServerPlugin::data->compression_level = std::min(std::max(this->config.get<int>("CompressionLevel"_jrs, 6), 0), 9);
+	HTTPServerPlugin::data->compression_min_size = this->config.get<size_t>("CompressionMinSize"_jrs, 256);
+	HTTPServerPlugin::data->stream_block_size = std::max<size_t>(this->config.get<size_t>("StreamBlockSize"_jrs, 16384), 512);
+	HTTPServerPlugin::data->max_streams = std::max<size_t>(this->config.get<size_t>("MaxStreams"_jrs, HTTPServerPlugin::data->worker_count / 2), 1);
+	HTTPServerPlugin::data->stream_timeout = std::chrono::seconds(this->config.get<long long>("StreamTimeout"_jrs, 60));
+
+#if defined __linux__
+	if (HTTPServerPlugin::data->worker_count != 0)
+		return HTTPServerPlugin::data->start(this->config.get("BindAddress"_jrs, "0.0.0.0"_jrs), this->config.get<uint16_t>("BindPort"_jrs, 80));
+#endif // __linux__
+
 	return HTTPServerPlugin::server.bind(this->config.get("BindAddress"_jrs, "0.0.0.0"_jrs), this->config.get<uint16_t>("BindPort"_jrs, 80));
 }
 
+void HTTPServerPlugin::hook(const Jupiter::ReadableString &hostname, const Jupiter::ReadableString &path, Jupiter::HTTP::Server::Content *content, bool thread_safe)
+{
+	std::unique_ptr<Data::Entry> entry(new Data::Entry());
+	entry->content = content;
+	entry->page = dynamic_cast<Page *>(content);
+	entry->thread_safe = thread_safe;
+
+	// Defaults may be overridden in a section named after the content's URL
+	std::string url = normalize_url(path.ptr(), path.size(), content->name.ptr(), content->name.size());
+	entry->coalesce = this->config.get<bool>("Coalesce"_jrs, true);
+	entry->rate_limit = this->config.get<double>("RateLimit"_jrs, 0.0);
+	entry->rate_limit_burst = this->config.get<double>("RateLimitBurst"_jrs, 10.0);
+	Jupiter::Config *section = this->config.getSection(Jupiter::ReferenceString(url.data(), url.size()));
+	if (section != nullptr)
+	{
+		entry->coalesce = section->get<bool>("Coalesce"_jrs, entry->coalesce);
+		entry->rate_limit = section->get<double>("RateLimit"_jrs, entry->rate_limit);
+		entry->rate_limit_burst = section->get<double>("RateLimitBurst"_jrs, entry->rate_limit_burst);
+	}
+	entry->rate_limit_burst = std::max(entry->rate_limit_burst, 1.0);
+
+	std::lock_guard<std::mutex> guard(HTTPServerPlugin::data->registry_mutex);
+	HTTPServerPlugin::data->registry[make_key(hostname, path, content->name)] = std::move(entry);
+	HTTPServerPlugin::server.hook(hostname, path, content);
+}
+
+bool HTTPServerPlugin::remove(const Jupiter::ReadableString &hostname, const Jupiter::ReadableString &path, const Jupiter::ReadableString &name)
+{
+	std::unique_lock<std::mutex> guard(HTTPServerPlugin::data->registry_mutex);
+	auto itr = HTTPServerPlugin::data->registry.find(make_key(hostname, path, name));
+	if (itr != HTTPServerPlugin::data->registry.end())
+	{
+		Data::Entry *entry = itr->second.get();
+		HTTPServerPlugin::data->registry_condition.wait(guard, [entry]()
+		{
+			return entry->active == 0;
+		});
+		HTTPServerPlugin::data->registry.erase(itr);
+	}
+
+	// The server owns the content, and frees it here
+	return HTTPServerPlugin::server.remove(hostname, path, name);
+}
+
+bool HTTPServerPlugin::isThreaded() const
+{
+	return HTTPServerPlugin::data->running;
+}
+
+HTTPServerPlugin::HTTPServerPlugin()
+	: data(new Data())
+{
+	HTTPServerPlugin::data->server = &this->server;
+}
+
+HTTPServerPlugin::~HTTPServerPlugin()
+{
+#if defined __linux__
+	HTTPServerPlugin::data->stop();
+#endif // __linux__
+}
+
 int HTTPServerPlugin::think()
 {
+	if (HTTPServerPlugin::isThreaded())
+	{
+		// Execute content which was not declared thread-safe
+		std::deque<Data::Job> main_jobs;
+		{
+			std::lock_guard<std::mutex> guard(HTTPServerPlugin::data->main_mutex);
+			main_jobs.swap(HTTPServerPlugin::data->main_jobs);
+		}
+
+		for (auto &request : main_jobs)
+			HTTPServerPlugin::data->execute(request, true);
+
+		return Jupiter::Plugin::think();
+	}
+
 	return HTTPServerPlugin::server.think();
 }
 
@@ -40,9 +1910,25 @@ HTTPServerPlugin &getHTTPServerPlugin()
 
 Jupiter::HTTP::Server &getHTTPServer()
 {
+	// the caller may hook content directly into the server, which the workers cannot see
+	pluginInstance.data->forget_unregistered();
 	return pluginInstance.server;
 }
 
+std::string formatHTTPDate(time_t time)
+{
+	tm time_tm;
+#if defined _WIN32
+	gmtime_s(&time_tm, &time);
+#else // _WIN32
+	gmtime_r(&time, &time_tm);
+#endif // _WIN32
+
+	char result[64];
+	strftime(result, sizeof(result), "%a, %d %b %Y %H:%M:%S GMT", &time_tm);
+	return result;
+}
+
 extern "C" JUPITER_EXPORT Jupiter::Plugin *getPlugin()
 {
 	return &pluginInstance;
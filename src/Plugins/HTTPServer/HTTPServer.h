@@ -24,6 +24,12 @@
  * @brief Provides an interface to push HTTP data to HTTP clients.
  */
 
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 #include "Jupiter/Plugin.h"
 #include "Jupiter/Reference_String.h"
 #include "Jupiter/String.hpp"
@@ -44,20 +50,183 @@
 
 /**
 * @brief Instantiates an instance of Jupiter::HTTP::Server to permit declaration of HTTP pages.
+* When WorkerThreads is non-zero, requests are accepted on a dedicated epoll thread and executed
+* on a pool of worker threads instead of from the main loop.
 */
 class HTTPSERVER_API HTTPServerPlugin : public Jupiter::Plugin
 {
 public:
+	/**
+	* @brief Request passed to a Page.
+	*/
+	struct HTTPSERVER_API Request
+	{
+		std::string host;
+		std::string path;
+		std::string query_string;
+		std::string remote_address; /** Address of the client; empty when requests are served from the main loop */
+		std::vector<std::pair<std::string, std::string>> headers;
+		bool head = false;
+
+		/**
+		* @brief Fetches the value of a request header.
+		*
+		* @param name Name of the header (case-insensitive)
+		* @return Value of the header if it was sent, nullptr otherwise.
+		*/
+		const std::string *getHeader(const char *name) const;
+	};
+
+	/**
+	* @brief Body of a response which is sent many times, such as a cached page.
+	* Compressed copies are made the first time a client accepts them, and are kept alongside the plain body.
+	*/
+	class HTTPSERVER_API SharedBody
+	{
+	public:
+		enum class Encoding
+		{
+			Identity,
+			Gzip,
+			Deflate
+		};
+
+		/** Plain body; must not be modified once the body is shared */
+		std::string plain;
+
+		/**
+		* @brief Fetches the body in an encoding, compressing it if it has not been already.
+		*
+		* @param encoding Encoding to fetch
+		* @return Encoded body, or the plain body if compression is disabled, unavailable, or would not help.
+		*/
+		const std::string &get(Encoding encoding) const;
+
+	private:
+		mutable std::mutex mutex;
+		mutable std::string gzip, deflate;
+		mutable bool has_gzip = false, has_deflate = false;
+	};
+
+	/**
+	* @brief Output which a Page may write its body to as it is generated, instead of building it up front.
+	*/
+	class HTTPSERVER_API OutputStream
+	{
+	public:
+		/**
+		* @brief Writes data to the body. Data is sent in fixed-size blocks as they fill; on worker threads,
+		* writes block while the client is too slow to keep up, so callers should not hold locks while writing.
+		*
+		* @param data Data to write
+		* @param size Number of bytes to write
+		*/
+		virtual void write(const char *data, size_t size) = 0;
+
+		void write(const std::string &data) { this->write(data.data(), data.size()); }
+		void write(const Jupiter::ReadableString &data) { this->write(data.ptr(), data.size()); }
+
+		virtual ~OutputStream() = default;
+	};
+
+	typedef std::function<void(OutputStream &out)> StreamFunction;
+
+	/**
+	* @brief Response filled in by a Page.
+	*/
+	struct Response
+	{
+		int status = 200;
+		std::string headers; /** Additional header lines, each terminated by CRLF */
+		std::string body;
+		std::shared_ptr<const SharedBody> shared_body; /** Sent instead of body if set, compressed if the client accepts it */
+		StreamFunction stream; /** If set, called after the headers are sent to write the body, which is sent with chunked transfer encoding */
+	};
+
+	typedef void PageFunction(const Request &request, Response &response);
+
+	/**
+	* @brief Content which may read request headers and set the response's status and headers.
+	* When requests are served from the main loop, only the query string is passed, and only the body is sent.
+	*/
+	class HTTPSERVER_API Page : public Jupiter::HTTP::Server::Content
+	{
+	public:
+		PageFunction *page_function;
+		Jupiter::ReadableString *execute(const Jupiter::ReadableString &query_string) override;
+		Page(const Jupiter::ReadableString &in_name, PageFunction *in_function);
+	};
+
 	virtual bool initialize() override;
 	Jupiter::HTTP::Server server;
 
+	/**
+	* @brief Hooks content into the server.
+	* Content which is not thread-safe is always executed on the main thread, from think().
+	* Rate limits and request coalescing are read from the section of the config named after the content's URL (i.e: [/search]).
+	*
+	* @param hostname Hostname to hook the content into (empty for any host)
+	* @param path Path to hook the content into
+	* @param content Content to hook; ownership is passed to the server
+	* @param thread_safe True if the content's function may be executed on a worker thread
+	*/
+	void hook(const Jupiter::ReadableString &hostname, const Jupiter::ReadableString &path, Jupiter::HTTP::Server::Content *content, bool thread_safe = false);
+
+	/**
+	* @brief Removes content from the server, after waiting for any worker threads which are executing it.
+	*
+	* @param hostname Hostname the content was hooked into
+	* @param path Path the content was hooked into
+	* @param name Name of the content to remove
+	* @return True if content was removed, false otherwise.
+	*/
+	bool remove(const Jupiter::ReadableString &hostname, const Jupiter::ReadableString &path, const Jupiter::ReadableString &name);
+
+	/**
+	* @brief Checks if requests are being served from worker threads.
+	*
+	* @return True if the threaded server is running, false if requests are served from the main loop.
+	*/
+	bool isThreaded() const;
+
+	/**
+	* @brief Default constructor for the HTTPServerPlugin class.
+	*/
+	HTTPServerPlugin();
+
+	/**
+	* @brief Destructor for the HTTPServerPlugin class.
+	*/
+	~HTTPServerPlugin();
+
 public: // Jupiter::Plugin
 	int think() override;
+
+private:
+	struct Data;
+	std::unique_ptr<Data> data;
+	friend HTTPSERVER_API Jupiter::HTTP::Server &getHTTPServer();
 };
 
 HTTPSERVER_API HTTPServerPlugin &getHTTPServerPlugin();
+
+/**
+* @brief Fetches the underlying server.
+* Content hooked directly into it is still served when the server is threaded, but always on the main thread, and without rate limits or coalescing; prefer HTTPServerPlugin::hook().
+* Requests are only looked up in it once this has been called, and whether each one resolves is remembered for up to a minute; fetch the server again after hooking or removing content.
+*
+* @return Server which all content is hooked into
+*/
 HTTPSERVER_API Jupiter::HTTP::Server &getHTTPServer();
 
+/**
+* @brief Formats a time as an HTTP date (e.g. "Sun, 06 Nov 1994 08:49:37 GMT").
+*
+* @param time Time to format
+* @return Formatted date
+*/
+HTTPSERVER_API std::string formatHTTPDate(time_t time);
+
 /** Re-enable warnings */
 #if defined _MSC_VER
 #pragma warning(pop)
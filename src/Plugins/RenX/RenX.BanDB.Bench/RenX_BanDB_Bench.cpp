@@ -0,0 +1,476 @@
+/**
+ * Copyright (C) 2020 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#if defined __linux__
+#include <unistd.h>
+#endif // __linux__
+#include "Jupiter/Functions.h"
+#include "RenX_BanDatabase.h"
+#include "RenX_PlayerInfo.h"
+#include "RenX_BanDB_Bench.h"
+
+using namespace Jupiter::literals;
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+	using Entry = RenX::BanDatabase::Entry;
+
+	const uint64_t steamid_base = 0x0110000100000000ULL;
+	const uint64_t guest_steamid_base = 0x0110000200000000ULL;
+
+	struct Percentiles
+	{
+		double p50 = 0.0;
+		double p90 = 0.0;
+		double p99 = 0.0;
+		double max = 0.0;
+	};
+
+	double elapsed_ms(Clock::time_point start)
+	{
+		return std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(Clock::now() - start).count();
+	}
+
+	double elapsed_us(Clock::time_point start)
+	{
+		return std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(Clock::now() - start).count();
+	}
+
+	Percentiles get_percentiles(std::vector<double> &samples)
+	{
+		Percentiles result;
+		if (samples.empty())
+			return result;
+
+		std::sort(samples.begin(), samples.end());
+		auto at = [&samples](double fraction)
+		{
+			return samples[std::min(samples.size() - 1, static_cast<size_t>(fraction * samples.size()))];
+		};
+
+		result.p50 = at(0.50);
+		result.p90 = at(0.90);
+		result.p99 = at(0.99);
+		result.max = samples.back();
+		return result;
+	}
+
+	size_t resident_memory()
+	{
+#if defined __linux__
+		unsigned long size, resident;
+		FILE *file = fopen("/proc/self/statm", "r");
+		if (file == nullptr)
+			return 0;
+
+		if (fscanf(file, "%lu %lu", &size, &resident) != 2)
+			resident = 0;
+		fclose(file);
+		return static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else // __linux__
+		return 0;
+#endif // __linux__
+	}
+
+	long file_size(const std::string &filename)
+	{
+		FILE *file = fopen(filename.c_str(), "rb");
+		if (file == nullptr)
+			return 0;
+
+		fseek(file, 0, SEEK_END);
+		long result = ftell(file);
+		fclose(file);
+		return result;
+	}
+
+	uint32_t random_ip(std::mt19937_64 &rng)
+	{
+		return static_cast<uint32_t>(rng() % 0xFFFFFFFEULL) + 1;
+	}
+
+	Jupiter::StringS random_hwid(std::mt19937_64 &rng, char prefix)
+	{
+		return Jupiter::StringS::Format("%c%016llx", prefix, static_cast<unsigned long long>(rng()));
+	}
+
+	/** Generates a ban with a realistic mix of identities, types, and lengths */
+	Entry *make_entry(std::mt19937_64 &rng, size_t index, std::chrono::system_clock::time_point now)
+	{
+		Entry *entry = new Entry();
+		unsigned int kind = rng() % 100;
+
+		if (kind < 55) // Typical player ban
+		{
+			entry->steamid = steamid_base + index;
+			entry->ip = random_ip(rng);
+			entry->prefix_length = 32;
+			entry->hwid = random_hwid(rng, 'm');
+			entry->name = Jupiter::StringS::Format("Player%zu", index);
+		}
+		else if (kind < 70) // IP range ban
+		{
+			entry->prefix_length = static_cast<uint8_t>(16 + rng() % 9);
+			entry->ip = random_ip(rng) & Jupiter_prefix_length_to_netmask(entry->prefix_length);
+		}
+		else if (kind < 80) // HWID ban
+			entry->hwid = random_hwid(rng, 'm');
+		else if (kind < 85) // RDNS ban
+		{
+			entry->rdns = Jupiter::StringS::Format("*.isp%zu.example.net", index);
+			entry->flags |= Entry::FLAG_USE_RDNS;
+		}
+		else // Name ban
+			entry->name = Jupiter::StringS::Format("Player%zu", index);
+
+		unsigned int type = rng() % 100;
+		if (type < 85)
+			entry->flags |= Entry::FLAG_TYPE_GAME;
+		else if (type < 95)
+			entry->flags |= Entry::FLAG_TYPE_CHAT;
+		else
+			entry->flags |= Entry::FLAG_TYPE_BOT;
+
+		if (rng() % 100 < 80)
+			entry->flags |= Entry::FLAG_ACTIVE;
+
+		entry->timestamp = now - std::chrono::seconds(rng() % (86400 * 60));
+		if (rng() % 100 < 40)
+			entry->length = std::chrono::seconds::zero();
+		else
+			entry->length = std::chrono::seconds(3600 + rng() % (86400 * 30));
+
+		entry->banner = "Benchmark"_jrs;
+		entry->reason = "Synthetic ban"_jrs;
+		return entry;
+	}
+
+	/** Builds a player matching the identity of a generated entry */
+	RenX::PlayerInfo *make_hit(std::mt19937_64 &rng, const Entry &entry, size_t index)
+	{
+		RenX::PlayerInfo *player = new RenX::PlayerInfo();
+		player->steamid = entry.steamid;
+		if (entry.ip != 0)
+			player->ip32 = entry.ip | (random_ip(rng) & ~Jupiter_prefix_length_to_netmask(entry.prefix_length));
+		else
+			player->ip32 = random_ip(rng);
+		player->hwid = entry.hwid.isEmpty() ? random_hwid(rng, 'g') : entry.hwid;
+		player->name = entry.name.isEmpty() ? Jupiter::StringS::Format("Guest%zu", index) : entry.name;
+		if (entry.rdns.isNotEmpty())
+			player->rdns = Jupiter::StringS::Format("host%zu%.*s", index, entry.rdns.size() - 1, entry.rdns.ptr() + 1);
+		else
+			player->rdns = Jupiter::StringS::Format("host%zu.other.example.org", index);
+		return player;
+	}
+
+	/** Builds a player whose identity was not drawn from the database */
+	RenX::PlayerInfo *make_miss(std::mt19937_64 &rng, size_t index)
+	{
+		RenX::PlayerInfo *player = new RenX::PlayerInfo();
+		player->steamid = guest_steamid_base + index;
+		player->ip32 = random_ip(rng);
+		player->hwid = random_hwid(rng, 'g');
+		player->name = Jupiter::StringS::Format("Guest%zu", index);
+		player->rdns = Jupiter::StringS::Format("host%zu.other.example.org", index);
+		return player;
+	}
+
+	/** Mirrors RenX::Server::banCheck() with every ban type enabled, without side effects */
+	uint16_t check_entry(const Entry &entry, const RenX::PlayerInfo &player, std::chrono::system_clock::time_point now)
+	{
+		if ((entry.flags & Entry::FLAG_ACTIVE) == 0
+			|| (entry.length != std::chrono::seconds::zero() && entry.timestamp + entry.length < now))
+			return 0;
+
+		uint32_t netmask = entry.prefix_length >= 32 ? 0xFFFFFFFF : Jupiter_prefix_length_to_netmask(entry.prefix_length);
+		if ((entry.steamid != 0 && entry.steamid == player.steamid)
+			|| (entry.ip != 0 && (entry.ip & netmask) == (player.ip32 & netmask))
+			|| (entry.hwid.isNotEmpty() && entry.hwid.equals(player.hwid))
+			|| (entry.rdns.isNotEmpty() && (entry.flags & Entry::FLAG_USE_RDNS) != 0 && player.rdns.match(entry.rdns))
+			|| (entry.name.isNotEmpty() && entry.name.equalsi(player.name)))
+			return entry.flags;
+
+		return 0;
+	}
+
+	uint16_t indexed_check(const RenX::BanDatabase &database, const RenX::PlayerInfo &player, std::vector<size_t> &candidates)
+	{
+		const Jupiter::ArrayList<Entry> &entries = database.getEntries();
+		std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+		uint16_t flags = 0;
+
+		database.getCandidates(player, candidates);
+		for (size_t index : candidates)
+			flags |= check_entry(*entries.get(index), player, now);
+
+		return flags;
+	}
+
+	/** The pre-index check: a linear scan over every entry */
+	uint16_t linear_check(const RenX::BanDatabase &database, const RenX::PlayerInfo &player)
+	{
+		const Jupiter::ArrayList<Entry> &entries = database.getEntries();
+		std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+		uint16_t flags = 0;
+
+		for (size_t index = 0; index != entries.size(); ++index)
+			flags |= check_entry(*entries.get(index), player, now);
+
+		return flags;
+	}
+
+	void print_percentiles(const char *label, const Percentiles &value)
+	{
+		printf("%-24s %12.2f %12.2f %12.2f %12.2f" ENDL, label, value.p50, value.p90, value.p99, value.max);
+	}
+
+	void append_percentiles(std::string &json, const char *key, const Percentiles &value)
+	{
+		char buffer[256];
+		snprintf(buffer, sizeof(buffer), ",\"%s\":{\"p50\":%.3f,\"p90\":%.3f,\"p99\":%.3f,\"max\":%.3f}", key, value.p50, value.p90, value.p99, value.max);
+		json += buffer;
+	}
+}
+
+bool RenX_BanDBBenchPlugin::initialize()
+{
+	RenX_BanDBBenchPlugin::filename = static_cast<std::string>(this->config.get("BenchFile"_jrs, "BanDB.Bench.db"_jrs));
+	RenX_BanDBBenchPlugin::lookup_count = this->config.get<size_t>("LookupCount"_jrs, 10000);
+	RenX_BanDBBenchPlugin::mutation_count = this->config.get<size_t>("MutationCount"_jrs, 1000);
+	return true;
+}
+
+bool RenX_BanDBBenchPlugin::run(size_t entry_count)
+{
+	std::mt19937_64 rng(entry_count);
+	std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+	std::unique_ptr<RenX::BanDatabase> database(new RenX::BanDatabase());
+	Clock::time_point start;
+
+	// Generate and write the synthetic database
+	remove(RenX_BanDBBenchPlugin::filename.c_str());
+	if (database->load(RenX_BanDBBenchPlugin::filename) == false)
+		return false;
+
+	std::vector<Entry *> batch;
+	batch.reserve(entry_count);
+	for (size_t index = 0; index != entry_count; ++index)
+		batch.push_back(make_entry(rng, index, now));
+
+	start = Clock::now();
+	database->add_entries(batch);
+	double bulk_add_ms = elapsed_ms(start);
+	database.reset();
+
+	// Load
+	size_t resident_before = resident_memory();
+	database.reset(new RenX::BanDatabase());
+	start = Clock::now();
+	database->load(RenX_BanDBBenchPlugin::filename);
+	double load_ms = elapsed_ms(start);
+	size_t resident_after = resident_memory();
+	size_t resident_bytes = resident_after > resident_before ? resident_after - resident_before : 0;
+	size_t loaded_count = database->getEntries().size();
+
+	// Ban check latency
+	std::vector<std::unique_ptr<RenX::PlayerInfo>> hits, misses;
+	for (size_t index = 0; index != RenX_BanDBBenchPlugin::lookup_count && loaded_count != 0; ++index)
+	{
+		hits.emplace_back(make_hit(rng, *database->getEntries().get(rng() % loaded_count), index));
+		misses.emplace_back(make_miss(rng, index));
+	}
+
+	std::vector<double> samples;
+	std::vector<size_t> candidates;
+	size_t banned = 0;
+	auto measure = [&samples, &banned](const std::vector<std::unique_ptr<RenX::PlayerInfo>> &players, size_t limit, const std::function<uint16_t(const RenX::PlayerInfo &)> &check)
+	{
+		Clock::time_point check_start;
+		samples.clear();
+		for (size_t index = 0; index != players.size() && index != limit; ++index)
+		{
+			check_start = Clock::now();
+			if (check(*players[index]) != 0)
+				++banned;
+			samples.push_back(elapsed_us(check_start));
+		}
+		return get_percentiles(samples);
+	};
+
+	auto indexed = [&database, &candidates](const RenX::PlayerInfo &player) { return indexed_check(*database, player, candidates); };
+	auto linear = [&database](const RenX::PlayerInfo &player) { return linear_check(*database, player); };
+
+	// The linear scan is sampled less at large sizes, so that a run completes in reasonable time
+	size_t linear_limit = std::max<size_t>(100, RenX_BanDBBenchPlugin::lookup_count * 10000 / std::max<size_t>(entry_count, 10000));
+	Percentiles hit_us = measure(hits, hits.size(), indexed);
+	size_t hits_banned = banned;
+	banned = 0;
+	Percentiles miss_us = measure(misses, misses.size(), indexed);
+	size_t misses_banned = banned;
+	Percentiles linear_hit_us = measure(hits, linear_limit, linear);
+	Percentiles linear_miss_us = measure(misses, linear_limit, linear);
+
+	// Add throughput
+	start = Clock::now();
+	for (size_t index = 0; index != RenX_BanDBBenchPlugin::mutation_count; ++index)
+	{
+		Jupiter::StringS reason = "Synthetic ban"_jrs;
+		database->add(Jupiter::StringS::Format("Added%zu", index), random_ip(rng), 32, guest_steamid_base + entry_count + index, random_hwid(rng, 'a'), Jupiter::StringS::empty, "Benchmark"_jrs, reason, std::chrono::seconds::zero(), Entry::FLAG_TYPE_GAME);
+	}
+	double add_ms = elapsed_ms(start);
+
+	// Deactivate throughput
+	size_t deactivated = 0;
+	start = Clock::now();
+	for (size_t index = 0; index != database->getEntries().size() && deactivated != RenX_BanDBBenchPlugin::mutation_count; ++index)
+		if (database->deactivate(index))
+			++deactivated;
+	double deactivate_ms = elapsed_ms(start);
+
+	// Compaction; rewriting the file folds deactivation records into their entries
+	long file_bytes_before = file_size(RenX_BanDBBenchPlugin::filename);
+	start = Clock::now();
+	database->upgrade_database();
+	double compact_ms = elapsed_ms(start);
+	long file_bytes_after = file_size(RenX_BanDBBenchPlugin::filename);
+
+	double add_per_sec = add_ms > 0.0 ? RenX_BanDBBenchPlugin::mutation_count * 1000.0 / add_ms : 0.0;
+	double deactivate_per_sec = deactivate_ms > 0.0 ? deactivated * 1000.0 / deactivate_ms : 0.0;
+
+	// Table
+	printf(ENDL "Ban database benchmark: %zu entries (%zu loaded)" ENDL, entry_count, loaded_count);
+	printf("%-24s %12s" ENDL, "Metric", "Value");
+	printf("%-24s %12.2f ms" ENDL, "Bulk add", bulk_add_ms);
+	printf("%-24s %12.2f ms" ENDL, "Load", load_ms);
+	printf("%-24s %12.2f MiB" ENDL, "Resident memory", resident_bytes / 1048576.0);
+	printf("%-24s %12.0f /s" ENDL, "Add", add_per_sec);
+	printf("%-24s %12.0f /s" ENDL, "Deactivate", deactivate_per_sec);
+	printf("%-24s %12.2f ms (%ld -> %ld bytes)" ENDL, "Compaction", compact_ms, file_bytes_before, file_bytes_after);
+	printf("%-24s %12s %12s %12s %12s" ENDL, "Ban check (us)", "p50", "p90", "p99", "max");
+	print_percentiles("Indexed hit", hit_us);
+	print_percentiles("Indexed miss", miss_us);
+	print_percentiles("Linear hit", linear_hit_us);
+	print_percentiles("Linear miss", linear_miss_us);
+	printf("Banned: %zu of %zu hits, %zu of %zu misses" ENDL, hits_banned, hits.size(), misses_banned, misses.size());
+
+	// JSON
+	char buffer[512];
+	std::string json;
+	snprintf(buffer, sizeof(buffer), "{\"entries\":%zu,\"loaded\":%zu,\"bulk_add_ms\":%.3f,\"load_ms\":%.3f,\"resident_bytes\":%zu,\"add_per_sec\":%.1f,\"deactivate_per_sec\":%.1f,\"compact_ms\":%.3f,\"file_bytes_before\":%ld,\"file_bytes_after\":%ld",
+		entry_count, loaded_count, bulk_add_ms, load_ms, resident_bytes, add_per_sec, deactivate_per_sec, compact_ms, file_bytes_before, file_bytes_after);
+	json = buffer;
+	append_percentiles(json, "check_hit_us", hit_us);
+	append_percentiles(json, "check_miss_us", miss_us);
+	append_percentiles(json, "linear_hit_us", linear_hit_us);
+	append_percentiles(json, "linear_miss_us", linear_miss_us);
+	json += '}';
+	puts(json.c_str());
+
+	database.reset();
+	remove(RenX_BanDBBenchPlugin::filename.c_str());
+	return true;
+}
+
+bool RenX_BanDBBenchPlugin::start(std::vector<size_t> sizes)
+{
+	if (RenX_BanDBBenchPlugin::running)
+		return false;
+
+	if (RenX_BanDBBenchPlugin::worker.joinable())
+		RenX_BanDBBenchPlugin::worker.join();
+
+	// the benchmark uses its own database, so it can run beside the event loop rather than stalling it
+	RenX_BanDBBenchPlugin::running = true;
+	RenX_BanDBBenchPlugin::worker = std::thread([this](std::vector<size_t> sizes)
+	{
+		for (size_t size : sizes)
+			if (RenX_BanDBBenchPlugin::run(size) == false)
+			{
+				printf("Error: Unable to create benchmark database: %s" ENDL, RenX_BanDBBenchPlugin::filename.c_str());
+				break;
+			}
+
+		RenX_BanDBBenchPlugin::running = false;
+	}, std::move(sizes));
+	return true;
+}
+
+RenX_BanDBBenchPlugin::~RenX_BanDBBenchPlugin()
+{
+	if (RenX_BanDBBenchPlugin::worker.joinable())
+		RenX_BanDBBenchPlugin::worker.join();
+}
+
+const std::string &RenX_BanDBBenchPlugin::getFileName() const
+{
+	return RenX_BanDBBenchPlugin::filename;
+}
+
+// Plugin instantiation and entry point.
+RenX_BanDBBenchPlugin pluginInstance;
+
+extern "C" JUPITER_EXPORT Jupiter::Plugin *getPlugin()
+{
+	return &pluginInstance;
+}
+
+/** Console Commands */
+
+// BanDBBench Console Command
+
+BanDBBenchConsoleCommand::BanDBBenchConsoleCommand()
+{
+	this->addTrigger(STRING_LITERAL_AS_REFERENCE("bandbbench"));
+}
+
+void BanDBBenchConsoleCommand::trigger(const Jupiter::ReadableString &parameters)
+{
+	std::vector<size_t> sizes;
+	size_t words = parameters.wordCount(WHITESPACE);
+	for (size_t index = 0; index != words; ++index)
+	{
+		size_t size = static_cast<size_t>(Jupiter::ReferenceString::getWord(parameters, index, WHITESPACE).asUnsignedLongLong());
+		if (size != 0)
+			sizes.push_back(size);
+	}
+
+	if (sizes.empty())
+		sizes = { 10000, 100000, 1000000 };
+
+	if (pluginInstance.start(std::move(sizes)))
+		puts("Ban database benchmark started; results are printed as each size completes.");
+	else
+		puts("Error: A ban database benchmark is already running.");
+}
+
+const Jupiter::ReadableString &BanDBBenchConsoleCommand::getHelp(const Jupiter::ReadableString &)
+{
+	static STRING_LITERAL_AS_NAMED_REFERENCE(defaultHelp, "Benchmarks the ban database against generated databases of each size (default: 10000 100000 1000000). Syntax: bandbbench [entries...]");
+	return defaultHelp;
+}
+
+CONSOLE_COMMAND_INIT(BanDBBenchConsoleCommand)
@@ -0,0 +1,69 @@
+/**
+ * Copyright (C) 2020 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+#if !defined _RENX_BANDB_BENCH_H_HEADER
+#define _RENX_BANDB_BENCH_H_HEADER
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "Jupiter/Plugin.h"
+#include "Jupiter/Reference_String.h"
+#include "Console_Command.h"
+#include "RenX_Plugin.h"
+
+class RenX_BanDBBenchPlugin : public RenX::Plugin
+{
+public: // Jupiter::Plugin
+	virtual bool initialize() override;
+
+public: // RenX_BanDBBenchPlugin
+	/**
+	* @brief Runs the ban database benchmark for a single database size, and prints the results.
+	*
+	* @param entry_count Number of entries to generate
+	* @return True if the benchmark completed, false if the database file could not be created.
+	*/
+	bool run(size_t entry_count);
+
+	/**
+	* @brief Runs the benchmark for each database size in turn on a worker thread, which prints the results.
+	*
+	* @param sizes Numbers of entries to generate
+	* @return True if the benchmark was started, false if one is already running.
+	*/
+	bool start(std::vector<size_t> sizes);
+
+	const std::string &getFileName() const;
+
+	/**
+	* @brief Destructor for the RenX_BanDBBenchPlugin class; waits for a running benchmark to finish.
+	*/
+	~RenX_BanDBBenchPlugin();
+
+private:
+	std::thread worker;
+	std::atomic<bool> running{ false };
+	std::string filename;
+	size_t lookup_count;
+	size_t mutation_count;
+};
+
+GENERIC_CONSOLE_COMMAND(BanDBBenchConsoleCommand)
+
+#endif // _RENX_BANDB_BENCH_H_HEADER
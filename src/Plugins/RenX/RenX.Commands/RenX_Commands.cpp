@@ -16,8 +16,12 @@
  * Written by Jessica James <jessica.aj@outlook.com>
  */
 
+#include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <forward_list>
 #include <functional>
+#include <unordered_map>
 #include "Jupiter/Functions.h"
 #include "IRC_Bot.h"
 #include "RenX_Commands.h"
@@ -73,6 +77,9 @@ bool RenX_CommandsPlugin::initialize()
 	RenX_CommandsPlugin::adminPlayerInfoFormat = this->config.get("AdminPlayerInfoFormat"_jrs, Jupiter::StringS::Format("%.*s - IP: " IRCBOLD "{IP}" IRCBOLD " - HWID: " IRCBOLD "{HWID}" IRCBOLD " - RDNS: " IRCBOLD "{RDNS}" IRCBOLD " - Steam ID: " IRCBOLD "{STEAM}", RenX_CommandsPlugin::playerInfoFormat.size(), RenX_CommandsPlugin::playerInfoFormat.ptr()));
 	RenX_CommandsPlugin::buildingInfoFormat = this->config.get("BuildingInfoFormat"_jrs, ""_jrs IRCCOLOR + RenX::tags->buildingTeamColorTag + RenX::tags->buildingNameTag + IRCCOLOR " - " IRCCOLOR "07"_jrs + RenX::tags->buildingHealthPercentageTag + "%"_jrs);
 	RenX_CommandsPlugin::staffTitle = this->config.get("StaffTitle"_jrs, "Moderator"_jrs);
+	RenX_CommandsPlugin::transfer_chunk_size = this->config.get<size_t>("TransferChunkSize"_jrs, 5000);
+	if (RenX_CommandsPlugin::transfer_chunk_size == 0)
+		RenX_CommandsPlugin::transfer_chunk_size = 1;
 
 	RenX::sanitizeTags(RenX_CommandsPlugin::playerInfoFormat);
 	RenX::sanitizeTags(RenX_CommandsPlugin::adminPlayerInfoFormat);
@@ -111,6 +118,595 @@ const Jupiter::ReadableString &RenX_CommandsPlugin::getStaffTitle() const
 	return RenX_CommandsPlugin::staffTitle;
 }
 
+/** Database transfers */
+
+static const char *ban_columns[] = { "id", "flags", "timestamp", "length", "steamid", "ip", "prefix_length", "hwid", "rdns", "name", "banner", "reason", "vardata" };
+static const char *exemption_columns[] = { "id", "flags", "timestamp", "length", "steamid", "ip", "prefix_length", "setter" };
+
+static void append_json_string(std::string &out, const char *str, size_t length)
+{
+	out += '\"';
+	for (const char *end = str + length; str != end; ++str)
+	{
+		switch (*str)
+		{
+		case '\"':
+			out += "\\\"";
+			break;
+		case '\\':
+			out += "\\\\";
+			break;
+		case '\n':
+			out += "\\n";
+			break;
+		case '\r':
+			out += "\\r";
+			break;
+		case '\t':
+			out += "\\t";
+			break;
+		default:
+			if (static_cast<unsigned char>(*str) < 0x20)
+			{
+				char buffer[8];
+				snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned int>(*str));
+				out += buffer;
+			}
+			else
+				out += *str;
+			break;
+		}
+	}
+	out += '\"';
+}
+
+static void append_csv_string(std::string &out, const char *str, size_t length)
+{
+	const char *end = str + length;
+	if (std::find_if(str, end, [](char chr) { return chr == ',' || chr == '\"' || chr == '\r' || chr == '\n'; }) == end)
+	{
+		out.append(str, length);
+		return;
+	}
+
+	out += '\"';
+	for (; str != end; ++str)
+	{
+		if (*str == '\"')
+			out += '\"';
+		out += *str;
+	}
+	out += '\"';
+}
+
+/** Writes a single record as either a flat JSON object or a CSV row */
+struct RecordWriter
+{
+	RecordWriter(std::string &in_out, bool in_csv) : out(in_out), csv(in_csv)
+	{
+		if (csv == false)
+			out += '{';
+	}
+
+	void field(const char *key, const char *value, size_t length, bool quote)
+	{
+		if (first == false)
+			out += ',';
+		first = false;
+
+		if (csv)
+			append_csv_string(out, value, length);
+		else
+		{
+			append_json_string(out, key, strlen(key));
+			out += ':';
+			if (quote)
+				append_json_string(out, value, length);
+			else
+				out.append(value, length);
+		}
+	}
+
+	void field(const char *key, const Jupiter::ReadableString &value)
+	{
+		field(key, value.ptr(), value.size(), true);
+	}
+
+	void field(const char *key, unsigned long long value)
+	{
+		char buffer[24];
+		field(key, buffer, snprintf(buffer, sizeof(buffer), "%llu", value), false);
+	}
+
+	void field(const char *key, long long value)
+	{
+		char buffer[24];
+		field(key, buffer, snprintf(buffer, sizeof(buffer), "%lld", value), false);
+	}
+
+	void finish()
+	{
+		if (csv == false)
+			out += '}';
+		out += '\n';
+	}
+
+	std::string &out;
+	bool csv;
+	bool first = true;
+};
+
+static void append_header(std::string &out, const char **columns, size_t count)
+{
+	for (size_t index = 0; index != count; ++index)
+	{
+		if (index != 0)
+			out += ',';
+		out += columns[index];
+	}
+	out += '\n';
+}
+
+static void append_hex(std::string &out, const Jupiter::ReadableString &str)
+{
+	static const char hex_digits[] = "0123456789abcdef";
+	for (size_t index = 0; index != str.size(); ++index)
+	{
+		unsigned char chr = static_cast<unsigned char>(str.ptr()[index]);
+		out += hex_digits[chr >> 4];
+		out += hex_digits[chr & 0x0F];
+	}
+}
+
+/** Plugin data of a ban, as space-separated key=value pairs; both halves are hex encoded, since plugins may store any bytes */
+static std::string encode_var_data(const RenX::BanDatabase::Entry::VarDataTableType &var_data)
+{
+	std::string result;
+	for (auto &pair : var_data)
+	{
+		if (result.empty() == false)
+			result += ' ';
+		append_hex(result, pair.first);
+		result += '=';
+		append_hex(result, pair.second);
+	}
+	return result;
+}
+
+static void decode_hex(const char *itr, const char *end, std::string &out)
+{
+	out.clear();
+	for (; end - itr >= 2; itr += 2)
+		out += static_cast<char>(strtoul(std::string(itr, 2).c_str(), nullptr, 16));
+}
+
+static void decode_var_data(const std::string &in, RenX::BanDatabase::Entry::VarDataTableType &var_data)
+{
+	std::string key, value;
+	const char *itr = in.data();
+	const char *end = itr + in.size();
+	while (itr != end)
+	{
+		const char *pair_end = std::find(itr, end, ' ');
+		const char *separator = std::find(itr, pair_end, '=');
+		if (separator != pair_end)
+		{
+			decode_hex(itr, separator, key);
+			decode_hex(separator + 1, pair_end, value);
+			var_data[Jupiter::ReferenceString(key.data(), key.size())] = Jupiter::ReferenceString(value.data(), value.size());
+		}
+
+		itr = pair_end == end ? end : pair_end + 1;
+	}
+}
+
+static void append_ban(std::string &out, bool csv, size_t id, const RenX::BanDatabase::Entry &entry)
+{
+	RecordWriter writer(out, csv);
+	writer.field("id", static_cast<unsigned long long>(id));
+	writer.field("flags", static_cast<unsigned long long>(entry.flags));
+	writer.field("timestamp", static_cast<long long>(std::chrono::duration_cast<std::chrono::seconds>(entry.timestamp.time_since_epoch()).count()));
+	writer.field("length", static_cast<long long>(entry.length.count()));
+	writer.field("steamid", static_cast<unsigned long long>(entry.steamid));
+	writer.field("ip", Jupiter::Socket::ntop4(entry.ip));
+	writer.field("prefix_length", static_cast<unsigned long long>(entry.prefix_length));
+	writer.field("hwid", entry.hwid);
+	writer.field("rdns", entry.rdns);
+	writer.field("name", entry.name);
+	writer.field("banner", entry.banner);
+	writer.field("reason", entry.reason);
+	std::string var_data = encode_var_data(entry.varData);
+	writer.field("vardata", var_data.data(), var_data.size(), true);
+	writer.finish();
+}
+
+static void append_exemption(std::string &out, bool csv, size_t id, const RenX::ExemptionDatabase::Entry &entry)
+{
+	RecordWriter writer(out, csv);
+	writer.field("id", static_cast<unsigned long long>(id));
+	writer.field("flags", static_cast<unsigned long long>(entry.flags));
+	writer.field("timestamp", static_cast<long long>(std::chrono::duration_cast<std::chrono::seconds>(entry.timestamp.time_since_epoch()).count()));
+	writer.field("length", static_cast<long long>(entry.length.count()));
+	writer.field("steamid", static_cast<unsigned long long>(entry.steamid));
+	writer.field("ip", Jupiter::Socket::ntop4(entry.ip));
+	writer.field("prefix_length", static_cast<unsigned long long>(entry.prefix_length));
+	writer.field("setter", entry.setter);
+	writer.finish();
+}
+
+using TransferRecord = std::unordered_map<std::string, std::string>;
+
+static void append_utf8(std::string &out, unsigned int codepoint)
+{
+	if (codepoint < 0x80)
+		out += static_cast<char>(codepoint);
+	else if (codepoint < 0x800)
+	{
+		out += static_cast<char>(0xC0 | (codepoint >> 6));
+		out += static_cast<char>(0x80 | (codepoint & 0x3F));
+	}
+	else
+	{
+		out += static_cast<char>(0xE0 | (codepoint >> 12));
+		out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+		out += static_cast<char>(0x80 | (codepoint & 0x3F));
+	}
+}
+
+/** Parses a JSON string or bare scalar starting at itr; returns false on malformed input */
+static bool parse_json_value(const char *&itr, const char *end, std::string &out)
+{
+	out.clear();
+	while (itr != end && isspace(static_cast<unsigned char>(*itr)))
+		++itr;
+	if (itr == end)
+		return false;
+
+	if (*itr != '\"')
+	{
+		while (itr != end && *itr != ',' && *itr != '}' && isspace(static_cast<unsigned char>(*itr)) == 0)
+			out += *itr++;
+		if (out == "null")
+			out.clear();
+		return true;
+	}
+
+	for (++itr; itr != end; ++itr)
+	{
+		if (*itr == '\"')
+		{
+			++itr;
+			return true;
+		}
+
+		if (*itr != '\\')
+		{
+			out += *itr;
+			continue;
+		}
+
+		if (++itr == end)
+			return false;
+
+		switch (*itr)
+		{
+		case 'n':
+			out += '\n';
+			break;
+		case 'r':
+			out += '\r';
+			break;
+		case 't':
+			out += '\t';
+			break;
+		case 'b':
+			out += '\b';
+			break;
+		case 'f':
+			out += '\f';
+			break;
+		case 'u':
+			if (end - itr < 5)
+				return false;
+			append_utf8(out, static_cast<unsigned int>(strtoul(std::string(itr + 1, 4).c_str(), nullptr, 16)));
+			itr += 4;
+			break;
+		default:
+			out += *itr;
+			break;
+		}
+	}
+
+	return false;
+}
+
+/** Parses a single-line flat JSON object; returns false on malformed input */
+static bool parse_json_line(const std::string &line, TransferRecord &record)
+{
+	const char *itr = line.data();
+	const char *end = itr + line.size();
+	std::string key;
+	std::string value;
+
+	record.clear();
+	while (itr != end && *itr != '{')
+		++itr;
+	if (itr == end)
+		return false;
+	++itr;
+
+	while (true)
+	{
+		while (itr != end && (isspace(static_cast<unsigned char>(*itr)) || *itr == ','))
+			++itr;
+		if (itr == end)
+			return false;
+		if (*itr == '}')
+			return true;
+
+		if (parse_json_value(itr, end, key) == false)
+			return false;
+		while (itr != end && isspace(static_cast<unsigned char>(*itr)))
+			++itr;
+		if (itr == end || *itr != ':')
+			return false;
+		if (parse_json_value(++itr, end, value) == false)
+			return false;
+
+		record[key] = value;
+	}
+}
+
+/** Parses a single CSV row; quoted fields may not span lines */
+static void parse_csv_line(const std::string &line, std::vector<std::string> &fields)
+{
+	std::string field;
+	bool quoted = false;
+
+	fields.clear();
+	for (size_t index = 0; index != line.size(); ++index)
+	{
+		char chr = line[index];
+		if (quoted)
+		{
+			if (chr != '\"')
+				field += chr;
+			else if (index + 1 != line.size() && line[index + 1] == '\"')
+				field += line[++index];
+			else
+				quoted = false;
+		}
+		else if (chr == '\"')
+			quoted = true;
+		else if (chr == ',')
+		{
+			fields.push_back(field);
+			field.clear();
+		}
+		else if (chr != '\r' && chr != '\n')
+			field += chr;
+	}
+	fields.push_back(field);
+}
+
+static bool read_line(FILE *file, std::string &line)
+{
+	char buffer[4096];
+
+	line.clear();
+	while (fgets(buffer, sizeof(buffer), file) != nullptr)
+	{
+		line += buffer;
+		if (line.back() == '\n')
+			return true;
+	}
+
+	return line.empty() == false;
+}
+
+static const std::string &record_get(const TransferRecord &record, const char *key)
+{
+	static const std::string empty;
+	auto itr = record.find(key);
+	return itr == record.end() ? empty : itr->second;
+}
+
+static unsigned long long record_get_unsigned(const TransferRecord &record, const char *key, unsigned long long default_value)
+{
+	const std::string &value = record_get(record, key);
+	return value.empty() ? default_value : strtoull(value.c_str(), nullptr, 0);
+}
+
+static long long record_get_signed(const TransferRecord &record, const char *key, long long default_value)
+{
+	const std::string &value = record_get(record, key);
+	return value.empty() ? default_value : strtoll(value.c_str(), nullptr, 10);
+}
+
+static Jupiter::ReferenceString record_get_string(const TransferRecord &record, const char *key)
+{
+	const std::string &value = record_get(record, key);
+	return Jupiter::ReferenceString(value.data(), value.size());
+}
+
+static std::chrono::system_clock::time_point record_get_timestamp(const TransferRecord &record)
+{
+	const std::string &value = record_get(record, "timestamp");
+	if (value.empty())
+		return std::chrono::system_clock::now();
+	return std::chrono::system_clock::time_point(std::chrono::seconds(strtoll(value.c_str(), nullptr, 10)));
+}
+
+static uint32_t record_get_ip(const TransferRecord &record)
+{
+	const std::string &value = record_get(record, "ip");
+	return value.empty() ? 0U : Jupiter::Socket::pton4(value.c_str());
+}
+
+static RenX::BanDatabase::Entry *make_ban(const TransferRecord &record)
+{
+	RenX::BanDatabase::Entry *entry = new RenX::BanDatabase::Entry();
+	entry->flags = static_cast<uint16_t>(record_get_unsigned(record, "flags", RenX::BanDatabase::Entry::FLAG_ACTIVE | RenX::BanDatabase::Entry::FLAG_TYPE_GAME));
+	entry->timestamp = record_get_timestamp(record);
+	entry->length = std::chrono::seconds(record_get_signed(record, "length", 0));
+	entry->steamid = record_get_unsigned(record, "steamid", 0);
+	entry->ip = record_get_ip(record);
+	entry->prefix_length = static_cast<uint8_t>(record_get_unsigned(record, "prefix_length", entry->ip == 0U ? 0U : 32U));
+	entry->hwid = record_get_string(record, "hwid");
+	entry->rdns = record_get_string(record, "rdns");
+	entry->name = record_get_string(record, "name");
+	entry->banner = record_get_string(record, "banner");
+	entry->reason = record_get_string(record, "reason");
+	decode_var_data(record_get(record, "vardata"), entry->varData);
+	return entry;
+}
+
+static RenX::ExemptionDatabase::Entry *make_exemption(const TransferRecord &record)
+{
+	RenX::ExemptionDatabase::Entry *entry = new RenX::ExemptionDatabase::Entry();
+	entry->flags = static_cast<uint8_t>(record_get_unsigned(record, "flags", RenX::ExemptionDatabase::Entry::FLAG_ACTIVE | RenX::ExemptionDatabase::Entry::FLAG_TYPE_BAN));
+	entry->timestamp = record_get_timestamp(record);
+	entry->length = std::chrono::seconds(record_get_signed(record, "length", 0));
+	entry->steamid = record_get_unsigned(record, "steamid", 0);
+	entry->ip = record_get_ip(record);
+	entry->prefix_length = static_cast<uint8_t>(record_get_unsigned(record, "prefix_length", entry->ip == 0U ? 0U : 32U));
+	entry->setter = record_get_string(record, "setter");
+	return entry;
+}
+
+bool RenX_CommandsPlugin::startTransfer(const DatabaseTransfer &in_transfer)
+{
+	if (RenX_CommandsPlugin::transfer_active)
+		return false;
+
+	RenX_CommandsPlugin::transfer = in_transfer;
+	RenX_CommandsPlugin::transfer.start_time = std::chrono::steady_clock::now();
+	RenX_CommandsPlugin::transfer_active = true;
+
+	if (RenX_CommandsPlugin::transfer.import == false && RenX_CommandsPlugin::transfer.csv)
+	{
+		std::string header;
+		if (RenX_CommandsPlugin::transfer.exemptions)
+			append_header(header, exemption_columns, sizeof(exemption_columns) / sizeof(*exemption_columns));
+		else
+			append_header(header, ban_columns, sizeof(ban_columns) / sizeof(*ban_columns));
+		fwrite(header.data(), sizeof(char), header.size(), RenX_CommandsPlugin::transfer.file);
+	}
+
+	return true;
+}
+
+int RenX_CommandsPlugin::think()
+{
+	if (RenX_CommandsPlugin::transfer_active)
+	{
+		DatabaseTransfer &job = RenX_CommandsPlugin::transfer;
+		bool finished;
+
+		if (job.import)
+		{
+			std::vector<RenX::BanDatabase::Entry *> bans;
+			std::vector<RenX::ExemptionDatabase::Entry *> exemptions;
+			std::vector<std::string> fields;
+			TransferRecord record;
+			std::string line;
+			size_t count = 0;
+
+			while (count != RenX_CommandsPlugin::transfer_chunk_size && read_line(job.file, line))
+			{
+				++count;
+				if (job.lines++ == 0 && job.csv)
+				{
+					parse_csv_line(line, job.columns);
+					continue;
+				}
+
+				if (line.find_first_not_of(" \t\r\n") == std::string::npos)
+					continue;
+
+				if (job.csv)
+				{
+					parse_csv_line(line, fields);
+					record.clear();
+					for (size_t index = 0; index != fields.size() && index != job.columns.size(); ++index)
+						record[job.columns[index]] = fields[index];
+				}
+				else if (parse_json_line(line, record) == false)
+				{
+					printf("Warning: Skipping malformed record on line %zu of %s" ENDL, job.lines, job.filename.c_str());
+					++job.skipped;
+					continue;
+				}
+
+				if (job.exemptions)
+					exemptions.push_back(make_exemption(record));
+				else
+					bans.push_back(make_ban(record));
+			}
+
+			size_t batch_size = bans.size() + exemptions.size();
+			size_t added;
+			if (job.exemptions)
+				added = RenX::exemptionDatabase->add_entries(exemptions);
+			else
+				added = RenX::banDatabase->add_entries(bans);
+
+			job.added += added;
+			job.skipped += batch_size - added;
+			finished = count != RenX_CommandsPlugin::transfer_chunk_size;
+
+			if (finished == false)
+				printf("Imported %zu records from %s (%zu skipped)..." ENDL, job.added, job.filename.c_str(), job.skipped);
+		}
+		else
+		{
+			std::string buffer;
+			size_t total;
+
+			if (job.exemptions)
+			{
+				const Jupiter::ArrayList<RenX::ExemptionDatabase::Entry> &entries = RenX::exemptionDatabase->getEntries();
+				total = entries.size();
+				for (size_t end = std::min(total, job.index + RenX_CommandsPlugin::transfer_chunk_size); job.index != end; ++job.index)
+					append_exemption(buffer, job.csv, job.index, *entries.get(job.index));
+			}
+			else
+			{
+				const Jupiter::ArrayList<RenX::BanDatabase::Entry> &entries = RenX::banDatabase->getEntries();
+				total = entries.size();
+				for (size_t end = std::min(total, job.index + RenX_CommandsPlugin::transfer_chunk_size); job.index != end; ++job.index)
+					append_ban(buffer, job.csv, job.index, *entries.get(job.index));
+			}
+
+			fwrite(buffer.data(), sizeof(char), buffer.size(), job.file);
+			job.added = job.index;
+			finished = job.index >= total;
+
+			if (finished == false)
+				printf("Exported %zu of %zu records to %s..." ENDL, job.index, total, job.filename.c_str());
+		}
+
+		if (finished)
+		{
+			fclose(job.file);
+			job.file = nullptr;
+			RenX_CommandsPlugin::transfer_active = false;
+
+			double elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - job.start_time).count();
+			if (job.import)
+			{
+				printf("Finished importing %s: %zu records added, %zu skipped in %.2f seconds." ENDL, job.filename.c_str(), job.added, job.skipped, elapsed);
+				if (job.exemptions == false && job.added != 0)
+					RenX::getCore()->banCheck();
+			}
+			else
+				printf("Finished exporting %zu records to %s in %.2f seconds." ENDL, job.added, job.filename.c_str(), elapsed);
+		}
+	}
+
+	return Jupiter::Plugin::think();
+}
+
 // Plugin instantiation and entry point.
 RenX_CommandsPlugin pluginInstance;
 
@@ -174,6 +770,113 @@ const Jupiter::ReadableString &RCONConsoleCommand::getHelp(const Jupiter::Readab
 
 CONSOLE_COMMAND_INIT(RCONConsoleCommand)
 
+/** Parses "<bans|exemptions> <file> [jsonl|csv]" into a transfer; returns false on error */
+static bool parse_transfer_parameters(const Jupiter::ReadableString &parameters, bool import, RenX_CommandsPlugin::DatabaseTransfer &transfer)
+{
+	const char *syntax = import ? "importdb <bans|exemptions> <file> [jsonl|csv]" : "exportdb <bans|exemptions> <file> [jsonl|csv]";
+	if (parameters.wordCount(WHITESPACE) < 2)
+	{
+		printf("Error: Too Few Parameters. Syntax: %s" ENDL, syntax);
+		return false;
+	}
+
+	Jupiter::ReferenceString database = Jupiter::ReferenceString::getWord(parameters, 0, WHITESPACE);
+	if (database.equalsi("bans"))
+		transfer.exemptions = false;
+	else if (database.equalsi("exemptions"))
+		transfer.exemptions = true;
+	else
+	{
+		printf("Error: Unknown database. Syntax: %s" ENDL, syntax);
+		return false;
+	}
+
+	transfer.import = import;
+	transfer.filename = static_cast<std::string>(Jupiter::ReferenceString::getWord(parameters, 1, WHITESPACE));
+
+	Jupiter::ReferenceString format = Jupiter::ReferenceString::getWord(parameters, 2, WHITESPACE);
+	if (format.isEmpty())
+		transfer.csv = transfer.filename.size() >= 4 && Jupiter::ReferenceString(transfer.filename.c_str() + transfer.filename.size() - 4, 4).equalsi(".csv");
+	else if (format.equalsi("csv"))
+		transfer.csv = true;
+	else if (format.equalsi("jsonl") || format.equalsi("json"))
+		transfer.csv = false;
+	else
+	{
+		printf("Error: Unknown format. Syntax: %s" ENDL, syntax);
+		return false;
+	}
+
+	transfer.file = fopen(transfer.filename.c_str(), import ? "rb" : "wb");
+	if (transfer.file == nullptr)
+	{
+		printf("Error: Unable to open file: %s" ENDL, transfer.filename.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+// ExportDB Console Command
+
+ExportDBConsoleCommand::ExportDBConsoleCommand()
+{
+	this->addTrigger(STRING_LITERAL_AS_REFERENCE("exportdb"));
+}
+
+void ExportDBConsoleCommand::trigger(const Jupiter::ReadableString &parameters)
+{
+	RenX_CommandsPlugin::DatabaseTransfer transfer;
+	if (parse_transfer_parameters(parameters, false, transfer))
+	{
+		if (pluginInstance.startTransfer(transfer))
+			printf("Exporting %s to %s..." ENDL, transfer.exemptions ? "exemptions" : "bans", transfer.filename.c_str());
+		else
+		{
+			fclose(transfer.file);
+			puts("Error: A database transfer is already in progress.");
+		}
+	}
+}
+
+const Jupiter::ReadableString &ExportDBConsoleCommand::getHelp(const Jupiter::ReadableString &)
+{
+	static STRING_LITERAL_AS_NAMED_REFERENCE(defaultHelp, "Exports the ban or exemption database to a JSON Lines or CSV file. Syntax: exportdb <bans|exemptions> <file> [jsonl|csv]");
+	return defaultHelp;
+}
+
+CONSOLE_COMMAND_INIT(ExportDBConsoleCommand)
+
+// ImportDB Console Command
+
+ImportDBConsoleCommand::ImportDBConsoleCommand()
+{
+	this->addTrigger(STRING_LITERAL_AS_REFERENCE("importdb"));
+}
+
+void ImportDBConsoleCommand::trigger(const Jupiter::ReadableString &parameters)
+{
+	RenX_CommandsPlugin::DatabaseTransfer transfer;
+	if (parse_transfer_parameters(parameters, true, transfer))
+	{
+		if (pluginInstance.startTransfer(transfer))
+			printf("Importing %s from %s..." ENDL, transfer.exemptions ? "exemptions" : "bans", transfer.filename.c_str());
+		else
+		{
+			fclose(transfer.file);
+			puts("Error: A database transfer is already in progress.");
+		}
+	}
+}
+
+const Jupiter::ReadableString &ImportDBConsoleCommand::getHelp(const Jupiter::ReadableString &)
+{
+	static STRING_LITERAL_AS_NAMED_REFERENCE(defaultHelp, "Imports entries from a JSON Lines or CSV file into the ban or exemption database, skipping duplicates. Syntax: importdb <bans|exemptions> <file> [jsonl|csv]");
+	return defaultHelp;
+}
+
+CONSOLE_COMMAND_INIT(ImportDBConsoleCommand)
+
 /** IRC Commands */
 
 // Msg IRC Command
@@ -1910,73 +2613,59 @@ void BanSearchIRCCommand::create()
 
 void BanSearchIRCCommand::trigger(IRC_Bot *source, const Jupiter::ReadableString &channel, const Jupiter::ReadableString &nick, const Jupiter::ReadableString &parameters)
 {
-	auto entries = RenX::banDatabase->getEntries();
+	const auto &entries = RenX::banDatabase->getEntries();
 	if (parameters.isNotEmpty())
 	{
 		if (entries.size() == 0)
 			source->sendNotice(nick, STRING_LITERAL_AS_REFERENCE("The ban database is empty!"));
 		else
 		{
-			RenX::BanDatabase::Entry *entry;
+			typedef RenX::BanDatabase::QueryFilter::Type FilterType;
+			RenX::BanDatabase::QueryFilter filter;
 			Jupiter::ReferenceString params = Jupiter::ReferenceString::gotoWord(parameters, 1, WHITESPACE);
-			std::function<bool(unsigned int)> isMatch = [&](unsigned int type_l) -> bool
-			{
-				switch (type_l)
-				{
-				default:
-				case 0:	// ANY
-					return isMatch(1) || isMatch(2) || isMatch(3) || isMatch(4);
-				case 1: // ALL
-					return true;
-				case 2:	// IP
-					return entry->ip == params.asUnsignedInt();
-				case 3: // HWID
-					return entry->hwid.equals(params);
-				case 4: // RDNS
-					return entry->rdns.equals(params);
-				case 5:	// STEAM
-					return entry->steamid == params.asUnsignedLongLong();
-				case 6:	// NAME
-					return entry->name.equalsi(params);
-				case 7:	// BANNER
-					return entry->banner.equalsi(params);
-				case 8:	// ACTIVE
-					return params.asBool() == entry->is_active();
-				}
-			};
-
-			unsigned int type;
 			Jupiter::ReferenceString type_str = Jupiter::ReferenceString::getWord(parameters, 0, WHITESPACE);
 			if (type_str.equalsi(STRING_LITERAL_AS_REFERENCE("all")) || type_str.equals('*'))
-				type = 1;
+				filter.type = FilterType::All;
 			else if (type_str.equalsi(STRING_LITERAL_AS_REFERENCE("ip")))
-				type = 2;
+				filter.type = FilterType::IP;
 			else if (type_str.equalsi(STRING_LITERAL_AS_REFERENCE("hwid")))
-				type = 3;
+				filter.type = FilterType::HWID;
 			else if (type_str.equalsi(STRING_LITERAL_AS_REFERENCE("rdns")))
-				type = 4;
+				filter.type = FilterType::RDNS;
 			else if (type_str.equalsi(STRING_LITERAL_AS_REFERENCE("steam")))
-				type = 5;
+				filter.type = FilterType::Steam;
 			else if (type_str.equalsi(STRING_LITERAL_AS_REFERENCE("name")))
-				type = 6;
+				filter.type = FilterType::Name;
 			else if (type_str.equalsi(STRING_LITERAL_AS_REFERENCE("banner")))
-				type = 7;
+				filter.type = FilterType::Banner;
 			else if (type_str.equalsi(STRING_LITERAL_AS_REFERENCE("active")))
-				type = 8;
+				filter.type = FilterType::Active;
 			else
 			{
-				type = 0;
+				filter.type = FilterType::Any;
 				params = parameters;
 			}
 
+			// Parse parameters once, rather than per-entry
+			filter.text = params;
+			filter.steamid = params.asUnsignedLongLong();
+			filter.active = params.asBool();
+			if (params.span("0123456789"_jrs) == params.size())
+				filter.ip = params.asUnsignedInt();
+			else
+				filter.ip = Jupiter::Socket::pton4(static_cast<std::string>(params).c_str());
+
 			Jupiter::String out(256);
 			Jupiter::String types(64);
 			char timeStr[256];
-			for (size_t i = 0; i != entries.size(); i++)
+			RenX::BanDatabase::QueryCursor cursor;
+			std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+			do
 			{
-				entry = entries.get(i);
-				if (isMatch(type))
+				cursor = RenX::banDatabase->query(filter, cursor, 64);
+				for (size_t i : cursor.indexes)
 				{
+					RenX::BanDatabase::Entry *entry = entries.get(i);
 					time_t current_time = std::chrono::system_clock::to_time_t(entry->timestamp);
 					Jupiter::StringS ip_str = Jupiter::Socket::ntop4(entry->ip);
 					strftime(timeStr, sizeof(timeStr), "%b %d %Y, %H:%M:%S", localtime(&current_time));
@@ -2006,7 +2695,7 @@ void BanSearchIRCCommand::trigger(IRC_Bot *source, const Jupiter::ReadableString
 					}
 
 					out.format("ID: %lu (" IRCCOLOR "%sactive" IRCCOLOR "); Date: %s; IP: %.*s/%u; HWID: %.*s; Steam: %llu; Types:%.*s Name: %.*s; Banner: %.*s",
-						i, entry->is_active() ? "12" : "04in", timeStr, ip_str.size(), ip_str.ptr(), entry->prefix_length, entry->hwid.size(), entry->hwid.ptr(), entry->steamid,
+						i, entry->is_active() && entry->is_expired(now) == false ? "12" : "04in", timeStr, ip_str.size(), ip_str.ptr(), entry->prefix_length, entry->hwid.size(), entry->hwid.ptr(), entry->steamid,
 						types.size(), types.ptr(), entry->name.size(), entry->name.ptr(), entry->banner.size(), entry->banner.ptr());
 
 					if (entry->rdns.isNotEmpty())
@@ -2021,8 +2710,9 @@ void BanSearchIRCCommand::trigger(IRC_Bot *source, const Jupiter::ReadableString
 					}
 					source->sendNotice(nick, out);
 				}
-			}
-			if (out.isEmpty())
+			} while (cursor.has_next());
+
+			if (cursor.total == 0)
 				source->sendNotice(nick, STRING_LITERAL_AS_REFERENCE("No matches found."));
 		}
 	}
@@ -2032,7 +2722,7 @@ void BanSearchIRCCommand::trigger(IRC_Bot *source, const Jupiter::ReadableString
 
 const Jupiter::ReadableString &BanSearchIRCCommand::getHelp(const Jupiter::ReadableString &)
 {
-	static STRING_LITERAL_AS_NAMED_REFERENCE(defaultHelp, "Searches the ban database for an entry. Syntax: bsearch [ip/rdns/steam/name/banner/active/any/all = any] <player ip/steam/name/banner>");
+	static STRING_LITERAL_AS_NAMED_REFERENCE(defaultHelp, "Searches the ban database for an entry. Syntax: bsearch [ip/hwid/rdns/steam/name/banner/active/any/all = any] <player ip/steam/name/banner>");
 	return defaultHelp;
 }
 
@@ -20,6 +20,8 @@
 #define _RENX_COMMANDS_H_HEADER
 
 #include <chrono>
+#include <string>
+#include <vector>
 #include "Console_Command.h"
 #include "IRC_Command.h"
 #include "RenX_GameCommand.h"
@@ -35,8 +37,35 @@ public: // RenX::Plugin
 public: // Jupiter::Plugin
 	virtual bool initialize() override;
 	int OnRehash() override;
+	int think() override;
 
 public:
+	/**
+	* @brief Represents a streaming import or export of the ban or exemption database.
+	*/
+	struct DatabaseTransfer
+	{
+		FILE *file = nullptr;
+		std::string filename;
+		bool import = false;
+		bool exemptions = false;
+		bool csv = false;
+		size_t index = 0; /** Next entry to export */
+		size_t lines = 0; /** Lines read while importing */
+		size_t added = 0;
+		size_t skipped = 0;
+		std::vector<std::string> columns; /** CSV header */
+		std::chrono::steady_clock::time_point start_time;
+	};
+
+	/**
+	* @brief Starts a database import or export, which is processed in chunks by think().
+	*
+	* @param transfer Transfer to start; its file must already be open
+	* @return True if the transfer was started, false if another transfer is in progress.
+	*/
+	bool startTransfer(const DatabaseTransfer &transfer);
+
 	std::chrono::seconds getTBanTime() const;
 	const Jupiter::ReadableString &getPlayerInfoFormat() const;
 	const Jupiter::ReadableString &getAdminPlayerInfoFormat() const;
@@ -49,10 +78,15 @@ private:
 	Jupiter::StringS adminPlayerInfoFormat;
 	Jupiter::StringS buildingInfoFormat;
 	Jupiter::StringS staffTitle;
+	size_t transfer_chunk_size;
+	bool transfer_active = false;
+	DatabaseTransfer transfer;
 };
 
 GENERIC_CONSOLE_COMMAND(RawRCONConsoleCommand)
 GENERIC_CONSOLE_COMMAND(RCONConsoleCommand)
+GENERIC_CONSOLE_COMMAND(ExportDBConsoleCommand)
+GENERIC_CONSOLE_COMMAND(ImportDBConsoleCommand)
 //GENERIC_CONSOLE_COMMAND(RCONSelectConsoleCommand)
 
 GENERIC_IRC_COMMAND(MsgIRCCommand)
@@ -18,10 +18,23 @@
 
 #include <ctime>
 #include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+#if defined _WIN32
+#include <io.h>
+#else // _WIN32
+#include <unistd.h>
+#endif // _WIN32
+#if defined __linux__
+#include <sys/inotify.h>
+#endif // __linux__
 #include "Jupiter/IRC_Client.h"
 #include "RenX_PlayerInfo.h"
 #include "RenX_BanDatabase.h"
 #include "RenX_Core.h"
+#include "RenX_Functions.h"
 #include "RenX_Plugin.h"
 
 using namespace Jupiter::literals;
@@ -30,11 +43,71 @@ RenX::BanDatabase _banDatabase;
 RenX::BanDatabase *RenX::banDatabase = &_banDatabase;
 RenX::BanDatabase &RenX::defaultBanDatabase = _banDatabase;
 
+static std::string index_key(const Jupiter::ReadableString &str)
+{
+	return std::string(str.ptr(), str.size());
+}
+
+static std::string index_key_lower(const Jupiter::ReadableString &str)
+{
+	std::string result(str.ptr(), str.size());
+	for (char &chr : result)
+		chr = static_cast<char>(tolower(static_cast<unsigned char>(chr)));
+	return result;
+}
+
+static uint32_t ban_netmask(uint8_t prefix_length)
+{
+	if (prefix_length >= 32)
+		return 0xFFFFFFFF;
+	return Jupiter_prefix_length_to_netmask(prefix_length);
+}
+
+static uint64_t ip_index_key(uint32_t ip, uint8_t prefix_length)
+{
+	if (prefix_length > 32)
+		prefix_length = 32;
+	return (static_cast<uint64_t>(prefix_length) << 32) | (ip & ban_netmask(prefix_length));
+}
+
+/** Record types (write_version >= 6) */
+static const uint8_t RECORD_ENTRY = 0x00;
+static const uint8_t RECORD_DEACTIVATION = 0x01;
+
+static void truncate_file(FILE *file, long size)
+{
+	fflush(file);
+#if defined _WIN32
+	_chsize_s(_fileno(file), size);
+#else // _WIN32
+	if (ftruncate(fileno(file), size) != 0)
+		fprintf(stderr, "[RenX] ERROR: Failed to truncate the ban database file: %s" ENDL, strerror(errno));
+#endif // _WIN32
+}
+
+template<typename MapT, typename KeyT> static void append_matches(const MapT &map, const KeyT &key, std::vector<size_t> &out)
+{
+	auto range = map.equal_range(key);
+	while (range.first != range.second)
+	{
+		out.push_back(range.first->second);
+		++range.first;
+	}
+}
+
 void RenX::BanDatabase::process_data(Jupiter::DataBuffer &buffer, FILE *file, fpos_t pos)
 {
 	if (RenX::BanDatabase::read_version < 3U)
 		return; // incompatible database version
 
+	if (RenX::BanDatabase::read_version >= 6U && buffer.pop<uint8_t>() == RECORD_DEACTIVATION)
+	{
+		size_t index = static_cast<size_t>(buffer.pop<uint64_t>());
+		if (index < RenX::BanDatabase::entries.size())
+			RenX::BanDatabase::apply_deactivation(index);
+		return;
+	}
+
 	RenX::BanDatabase::Entry *entry = new RenX::BanDatabase::Entry();
 	entry->pos = pos;
 
@@ -65,6 +138,7 @@ void RenX::BanDatabase::process_data(Jupiter::DataBuffer &buffer, FILE *file, fp
 		entry->varData[buffer.pop<Jupiter::String_Strict, char>()] = buffer.pop<Jupiter::String_Strict, char>();
 
 	RenX::BanDatabase::entries.add(entry);
+	RenX::BanDatabase::index_entry(RenX::BanDatabase::entries.size() - 1);
 }
 
 void RenX::BanDatabase::process_header(FILE *file)
@@ -83,39 +157,76 @@ void RenX::BanDatabase::process_file_finish(FILE *file)
 {
 	if (RenX::BanDatabase::read_version < 3)
 	{
-		if (freopen(RenX::BanDatabase::filename.c_str(), "wb", file) == nullptr)
-			puts("FATAL ERROR: UNABLE TO REMOVE UNSUPPORTED BAN DATABASE FILE VERSION");
-		else
-		{
-			puts("Warning: Unsupported ban database file version. The database will be removed and rewritten.");
-			this->create_header(file);
-			fgetpos(file, std::addressof(RenX::BanDatabase::eof));
-			RenX::BanDatabase::read_version = RenX::BanDatabase::write_version;
-		}
+		puts("Warning: Unsupported ban database file version. The database will be removed and rewritten.");
+		RenX::BanDatabase::rewrite(file); // no entries were read
 		return;
 	}
 	else if (RenX::BanDatabase::read_version < RenX::BanDatabase::write_version)
+		RenX::BanDatabase::rewrite(file);
+
+	fgetpos(file, std::addressof(RenX::BanDatabase::eof));
+}
+
+void RenX::BanDatabase::rewrite(FILE *file)
+{
+	// rewritten in place rather than reopened, so that the caller's lock is held throughout
+	rewind(file);
+	this->create_header(file);
+	for (size_t index = 0; index != RenX::BanDatabase::entries.size(); ++index)
+		RenX::BanDatabase::write(RenX::BanDatabase::entries.get(index), file);
+
+	truncate_file(file, ftell(file));
+	fgetpos(file, std::addressof(RenX::BanDatabase::eof));
+	RenX::BanDatabase::read_version = RenX::BanDatabase::write_version;
+}
+
+bool RenX::BanDatabase::load_file()
+{
+	// create the file if it doesn't exist, without truncating one created meanwhile by another process
+	FILE *file = fopen(RenX::BanDatabase::filename.c_str(), "ab");
+	if (file == nullptr)
+		return false;
+	fclose(file);
+
+	file = fopen(RenX::BanDatabase::filename.c_str(), "r+b");
+	if (file == nullptr)
+		return false;
+
+	// held through the initial read and any upgrade, so that no other process appends to or reads a partially rewritten file
+	RenX::lockFile(file, true);
+
+	fseek(file, 0, SEEK_END);
+	if (ftell(file) == 0)
 	{
-		if (freopen(RenX::BanDatabase::filename.c_str(), "wb", file) != nullptr)
-		{
-			this->create_header(file);
-			for (size_t index = 0; index != RenX::BanDatabase::entries.size(); ++index)
-				RenX::BanDatabase::write(RenX::BanDatabase::entries.get(index), file);
-		}
+		this->create_header(file);
+		RenX::BanDatabase::read_version = RenX::BanDatabase::write_version;
+	}
+	else
+	{
+		rewind(file);
+		this->process_header(file);
 	}
 
 	fgetpos(file, std::addressof(RenX::BanDatabase::eof));
+	RenX::BanDatabase::read_records(file);
+	this->process_file_finish(file);
+
+	RenX::unlockFile(file);
+	fclose(file);
+	return true;
 }
 
 void RenX::BanDatabase::upgrade_database()
 {
-	FILE *file = fopen(RenX::BanDatabase::filename.c_str(), "wb");
+	FILE *file = fopen(RenX::BanDatabase::filename.c_str(), "r+b");
+	if (file == nullptr)
+		file = fopen(RenX::BanDatabase::filename.c_str(), "wb");
+
 	if (file != nullptr)
 	{
-		this->create_header(file);
-		for (size_t index = 0; index != RenX::BanDatabase::entries.size(); ++index)
-			RenX::BanDatabase::write(RenX::BanDatabase::entries.get(index), file);
-		
+		RenX::lockFile(file, true);
+		RenX::BanDatabase::rewrite(file);
+		RenX::unlockFile(file);
 		fclose(file);
 	}
 }
@@ -123,10 +234,12 @@ void RenX::BanDatabase::upgrade_database()
 void RenX::BanDatabase::write(RenX::BanDatabase::Entry *entry)
 {
 	FILE *file = fopen(filename.c_str(), "r+b");
-	fsetpos(file, std::addressof(RenX::BanDatabase::eof));
 	if (file != nullptr)
 	{
+		RenX::lockFile(file, true);
+		fseek(file, 0, SEEK_END);
 		RenX::BanDatabase::write(entry, file);
+		RenX::unlockFile(file);
 		fclose(file);
 	}
 }
@@ -137,6 +250,7 @@ void RenX::BanDatabase::write(RenX::BanDatabase::Entry *entry, FILE *file)
 	fgetpos(file, &entry->pos);
 
 	// push data from entry to buffer
+	buffer.push(RECORD_ENTRY);
 	buffer.push(entry->flags);
 	buffer.push(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(entry->timestamp.time_since_epoch()).count()));
 	buffer.push(static_cast<uint64_t>(entry->length.count()));
@@ -192,8 +306,7 @@ void RenX::BanDatabase::add(RenX::Server *server, const RenX::PlayerInfo &player
 		if (xPlugins.get(i)->RenX_OnBan(*server, player, pluginData))
 			entry->varData[xPlugins.get(i)->getName()] = pluginData;
 
-	entries.add(entry);
-	RenX::BanDatabase::write(entry);
+	RenX::BanDatabase::commit(entry);
 }
 
 void RenX::BanDatabase::add(const Jupiter::ReadableString &name, uint32_t ip, uint8_t prefix_length, uint64_t steamid, const Jupiter::ReadableString &hwid, const Jupiter::ReadableString &rdns, const Jupiter::ReadableString &banner, Jupiter::ReadableString &reason, std::chrono::seconds length, uint16_t flags)
@@ -212,29 +325,416 @@ void RenX::BanDatabase::add(const Jupiter::ReadableString &name, uint32_t ip, ui
 	entry->banner = banner;
 	entry->reason = reason;
 
-	entries.add(entry);
-	RenX::BanDatabase::write(entry);
+	RenX::BanDatabase::commit(entry);
+}
+
+void RenX::BanDatabase::commit(RenX::BanDatabase::Entry *entry)
+{
+	FILE *file = fopen(RenX::BanDatabase::filename.c_str(), "r+b");
+	if (file == nullptr)
+	{
+		RenX::BanDatabase::entries.add(entry);
+		RenX::BanDatabase::index_entry(RenX::BanDatabase::entries.size() - 1);
+		return;
+	}
+
+	// Pick up any records appended by other processes first, so that ban IDs match across processes
+	RenX::lockFile(file, true);
+	if (RenX::BanDatabase::shared)
+		RenX::BanDatabase::read_records(file);
+
+	RenX::BanDatabase::entries.add(entry);
+	RenX::BanDatabase::index_entry(RenX::BanDatabase::entries.size() - 1);
+
+	fseek(file, 0, SEEK_END);
+	RenX::BanDatabase::write(entry, file);
+	RenX::unlockFile(file);
+	fclose(file);
+}
+
+size_t RenX::BanDatabase::add_entries(std::vector<RenX::BanDatabase::Entry *> &batch)
+{
+	size_t result = 0;
+	FILE *file = fopen(RenX::BanDatabase::filename.c_str(), "r+b");
+	if (file != nullptr)
+	{
+		RenX::lockFile(file, true);
+		if (RenX::BanDatabase::shared)
+			RenX::BanDatabase::read_records(file);
+		fseek(file, 0, SEEK_END);
+	}
+
+	for (RenX::BanDatabase::Entry *entry : batch)
+	{
+		if (RenX::BanDatabase::find_duplicate(*entry) != Jupiter::INVALID_INDEX)
+		{
+			delete entry;
+			continue;
+		}
+
+		RenX::BanDatabase::entries.add(entry);
+		RenX::BanDatabase::index_entry(RenX::BanDatabase::entries.size() - 1);
+		if (file != nullptr)
+			RenX::BanDatabase::write(entry, file);
+		++result;
+	}
+	batch.clear();
+
+	if (file != nullptr)
+	{
+		RenX::unlockFile(file);
+		fclose(file);
+	}
+
+	return result;
+}
+
+size_t RenX::BanDatabase::find_duplicate(const RenX::BanDatabase::Entry &entry) const
+{
+	std::vector<size_t> candidates;
+	if (entry.steamid != 0)
+		append_matches(RenX::BanDatabase::steam_index, entry.steamid, candidates);
+	else if (entry.ip != 0)
+		append_matches(RenX::BanDatabase::ip_index, ip_index_key(entry.ip, entry.prefix_length), candidates);
+	else if (entry.hwid.isNotEmpty())
+		append_matches(RenX::BanDatabase::hwid_index, index_key(entry.hwid), candidates);
+	else if (entry.name.isNotEmpty())
+		append_matches(RenX::BanDatabase::name_index, index_key_lower(entry.name), candidates);
+	else if (entry.rdns.isNotEmpty())
+		append_matches(RenX::BanDatabase::rdns_index, index_key(entry.rdns), candidates);
+
+	for (size_t index : candidates)
+	{
+		const RenX::BanDatabase::Entry *itr = RenX::BanDatabase::entries.get(index);
+		if (itr->timestamp == entry.timestamp
+			&& itr->length == entry.length
+			&& itr->steamid == entry.steamid
+			&& itr->ip == entry.ip
+			&& itr->prefix_length == entry.prefix_length
+			&& itr->hwid.equals(entry.hwid)
+			&& itr->rdns.equals(entry.rdns)
+			&& itr->name.equals(entry.name))
+			return index;
+	}
+
+	return Jupiter::INVALID_INDEX;
 }
 
 bool RenX::BanDatabase::deactivate(size_t index)
+{
+	FILE *file = fopen(RenX::BanDatabase::filename.c_str(), "r+b");
+	if (file != nullptr)
+	{
+		RenX::lockFile(file, true);
+		if (RenX::BanDatabase::shared)
+			RenX::BanDatabase::read_records(file);
+	}
+
+	bool result = RenX::BanDatabase::apply_deactivation(index);
+	if (file != nullptr)
+	{
+		if (result)
+		{
+			Jupiter::DataBuffer buffer;
+			buffer.push(RECORD_DEACTIVATION);
+			buffer.push(static_cast<uint64_t>(index));
+
+			fseek(file, 0, SEEK_END);
+			buffer.push_to(file);
+			fgetpos(file, std::addressof(RenX::BanDatabase::eof));
+		}
+
+		RenX::unlockFile(file);
+		fclose(file);
+	}
+
+	return result;
+}
+
+bool RenX::BanDatabase::apply_deactivation(size_t index)
 {
 	RenX::BanDatabase::Entry *entry = RenX::BanDatabase::entries.get(index);
 	if (entry->is_active())
 	{
 		entry->unset_active();
-		FILE *file = fopen(RenX::BanDatabase::filename.c_str(), "r+b");
-		if (file != nullptr)
-		{
-			fsetpos(file, &entry->pos);
-			fseek(file, sizeof(size_t), SEEK_CUR);
-			fwrite(std::addressof(entry->flags), sizeof(entry->flags), 1, file);
-			fclose(file);
-		}
+		RenX::BanDatabase::active_entries.erase(index);
+		++RenX::BanDatabase::generation;
 		return true;
 	}
 	return false;
 }
 
+size_t RenX::BanDatabase::read_records(FILE *file)
+{
+	size_t result = 0;
+	size_t record_size;
+	fpos_t pos;
+	long file_size, record_end;
+
+	fseek(file, 0, SEEK_END);
+	file_size = ftell(file);
+	fsetpos(file, std::addressof(RenX::BanDatabase::eof));
+
+	while (fgetpos(file, &pos) == 0 && fread(std::addressof(record_size), sizeof(size_t), 1, file) == 1)
+	{
+		// Stop at incomplete records; they'll be picked up once they're finished
+		record_end = ftell(file) + static_cast<long>(record_size);
+		if (record_end > file_size)
+			break;
+
+		Jupiter::DataBuffer buffer;
+		buffer.pop_from(file, record_size);
+		this->process_data(buffer, file, pos);
+		fseek(file, record_end, SEEK_SET);
+		fgetpos(file, std::addressof(RenX::BanDatabase::eof));
+		++result;
+	}
+
+	return result;
+}
+
+size_t RenX::BanDatabase::tail()
+{
+	FILE *file = fopen(RenX::BanDatabase::filename.c_str(), "rb");
+	if (file == nullptr)
+		return 0;
+
+	RenX::lockFile(file, false);
+	size_t result = RenX::BanDatabase::read_records(file);
+	RenX::unlockFile(file);
+	fclose(file);
+	return result;
+}
+
+bool RenX::BanDatabase::think()
+{
+	if (RenX::BanDatabase::shared == false)
+		return false;
+
+#if defined __linux__
+	if (RenX::BanDatabase::inotify_fd >= 0)
+	{
+		char events[1024];
+		bool modified = false;
+		while (read(RenX::BanDatabase::inotify_fd, events, sizeof(events)) > 0)
+			modified = true;
+
+		return modified && RenX::BanDatabase::tail() != 0;
+	}
+#endif // __linux__
+
+	// No change notifications available; poll instead
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (now < RenX::BanDatabase::next_poll)
+		return false;
+
+	RenX::BanDatabase::next_poll = now + std::chrono::seconds(1);
+	return RenX::BanDatabase::tail() != 0;
+}
+
+bool RenX::BanDatabase::isShared() const
+{
+	return RenX::BanDatabase::shared;
+}
+
+void RenX::BanDatabase::index_entry(size_t index)
+{
+	RenX::BanDatabase::Entry *entry = RenX::BanDatabase::entries.get(index);
+
+	if (entry->steamid != 0)
+		RenX::BanDatabase::steam_index.emplace(entry->steamid, index);
+
+	if (entry->ip != 0)
+	{
+		uint8_t prefix_length = entry->prefix_length > 32 ? 32 : entry->prefix_length;
+		RenX::BanDatabase::ip_index.emplace(ip_index_key(entry->ip, prefix_length), index);
+		++RenX::BanDatabase::ip_prefix_counts[prefix_length];
+	}
+
+	if (entry->hwid.isNotEmpty())
+		RenX::BanDatabase::hwid_index.emplace(index_key(entry->hwid), index);
+
+	if (entry->rdns.isNotEmpty())
+	{
+		RenX::BanDatabase::rdns_index.emplace(index_key(entry->rdns), index);
+		if (entry->is_rdns_ban())
+			RenX::BanDatabase::rdns_bans.push_back(index);
+	}
+
+	if (entry->name.isNotEmpty())
+		RenX::BanDatabase::name_index.emplace(index_key_lower(entry->name), index);
+
+	if (entry->banner.isNotEmpty())
+		RenX::BanDatabase::banner_index.emplace(index_key_lower(entry->banner), index);
+
+	if (entry->is_active())
+		RenX::BanDatabase::active_entries.insert(index);
+
+	++RenX::BanDatabase::generation;
+}
+
+void RenX::BanDatabase::find_ip(uint32_t ip, std::vector<size_t> &out) const
+{
+	// One probe per prefix length actually in use
+	for (uint8_t prefix_length = 0; prefix_length <= 32; ++prefix_length)
+		if (RenX::BanDatabase::ip_prefix_counts[prefix_length] != 0)
+			append_matches(RenX::BanDatabase::ip_index, ip_index_key(ip, prefix_length), out);
+}
+
+RenX::BanDatabase::QueryCursor RenX::BanDatabase::query(const QueryFilter &filter, size_t offset, size_t limit) const
+{
+	QueryCursor cursor;
+	cursor.next_offset = offset;
+	return RenX::BanDatabase::query(filter, cursor, limit);
+}
+
+RenX::BanDatabase::QueryCursor RenX::BanDatabase::query(const QueryFilter &filter, const QueryCursor &cursor, size_t limit) const
+{
+	QueryCursor result;
+	size_t offset = cursor.next_offset;
+	result.generation = RenX::BanDatabase::generation;
+
+	if (filter.type == QueryFilter::Type::All)
+	{
+		// Already in order; page directly instead of materializing every index
+		result.total = RenX::BanDatabase::entries.size();
+		if (offset < result.total)
+		{
+			size_t end = limit == 0 || result.total - offset < limit ? result.total : offset + limit;
+			result.indexes.reserve(end - offset);
+			for (size_t index = offset; index != end; ++index)
+				result.indexes.push_back(index);
+			result.next_offset = end;
+		}
+		else
+			result.next_offset = result.total;
+		return result;
+	}
+
+	// Matches are collected once, and carried from page to page while the database is unchanged
+	if (cursor.matches != nullptr && cursor.generation == RenX::BanDatabase::generation)
+		result.matches = cursor.matches;
+	else
+	{
+		std::shared_ptr<std::vector<size_t>> matches = std::make_shared<std::vector<size_t>>();
+		RenX::BanDatabase::find_matches(filter, *matches);
+		result.matches = matches;
+	}
+
+	result.total = result.matches->size();
+	if (offset >= result.total)
+	{
+		result.next_offset = result.total;
+		return result;
+	}
+
+	size_t end = limit == 0 || result.total - offset < limit ? result.total : offset + limit;
+	result.indexes.assign(result.matches->begin() + offset, result.matches->begin() + end);
+	result.next_offset = end;
+	return result;
+}
+
+void RenX::BanDatabase::find_matches(const QueryFilter &filter, std::vector<size_t> &out) const
+{
+	switch (filter.type)
+	{
+	case QueryFilter::Type::Any:
+		if (filter.ip != 0)
+			RenX::BanDatabase::find_ip(filter.ip, out);
+		if (filter.steamid != 0)
+			append_matches(RenX::BanDatabase::steam_index, filter.steamid, out);
+		if (filter.text.isNotEmpty())
+		{
+			std::string key = index_key(filter.text);
+			append_matches(RenX::BanDatabase::hwid_index, key, out);
+			append_matches(RenX::BanDatabase::rdns_index, key, out);
+			append_matches(RenX::BanDatabase::name_index, index_key_lower(filter.text), out);
+		}
+		break;
+
+	case QueryFilter::Type::All:
+		out.reserve(RenX::BanDatabase::entries.size());
+		for (size_t index = 0; index != RenX::BanDatabase::entries.size(); ++index)
+			out.push_back(index);
+		return;
+
+	case QueryFilter::Type::IP:
+		RenX::BanDatabase::find_ip(filter.ip, out);
+		break;
+
+	case QueryFilter::Type::HWID:
+		append_matches(RenX::BanDatabase::hwid_index, index_key(filter.text), out);
+		break;
+
+	case QueryFilter::Type::RDNS:
+		append_matches(RenX::BanDatabase::rdns_index, index_key(filter.text), out);
+		break;
+
+	case QueryFilter::Type::Steam:
+		append_matches(RenX::BanDatabase::steam_index, filter.steamid, out);
+		break;
+
+	case QueryFilter::Type::Name:
+		append_matches(RenX::BanDatabase::name_index, index_key_lower(filter.text), out);
+		break;
+
+	case QueryFilter::Type::Banner:
+		append_matches(RenX::BanDatabase::banner_index, index_key_lower(filter.text), out);
+		break;
+
+	case QueryFilter::Type::Active:
+	{
+		// Expired bans stay flagged active until a player they apply to joins, so they're judged by their expiry here
+		std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+		if (filter.active)
+		{
+			out.reserve(RenX::BanDatabase::active_entries.size());
+			for (size_t index : RenX::BanDatabase::active_entries)
+				if (RenX::BanDatabase::entries.get(index)->is_expired(now) == false)
+					out.push_back(index);
+		}
+		else
+		{
+			out.reserve(RenX::BanDatabase::entries.size() - RenX::BanDatabase::active_entries.size());
+			for (size_t index = 0; index != RenX::BanDatabase::entries.size(); ++index)
+				if (RenX::BanDatabase::active_entries.find(index) == RenX::BanDatabase::active_entries.end() || RenX::BanDatabase::entries.get(index)->is_expired(now))
+					out.push_back(index);
+		}
+		return; // Already in order
+	}
+	}
+
+	std::sort(out.begin(), out.end());
+	out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+void RenX::BanDatabase::getCandidates(const RenX::PlayerInfo &player, std::vector<size_t> &out) const
+{
+	out.clear();
+
+	if (player.steamid != 0)
+		append_matches(RenX::BanDatabase::steam_index, player.steamid, out);
+
+	RenX::BanDatabase::find_ip(player.ip32, out);
+
+	if (player.hwid.isNotEmpty())
+		append_matches(RenX::BanDatabase::hwid_index, index_key(player.hwid), out);
+
+	if (player.name.isNotEmpty())
+		append_matches(RenX::BanDatabase::name_index, index_key_lower(player.name), out);
+
+	// RDNS bans are patterns, and can't be looked up directly
+	out.insert(out.end(), RenX::BanDatabase::rdns_bans.begin(), RenX::BanDatabase::rdns_bans.end());
+
+	std::sort(out.begin(), out.end());
+	out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+uint64_t RenX::BanDatabase::getGeneration() const
+{
+	return RenX::BanDatabase::generation;
+}
+
 uint8_t RenX::BanDatabase::getVersion() const
 {
 	return RenX::BanDatabase::write_version;
@@ -250,13 +750,39 @@ const Jupiter::ArrayList<RenX::BanDatabase::Entry> &RenX::BanDatabase::getEntrie
 	return RenX::BanDatabase::entries;
 }
 
+bool RenX::BanDatabase::load(const std::string &in_filename)
+{
+	RenX::BanDatabase::filename = in_filename;
+	return RenX::BanDatabase::load_file();
+}
+
 bool RenX::BanDatabase::initialize()
 {
 	RenX::BanDatabase::filename = static_cast<std::string>(RenX::getCore()->getConfig().get("BanDB"_jrs, "Bans.db"_jrs));
-	return this->process_file(filename);
+	RenX::BanDatabase::shared = RenX::getCore()->getConfig().get<bool>("SharedBanDB"_jrs, false);
+	bool result = RenX::BanDatabase::load_file();
+
+#if defined __linux__
+	if (RenX::BanDatabase::shared && RenX::BanDatabase::inotify_fd < 0)
+	{
+		RenX::BanDatabase::inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (RenX::BanDatabase::inotify_fd >= 0 && inotify_add_watch(RenX::BanDatabase::inotify_fd, RenX::BanDatabase::filename.c_str(), IN_MODIFY) < 0)
+		{
+			close(RenX::BanDatabase::inotify_fd);
+			RenX::BanDatabase::inotify_fd = -1;
+		}
+	}
+#endif // __linux__
+
+	return result;
 }
 
 RenX::BanDatabase::~BanDatabase()
 {
+#if defined __linux__
+	if (RenX::BanDatabase::inotify_fd >= 0)
+		close(RenX::BanDatabase::inotify_fd);
+#endif // __linux__
+
 	RenX::BanDatabase::entries.emptyAndDelete();
 }
\ No newline at end of file
@@ -20,6 +20,11 @@
 #define _RENX_BANDATABASE_H_HEADER
 
 #include <cstdint>
+#include <chrono>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
 #include <unordered_map>
 #include "Jupiter/Database.h"
 #include "Jupiter/String.hpp"
@@ -114,6 +119,7 @@ namespace RenX
 			inline bool is_type_mine() { return (flags & FLAG_TYPE_MINE) != 0; };
 			inline bool is_type_ladder() { return (flags & FLAG_TYPE_LADDER) != 0; };
 			inline bool is_type_alert() { return (flags & FLAG_TYPE_ALERT) != 0; };
+			inline bool is_expired(std::chrono::system_clock::time_point now) { return length != std::chrono::seconds::zero() && timestamp + length < now; };
 
 			inline void set_active() { flags |= FLAG_ACTIVE; };
 			inline void set_rdns_ban() { flags |= FLAG_USE_RDNS; }
@@ -138,6 +144,94 @@ namespace RenX
 			inline void unset_type_global() { flags = 0x0000U; };
 		};
 
+		/**
+		* @brief Caches the outcome of a ban check for a single player identity.
+		* The cached verdict is reused for as long as the identity, the server's
+		* ban settings, and the database generation are unchanged.
+		*/
+		struct RENX_API CheckCache
+		{
+			uint64_t generation = 0; /** Generation the verdict was computed against; 0 if never computed */
+			uint64_t steamid = 0;
+			uint32_t ip = 0;
+			Jupiter::StringS hwid;
+			Jupiter::StringS rdns;
+			Jupiter::StringS name;
+			uint8_t check_types = 0; /** Server ban settings in effect, and whether RDNS was available */
+			uint16_t flags = 0; /** Combined flags of every matching entry */
+			Entry *last_to_expire[7]; /** Matching entries which expire last, by type */
+			std::chrono::system_clock::time_point valid_until; /** Earliest expiration of any matching entry */
+		};
+
+		/**
+		* @brief Describes which entries a query should match.
+		*/
+		struct RENX_API QueryFilter
+		{
+			enum class Type : uint8_t
+			{
+				Any, /** Matches IP, HWID, RDNS, SteamID, or name */
+				All,
+				IP, /** Matches any entry whose address block contains 'ip' */
+				HWID,
+				RDNS,
+				Steam,
+				Name, /** Case-insensitive */
+				Banner, /** Case-insensitive */
+				Active
+			};
+
+			Type type = Type::All;
+			uint64_t steamid = 0;
+			uint32_t ip = 0;
+			bool active = true;
+			Jupiter::StringS text; /** HWID, RDNS, name, or banner to match */
+		};
+
+		/**
+		* @brief Represents a single page of query results.
+		*/
+		struct RENX_API QueryCursor
+		{
+			std::vector<size_t> indexes; /** Indexes (ban IDs) of the entries on this page, in ascending order */
+			size_t total = 0; /** Total number of entries matching the filter */
+			size_t next_offset = 0; /** Offset of the following page */
+			std::shared_ptr<const std::vector<size_t>> matches; /** Every matching index, in ascending order; reused for following pages */
+			uint64_t generation = 0; /** Database generation that matches were collected against */
+
+			inline bool has_next() const { return next_offset < total; };
+		};
+
+		/**
+		* @brief Searches the database using the same indexes as ban checking.
+		*
+		* @param filter Filter describing the entries to match
+		* @param offset Number of matching entries to skip
+		* @param limit Maximum number of entries to return; 0 for no limit
+		* @return Cursor containing the requested page of results.
+		*/
+		QueryCursor query(const QueryFilter &filter, size_t offset, size_t limit) const;
+
+		/**
+		* @brief Fetches the page of results following a cursor.
+		* The cursor's matches are reused rather than searched for again, unless the database has changed since.
+		*
+		* @param filter Filter the cursor was returned for
+		* @param cursor Cursor of the previous page
+		* @param limit Maximum number of entries to return; 0 for no limit
+		* @return Cursor containing the requested page of results.
+		*/
+		QueryCursor query(const QueryFilter &filter, const QueryCursor &cursor, size_t limit) const;
+
+		/**
+		* @brief Fetches the indexes of every entry which could apply to a player.
+		* Note: Candidates still need to be checked for activity, expiry, and type.
+		*
+		* @param player Player to fetch candidates for
+		* @param out Vector to store candidate indexes in; duplicates are removed
+		*/
+		void getCandidates(const RenX::PlayerInfo &player, std::vector<size_t> &out) const;
+
 		/**
 		* @brief Adds a ban entry for a player and immediately writes it to the database.
 		*
@@ -161,6 +255,23 @@ namespace RenX
 		*/
 		void add(const Jupiter::ReadableString &name, uint32_t ip, uint8_t prefix_length, uint64_t steamid, const Jupiter::ReadableString &hwid, const Jupiter::ReadableString &rdns, const Jupiter::ReadableString &banner, Jupiter::ReadableString &reason, std::chrono::seconds length, uint16_t flags = RenX::BanDatabase::Entry::FLAG_TYPE_GAME);
 
+		/**
+		* @brief Adds a batch of entries, and writes them to the database with a single lock and sync.
+		* Entries which duplicate an existing entry are skipped and deleted. The batch is emptied.
+		*
+		* @param batch Entries to add; ownership of each entry is transferred to the database
+		* @return Number of entries added.
+		*/
+		size_t add_entries(std::vector<Entry *> &batch);
+
+		/**
+		* @brief Searches for an entry with the same identity, timestamp, and length as another entry.
+		*
+		* @param entry Entry to search for
+		* @return Index of a duplicate entry if one exists, Jupiter::INVALID_INDEX otherwise.
+		*/
+		size_t find_duplicate(const Entry &entry) const;
+
 		/**
 		* @brief Upgrades the ban database to the current write_version.
 		*/
@@ -182,13 +293,41 @@ namespace RenX
 		void write(Entry *entry, FILE *file);
 
 		/**
-		* @brief Deactivates a ban entry.
+		* @brief Deactivates a ban entry, and appends a deactivation record to the database.
 		*
 		* @param index Index of the entry to deactivate.
 		* @param True if the entry was active and is now inactive, false otherwise.
 		*/
 		bool deactivate(size_t index);
 
+		/**
+		* @brief Reads and applies any records appended to the database file since it was last read (i.e: by other processes).
+		*
+		* @return Number of records applied.
+		*/
+		size_t tail();
+
+		/**
+		* @brief Checks the database file for changes made by other processes, when the database is shared.
+		*
+		* @return True if any new records were applied, false otherwise.
+		*/
+		bool think();
+
+		/**
+		* @brief Checks if the database file is shared with other processes.
+		*
+		* @return True if the database is shared, false otherwise.
+		*/
+		bool isShared() const;
+
+		/**
+		* @brief Fetches the generation of the database, which is incremented whenever an entry is added or deactivated.
+		*
+		* @return Database generation
+		*/
+		uint64_t getGeneration() const;
+
 		/**
 		* @brief Fetches the version of the database file.
 		*
@@ -210,17 +349,50 @@ namespace RenX
 		*/
 		const Jupiter::ArrayList<RenX::BanDatabase::Entry> &getEntries() const;
 
+		/**
+		* @brief Loads a database file, creating it if it does not exist. This is intended for standalone
+		* databases (i.e: benchmarks and tools); the global ban database is loaded by initialize().
+		*
+		* @param in_filename Name of the database file to load
+		* @return True if the file was processed successfully, false otherwise.
+		*/
+		bool load(const std::string &in_filename);
+
 		virtual bool initialize();
 		~BanDatabase();
 
 	private:
+		void commit(Entry *entry);
+		bool apply_deactivation(size_t index);
+		size_t read_records(FILE *file);
+		void rewrite(FILE *file);
+		bool load_file();
+		void index_entry(size_t index);
+		void find_ip(uint32_t ip, std::vector<size_t> &out) const;
+		void find_matches(const QueryFilter &filter, std::vector<size_t> &out) const;
+
 		/** Database version */
-		const uint8_t write_version = 5U;
+		const uint8_t write_version = 6U;
 		uint8_t read_version = write_version;
 		fpos_t eof;
+		uint64_t generation = 1;
+		bool shared = false;
+		int inotify_fd = -1;
+		std::chrono::steady_clock::time_point next_poll;
 
 		std::string filename;
 		Jupiter::ArrayList<RenX::BanDatabase::Entry> entries;
+
+		/** Indexes; values are indexes into 'entries' */
+		std::unordered_multimap<uint64_t, size_t> steam_index;
+		std::unordered_multimap<uint64_t, size_t> ip_index; /** Keyed by (prefix_length << 32) | masked address */
+		size_t ip_prefix_counts[33] = { 0 };
+		std::unordered_multimap<std::string, size_t> hwid_index;
+		std::unordered_multimap<std::string, size_t> rdns_index;
+		std::unordered_multimap<std::string, size_t> name_index; /** Lower-case names */
+		std::unordered_multimap<std::string, size_t> banner_index; /** Lower-case banners */
+		std::vector<size_t> rdns_bans;
+		std::set<size_t> active_entries;
 	};
 
 	RENX_API extern RenX::BanDatabase *banDatabase;
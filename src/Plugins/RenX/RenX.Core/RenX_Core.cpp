@@ -181,6 +181,10 @@ void RenX::Core::banCheck()
 
 int RenX::Core::think()
 {
+	// Apply bans added or removed by other processes sharing the ban database
+	if (RenX::banDatabase->think())
+		RenX::Core::banCheck();
+
 	size_t index = 0;
 	while (index < RenX::Core::servers.size())
 		if (RenX::Core::servers.get(index)->think() != 0)
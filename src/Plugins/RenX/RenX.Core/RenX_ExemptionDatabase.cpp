@@ -17,10 +17,13 @@
 */
 
 #include <cstdio>
+#include <cstring>
+#include <string>
 #include "Jupiter/IRC_Client.h"
 #include "RenX_PlayerInfo.h"
 #include "RenX_ExemptionDatabase.h"
 #include "RenX_Core.h"
+#include "RenX_Functions.h"
 #include "RenX_Plugin.h"
 
 using namespace Jupiter::literals;
@@ -44,6 +47,8 @@ void RenX::ExemptionDatabase::process_data(Jupiter::DataBuffer &buffer, FILE *fi
 	entry->setter = buffer.pop<Jupiter::String_Strict, char>();
 
 	RenX::ExemptionDatabase::entries.add(entry);
+	RenX::ExemptionDatabase::index_entry(RenX::ExemptionDatabase::entries.size() - 1);
+	++RenX::ExemptionDatabase::generation;
 }
 
 void RenX::ExemptionDatabase::process_header(FILE *file)
@@ -69,7 +74,7 @@ void RenX::ExemptionDatabase::upgrade_database()
 	if (file != nullptr)
 	{
 		this->create_header(file);
-		for (size_t index = 0; RenX::ExemptionDatabase::entries.size(); ++index)
+		for (size_t index = 0; index != RenX::ExemptionDatabase::entries.size(); ++index)
 			RenX::ExemptionDatabase::write(RenX::ExemptionDatabase::entries.get(index), file);
 
 		fclose(file);
@@ -79,10 +84,12 @@ void RenX::ExemptionDatabase::upgrade_database()
 void RenX::ExemptionDatabase::write(RenX::ExemptionDatabase::Entry *entry)
 {
 	FILE *file = fopen(filename.c_str(), "r+b");
-	fsetpos(file, std::addressof(RenX::ExemptionDatabase::eof));
 	if (file != nullptr)
 	{
+		RenX::lockFile(file, true);
+		fseek(file, 0, SEEK_END);
 		RenX::ExemptionDatabase::write(entry, file);
+		RenX::unlockFile(file);
 		fclose(file);
 	}
 }
@@ -124,21 +131,93 @@ void RenX::ExemptionDatabase::add(uint32_t ip, uint8_t prefix_length, uint64_t s
 	entry->setter = setter;
 
 	entries.add(entry);
+	RenX::ExemptionDatabase::index_entry(RenX::ExemptionDatabase::entries.size() - 1);
+	++RenX::ExemptionDatabase::generation;
 	RenX::ExemptionDatabase::write(entry);
 }
 
+static std::string duplicate_key(const RenX::ExemptionDatabase::Entry &entry)
+{
+	std::string result(sizeof(int64_t) * 2 + sizeof(entry.steamid) + sizeof(entry.ip) + sizeof(entry.prefix_length), '\0');
+	int64_t timestamp = std::chrono::duration_cast<std::chrono::seconds>(entry.timestamp.time_since_epoch()).count();
+	int64_t length = entry.length.count();
+	char *ptr = &result[0];
+	memcpy(ptr, &timestamp, sizeof(timestamp));
+	memcpy(ptr += sizeof(timestamp), &length, sizeof(length));
+	memcpy(ptr += sizeof(length), &entry.steamid, sizeof(entry.steamid));
+	memcpy(ptr += sizeof(entry.steamid), &entry.ip, sizeof(entry.ip));
+	memcpy(ptr += sizeof(entry.ip), &entry.prefix_length, sizeof(entry.prefix_length));
+	return result;
+}
+
+size_t RenX::ExemptionDatabase::add_entries(std::vector<RenX::ExemptionDatabase::Entry *> &batch)
+{
+	size_t result = 0;
+	FILE *file = fopen(RenX::ExemptionDatabase::filename.c_str(), "r+b");
+	if (file != nullptr)
+	{
+		RenX::lockFile(file, true);
+		fseek(file, 0, SEEK_END);
+	}
+
+	for (RenX::ExemptionDatabase::Entry *entry : batch)
+	{
+		if (RenX::ExemptionDatabase::find_duplicate(*entry) != Jupiter::INVALID_INDEX)
+		{
+			delete entry;
+			continue;
+		}
+
+		RenX::ExemptionDatabase::entries.add(entry);
+		RenX::ExemptionDatabase::index_entry(RenX::ExemptionDatabase::entries.size() - 1);
+		if (file != nullptr)
+			RenX::ExemptionDatabase::write(entry, file);
+		++result;
+	}
+	batch.clear();
+
+	if (file != nullptr)
+	{
+		RenX::unlockFile(file);
+		fclose(file);
+	}
+
+	if (result != 0)
+		++RenX::ExemptionDatabase::generation;
+
+	return result;
+}
+
+size_t RenX::ExemptionDatabase::find_duplicate(const RenX::ExemptionDatabase::Entry &entry) const
+{
+	auto node = RenX::ExemptionDatabase::duplicate_index.find(duplicate_key(entry));
+	if (node == RenX::ExemptionDatabase::duplicate_index.end())
+		return Jupiter::INVALID_INDEX;
+
+	return node->second;
+}
+
+void RenX::ExemptionDatabase::index_entry(size_t index)
+{
+	// flags aren't part of the key, so deactivating an entry leaves it indexed
+	RenX::ExemptionDatabase::duplicate_index.emplace(duplicate_key(*RenX::ExemptionDatabase::entries.get(index)), index);
+}
+
 bool RenX::ExemptionDatabase::deactivate(size_t index)
 {
 	RenX::ExemptionDatabase::Entry *entry = RenX::ExemptionDatabase::entries.get(index);
 	if (entry->is_active())
 	{
 		entry->unset_active();
+		++RenX::ExemptionDatabase::generation;
 		FILE *file = fopen(RenX::ExemptionDatabase::filename.c_str(), "r+b");
 		if (file != nullptr)
 		{
+			RenX::lockFile(file, true);
 			fsetpos(file, &entry->pos);
 			fseek(file, sizeof(size_t), SEEK_CUR);
 			fwrite(std::addressof(entry->flags), sizeof(entry->flags), 1, file);
+			RenX::unlockFile(file);
 			fclose(file);
 		}
 		return true;
@@ -148,25 +227,54 @@ bool RenX::ExemptionDatabase::deactivate(size_t index)
 
 void RenX::ExemptionDatabase::exemption_check(RenX::PlayerInfo &player)
 {
+	RenX::ExemptionDatabase::CheckCache &cache = player.exemption_check_cache;
+	std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+	if (cache.generation == RenX::ExemptionDatabase::generation && now < cache.valid_until && cache.steamid == player.steamid && cache.ip == player.ip32)
+	{
+		player.exemption_flags |= cache.flags;
+		return;
+	}
+
 	RenX::ExemptionDatabase::Entry *entry;
 	uint32_t netmask;
+	uint8_t flags = 0;
+	std::chrono::system_clock::time_point valid_until = std::chrono::system_clock::time_point::max();
 	size_t index = RenX::ExemptionDatabase::entries.size();
 	while (index != 0)
 	{
 		entry = RenX::ExemptionDatabase::entries.get(--index);
 		if (entry->is_active())
 		{
-			if (entry->length == std::chrono::seconds::zero() || entry->timestamp + entry->length < std::chrono::system_clock::now())
+			if (entry->length == std::chrono::seconds::zero() || now < entry->timestamp + entry->length)
 			{
 				netmask = Jupiter_prefix_length_to_netmask(entry->prefix_length);
 				if ((player.steamid != 0 && entry->steamid == player.steamid) // SteamID exemption
 					|| (player.ip32 != 0U && (player.ip32 & netmask) == (entry->ip & netmask))) // IP address exemption
-					player.exemption_flags |= entry->flags;
+				{
+					flags |= entry->flags;
+
+					// the verdict changes once this exemption expires
+					if (entry->length != std::chrono::seconds::zero() && entry->timestamp + entry->length < valid_until)
+						valid_until = entry->timestamp + entry->length;
+				}
 			}
 			else
 				RenX::ExemptionDatabase::deactivate(index);
 		}
 	}
+
+	// Entries deactivated above are reflected in the current generation
+	cache.generation = RenX::ExemptionDatabase::generation;
+	cache.steamid = player.steamid;
+	cache.ip = player.ip32;
+	cache.flags = flags;
+	cache.valid_until = valid_until;
+	player.exemption_flags |= flags;
+}
+
+uint64_t RenX::ExemptionDatabase::getGeneration() const
+{
+	return RenX::ExemptionDatabase::generation;
 }
 
 uint8_t RenX::ExemptionDatabase::getVersion() const
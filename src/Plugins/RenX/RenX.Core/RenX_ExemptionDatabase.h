@@ -21,6 +21,9 @@
 
 #include <cstdint>
 #include <chrono>
+#include <string>
+#include <vector>
+#include <unordered_map>
 #include "Jupiter/Database.h"
 #include "Jupiter/String.hpp"
 #include "Jupiter/ArrayList.h"
@@ -105,6 +108,19 @@ namespace RenX
 			inline void unset_type_ban() { flags &= ~FLAG_TYPE_BAN; };
 		};
 
+		/**
+		* @brief Caches the outcome of an exemption check for a single player identity.
+		* The cached flags are reused until the identity or the database generation changes, or a matching entry expires.
+		*/
+		struct RENX_API CheckCache
+		{
+			uint64_t generation = 0; /** Generation the flags were computed against; 0 if never computed */
+			uint64_t steamid = 0;
+			uint32_t ip = 0;
+			uint8_t flags = 0; /** Combined flags of every matching entry */
+			std::chrono::system_clock::time_point valid_until; /** Earliest expiration of any matching entry */
+		};
+
 		/**
 		* @brief Adds an exemption entry for a player and immediately writes it to the database.
 		*
@@ -125,6 +141,23 @@ namespace RenX
 		*/
 		void add(uint32_t ip, uint8_t prefix_length, uint64_t steamid, const Jupiter::ReadableString &setter, std::chrono::seconds length, uint8_t flags);
 
+		/**
+		* @brief Adds a batch of entries, and writes them to the database with a single sync.
+		* Entries which duplicate an existing entry are skipped and deleted. The batch is emptied.
+		*
+		* @param batch Entries to add; ownership of each entry is transferred to the database
+		* @return Number of entries added.
+		*/
+		size_t add_entries(std::vector<Entry *> &batch);
+
+		/**
+		* @brief Searches for an entry with the same identity, timestamp, and length as another entry.
+		*
+		* @param entry Entry to search for
+		* @return Index of a duplicate entry if one exists, Jupiter::INVALID_INDEX otherwise.
+		*/
+		size_t find_duplicate(const Entry &entry) const;
+
 		/**
 		* @brief Upgrades the exemption database to the current write_version.
 		*/
@@ -160,6 +193,13 @@ namespace RenX
 		*/
 		void exemption_check(RenX::PlayerInfo &player);
 
+		/**
+		* @brief Fetches the generation of the database, which is incremented whenever an entry is added or deactivated.
+		*
+		* @return Database generation
+		*/
+		uint64_t getGeneration() const;
+
 		/**
 		* @brief Fetches the version of the database file.
 		*
@@ -185,13 +225,17 @@ namespace RenX
 		~ExemptionDatabase();
 
 	private:
+		void index_entry(size_t index);
+
 		/** Database version */
 		const uint8_t write_version = 0U;
 		uint8_t read_version = write_version;
 		fpos_t eof;
+		uint64_t generation = 1;
 
 		std::string filename;
 		Jupiter::ArrayList<RenX::ExemptionDatabase::Entry> entries;
+		std::unordered_map<std::string, size_t> duplicate_index; /** Entries by identity, timestamp, and length */
 	};
 
 	RENX_API extern RenX::ExemptionDatabase *exemptionDatabase;
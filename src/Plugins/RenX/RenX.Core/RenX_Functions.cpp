@@ -17,6 +17,14 @@
  */
 
 #include <ctime>
+#include <cerrno>
+#include <cstring>
+#if defined _WIN32
+#include <io.h>
+#include <Windows.h>
+#else // _WIN32
+#include <sys/file.h>
+#endif // _WIN32
 #include "Jupiter/Functions.h"
 #include "IRC_Bot.h"
 #include "ServerManager.h"
@@ -979,3 +987,38 @@ Jupiter::String RenX::escapifyRCON(const Jupiter::ReadableString &str)
 	}
 	return result;
 }
+
+bool RenX::lockFile(FILE *file, bool exclusive)
+{
+#if defined _WIN32
+	OVERLAPPED overlapped = { 0 };
+	if (LockFileEx(reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file))), exclusive ? LOCKFILE_EXCLUSIVE_LOCK : 0, 0, MAXDWORD, MAXDWORD, &overlapped) == FALSE)
+	{
+		fprintf(stderr, "[RenX] ERROR: Failed to lock database file. Error code: %lu" ENDL, static_cast<unsigned long>(GetLastError()));
+		return false;
+	}
+#else // _WIN32
+	int result;
+	do
+		result = flock(fileno(file), exclusive ? LOCK_EX : LOCK_SH);
+	while (result != 0 && errno == EINTR);
+
+	if (result != 0)
+	{
+		fprintf(stderr, "[RenX] ERROR: Failed to lock database file: %s" ENDL, strerror(errno));
+		return false;
+	}
+#endif // _WIN32
+	return true;
+}
+
+void RenX::unlockFile(FILE *file)
+{
+	fflush(file);
+#if defined _WIN32
+	OVERLAPPED overlapped = { 0 };
+	UnlockFileEx(reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file))), 0, MAXDWORD, MAXDWORD, &overlapped);
+#else // _WIN32
+	flock(fileno(file), LOCK_UN);
+#endif // _WIN32
+}
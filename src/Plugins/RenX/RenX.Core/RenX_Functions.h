@@ -25,6 +25,7 @@
  */
 
 #include <chrono>
+#include <cstdio>
 #include "Jupiter/Config.h"
 #include "Jupiter/String.hpp"
 #include "RenX.h"
@@ -189,6 +190,23 @@ namespace RenX
 	*/
 	RENX_API Jupiter::String escapifyRCON(const Jupiter::ReadableString &str);
 
+	/**
+	* @brief Takes an advisory lock on an open file, waiting until it is available. Failures are reported to stderr.
+	* Used to share database files between multiple processes.
+	*
+	* @param file File to lock
+	* @param exclusive True to lock for writing, false to lock for reading
+	* @return True if the lock was taken, false otherwise.
+	*/
+	RENX_API bool lockFile(FILE *file, bool exclusive);
+
+	/**
+	* @brief Flushes a file and releases a lock taken by lockFile().
+	*
+	* @param file File to unlock
+	*/
+	RENX_API void unlockFile(FILE *file);
+
 	/** Constant variables */
 	RENX_API extern const char DelimC; /** RCON message deliminator */
 	RENX_API extern const char DelimC3; /** RCON message deliminator for RCON version number 003 */
@@ -16,17 +16,603 @@
  * Written by Jessica James <jessica.aj@outlook.com>
  */
 
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <unordered_set>
+#if defined _WIN32
+#include <Windows.h>
+#else // _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
 #include "RenX_LadderDatabase.h"
+#include "RenX_Core.h"
 #include "RenX_Server.h"
 #include "RenX_PlayerInfo.h"
 #include "RenX_BanDatabase.h"
 
+using namespace Jupiter::literals;
+
+/**
+ * Columnar database files (version 2 and later) are laid out as:
+ *	header: version (1 byte), padding (7 bytes), entry count (8 bytes), name blob size (8 bytes), and since
+ *		version 3, the ID of the last match in the match log which the file includes (8 bytes)
+ *	one column per field below, each holding every entry's value in rank order
+ *	last_game column (8 bytes per entry), name end offset column (8 bytes per entry)
+ *	name blob: every entry's most_recent_name, concatenated in rank order
+ */
+static const size_t column_header_size = 24;
+static const size_t column_header_size_v3 = 32;
+
+static uint64_t RenX::LadderDatabase::Entry::* const wide_columns[] =
+{
+	&RenX::LadderDatabase::Entry::steam_id, &RenX::LadderDatabase::Entry::total_score, &RenX::LadderDatabase::Entry::total_gdi_score, &RenX::LadderDatabase::Entry::total_nod_score
+};
+
+static uint32_t RenX::LadderDatabase::Entry::* const narrow_columns[] =
+{
+	&RenX::LadderDatabase::Entry::total_kills, &RenX::LadderDatabase::Entry::total_deaths, &RenX::LadderDatabase::Entry::total_headshot_kills, &RenX::LadderDatabase::Entry::total_vehicle_kills,
+	&RenX::LadderDatabase::Entry::total_building_kills, &RenX::LadderDatabase::Entry::total_defence_kills, &RenX::LadderDatabase::Entry::total_captures, &RenX::LadderDatabase::Entry::total_game_time,
+	&RenX::LadderDatabase::Entry::total_games, &RenX::LadderDatabase::Entry::total_wins, &RenX::LadderDatabase::Entry::total_beacon_placements, &RenX::LadderDatabase::Entry::total_beacon_disarms,
+	&RenX::LadderDatabase::Entry::total_proxy_placements, &RenX::LadderDatabase::Entry::total_proxy_disarms,
+
+	&RenX::LadderDatabase::Entry::total_gdi_games, &RenX::LadderDatabase::Entry::total_gdi_wins, &RenX::LadderDatabase::Entry::total_gdi_ties, &RenX::LadderDatabase::Entry::total_gdi_game_time,
+	&RenX::LadderDatabase::Entry::total_gdi_beacon_placements, &RenX::LadderDatabase::Entry::total_gdi_beacon_disarms, &RenX::LadderDatabase::Entry::total_gdi_proxy_placements, &RenX::LadderDatabase::Entry::total_gdi_proxy_disarms,
+	&RenX::LadderDatabase::Entry::total_gdi_kills, &RenX::LadderDatabase::Entry::total_gdi_deaths, &RenX::LadderDatabase::Entry::total_gdi_vehicle_kills, &RenX::LadderDatabase::Entry::total_gdi_defence_kills,
+	&RenX::LadderDatabase::Entry::total_gdi_building_kills, &RenX::LadderDatabase::Entry::total_gdi_headshots,
+
+	&RenX::LadderDatabase::Entry::total_nod_games, &RenX::LadderDatabase::Entry::total_nod_wins, &RenX::LadderDatabase::Entry::total_nod_ties, &RenX::LadderDatabase::Entry::total_nod_game_time,
+	&RenX::LadderDatabase::Entry::total_nod_beacon_placements, &RenX::LadderDatabase::Entry::total_nod_beacon_disarms, &RenX::LadderDatabase::Entry::total_nod_proxy_placements, &RenX::LadderDatabase::Entry::total_nod_proxy_disarms,
+	&RenX::LadderDatabase::Entry::total_nod_kills, &RenX::LadderDatabase::Entry::total_nod_deaths, &RenX::LadderDatabase::Entry::total_nod_vehicle_kills, &RenX::LadderDatabase::Entry::total_nod_defence_kills,
+	&RenX::LadderDatabase::Entry::total_nod_building_kills, &RenX::LadderDatabase::Entry::total_nod_headshots,
+
+	&RenX::LadderDatabase::Entry::top_score, &RenX::LadderDatabase::Entry::top_kills, &RenX::LadderDatabase::Entry::most_deaths, &RenX::LadderDatabase::Entry::top_headshot_kills,
+	&RenX::LadderDatabase::Entry::top_vehicle_kills, &RenX::LadderDatabase::Entry::top_building_kills, &RenX::LadderDatabase::Entry::top_defence_kills, &RenX::LadderDatabase::Entry::top_captures,
+	&RenX::LadderDatabase::Entry::top_game_time, &RenX::LadderDatabase::Entry::top_beacon_placements, &RenX::LadderDatabase::Entry::top_beacon_disarms, &RenX::LadderDatabase::Entry::top_proxy_placements,
+	&RenX::LadderDatabase::Entry::top_proxy_disarms,
+
+	&RenX::LadderDatabase::Entry::most_recent_ip
+};
+
+/** Bytes per entry in a columnar database file, excluding its name */
+static const uint64_t column_row_size = sizeof(wide_columns) / sizeof(*wide_columns) * sizeof(uint64_t) + sizeof(narrow_columns) / sizeof(*narrow_columns) * sizeof(uint32_t) + sizeof(int64_t) + sizeof(uint64_t);
+
+/** Read-only view of a file's contents, mapped into memory */
+class MappedFile
+{
+public:
+	MappedFile(const std::string &filename)
+	{
+#if defined _WIN32
+		MappedFile::file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (MappedFile::file == INVALID_HANDLE_VALUE)
+			return;
+
+		LARGE_INTEGER file_size;
+		if (GetFileSizeEx(MappedFile::file, &file_size) == FALSE || file_size.QuadPart == 0)
+			return;
+
+		MappedFile::mapping = CreateFileMappingA(MappedFile::file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (MappedFile::mapping == nullptr)
+			return;
+
+		MappedFile::data = static_cast<const char *>(MapViewOfFile(MappedFile::mapping, FILE_MAP_READ, 0, 0, 0));
+		if (MappedFile::data != nullptr)
+			MappedFile::size = static_cast<size_t>(file_size.QuadPart);
+#else // _WIN32
+		int fd = open(filename.c_str(), O_RDONLY);
+		if (fd < 0)
+			return;
+
+		struct stat info;
+		if (fstat(fd, &info) == 0 && info.st_size > 0)
+		{
+			void *view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			if (view != MAP_FAILED)
+			{
+#if defined MADV_SEQUENTIAL
+				madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+#endif // MADV_SEQUENTIAL
+				MappedFile::data = static_cast<const char *>(view);
+				MappedFile::size = static_cast<size_t>(info.st_size);
+			}
+		}
+
+		// the mapping remains valid after the descriptor is closed
+		close(fd);
+#endif // _WIN32
+	}
+
+	~MappedFile()
+	{
+#if defined _WIN32
+		if (MappedFile::data != nullptr)
+			UnmapViewOfFile(MappedFile::data);
+		if (MappedFile::mapping != nullptr)
+			CloseHandle(MappedFile::mapping);
+		if (MappedFile::file != INVALID_HANDLE_VALUE)
+			CloseHandle(MappedFile::file);
+#else // _WIN32
+		if (MappedFile::data != nullptr)
+			munmap(const_cast<char *>(MappedFile::data), MappedFile::size);
+#endif // _WIN32
+	}
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	const char *data = nullptr;
+	size_t size = 0;
+
+private:
+#if defined _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#endif // _WIN32
+};
+
+/** Writes entries to a file in the columnar format */
+static bool write_columns(FILE *file, const std::vector<const RenX::LadderDatabase::Entry *> &entries, uint8_t version, uint64_t match_id)
+{
+	uint64_t count = entries.size();
+	uint64_t names_size = 0;
+	for (const RenX::LadderDatabase::Entry *entry : entries)
+		names_size += entry->most_recent_name.size();
+
+	char header[column_header_size_v3] = { 0 };
+	header[0] = static_cast<char>(version);
+	memcpy(header + 8, &count, sizeof(count));
+	memcpy(header + 16, &names_size, sizeof(names_size));
+	memcpy(header + 24, &match_id, sizeof(match_id));
+	fwrite(header, sizeof(char), sizeof(header), file);
+
+	std::vector<uint64_t> wide;
+	wide.reserve(entries.size());
+	for (uint64_t RenX::LadderDatabase::Entry::* member : wide_columns)
+	{
+		wide.clear();
+		for (const RenX::LadderDatabase::Entry *entry : entries)
+			wide.push_back(entry->*member);
+		fwrite(wide.data(), sizeof(uint64_t), wide.size(), file);
+	}
+
+	std::vector<uint32_t> narrow;
+	narrow.reserve(entries.size());
+	for (uint32_t RenX::LadderDatabase::Entry::* member : narrow_columns)
+	{
+		narrow.clear();
+		for (const RenX::LadderDatabase::Entry *entry : entries)
+			narrow.push_back(entry->*member);
+		fwrite(narrow.data(), sizeof(uint32_t), narrow.size(), file);
+	}
+
+	wide.clear();
+	for (const RenX::LadderDatabase::Entry *entry : entries)
+		wide.push_back(static_cast<uint64_t>(static_cast<int64_t>(entry->last_game)));
+	fwrite(wide.data(), sizeof(uint64_t), wide.size(), file);
+
+	wide.clear();
+	names_size = 0;
+	for (const RenX::LadderDatabase::Entry *entry : entries)
+	{
+		names_size += entry->most_recent_name.size();
+		wide.push_back(names_size);
+	}
+	fwrite(wide.data(), sizeof(uint64_t), wide.size(), file);
+
+	for (const RenX::LadderDatabase::Entry *entry : entries)
+		fwrite(entry->most_recent_name.ptr(), sizeof(char), entry->most_recent_name.size(), file);
+
+	return ferror(file) == 0;
+}
+
+/** Writes a ladder's entries to a new base file */
+static bool write_checkpoint(const std::string &base_filename, const RenX::LadderDatabase::Entry *head, size_t count, uint8_t version, uint64_t match_id)
+{
+	std::string temp_filename = base_filename + ".tmp";
+	FILE *file = fopen(temp_filename.c_str(), "wb");
+	if (file == nullptr)
+		return false;
+
+	std::vector<const RenX::LadderDatabase::Entry *> entries;
+	entries.reserve(count);
+	for (const RenX::LadderDatabase::Entry *entry = head; entry != nullptr; entry = entry->next)
+		entries.push_back(entry);
+
+	bool written = write_columns(file, entries, version, match_id);
+	if (fclose(file) != 0 || written == false)
+	{
+		remove(temp_filename.c_str());
+		return false;
+	}
+
+	if (rename(temp_filename.c_str(), base_filename.c_str()) != 0)
+	{
+		// Some platforms won't replace an existing file
+		remove(base_filename.c_str());
+		if (rename(temp_filename.c_str(), base_filename.c_str()) != 0)
+			return false;
+	}
+
+	return true;
+}
+
+/** Reads each complete record of a log file; a partially written final record is ignored */
+template<typename F>
+static size_t read_log(const std::string &log_filename, F on_record)
+{
+	FILE *file = fopen(log_filename.c_str(), "rb");
+	if (file == nullptr)
+		return 0;
+
+	size_t result = 0;
+	int version = fgetc(file);
+	if (version != EOF)
+	{
+		size_t record_size;
+		fpos_t pos;
+		long file_size, record_end;
+
+		fseek(file, 0, SEEK_END);
+		file_size = ftell(file);
+		fseek(file, 1, SEEK_SET);
+
+		while (fgetpos(file, &pos) == 0 && fread(std::addressof(record_size), sizeof(size_t), 1, file) == 1)
+		{
+			record_end = ftell(file) + static_cast<long>(record_size);
+			if (record_end > file_size)
+				break;
+
+			Jupiter::DataBuffer buffer;
+			buffer.pop_from(file, record_size);
+			on_record(static_cast<uint8_t>(version), buffer, file, pos);
+			fseek(file, record_end, SEEK_SET);
+			++result;
+		}
+	}
+
+	fclose(file);
+	return result;
+}
+
+/** Serializes a match as a match log record */
+static void push_match(Jupiter::DataBuffer &buffer, uint64_t match_id, const RenX::LadderDatabase::MatchRecord &record)
+{
+	buffer.push(match_id);
+	buffer.push(static_cast<int64_t>(record.time));
+	buffer.push(static_cast<int32_t>(record.winner));
+	buffer.push(static_cast<uint32_t>(record.players.size()));
+	for (const RenX::LadderDatabase::PlayerRecord &player : record.players)
+	{
+		buffer.push(player.steamid);
+		buffer.push(player.score);
+		buffer.push(player.kills);
+		buffer.push(player.deaths);
+		buffer.push(player.headshots);
+		buffer.push(player.vehicle_kills);
+		buffer.push(player.building_kills);
+		buffer.push(player.defence_kills);
+		buffer.push(player.captures);
+		buffer.push(player.game_time);
+		buffer.push(player.beacon_placements);
+		buffer.push(player.beacon_disarms);
+		buffer.push(player.proxy_placements);
+		buffer.push(player.proxy_disarms);
+		buffer.push(player.ip32);
+		buffer.push(static_cast<int32_t>(player.team));
+		buffer.push(player.name);
+	}
+}
+
+/** Deserializes a match log record, and returns its match ID */
+static uint64_t pop_match(Jupiter::DataBuffer &buffer, RenX::LadderDatabase::MatchRecord &record)
+{
+	uint64_t match_id = buffer.pop<uint64_t>();
+	record.server = nullptr;
+	record.time = static_cast<time_t>(buffer.pop<int64_t>());
+	record.winner = static_cast<RenX::TeamType>(buffer.pop<int32_t>());
+	record.players.resize(buffer.pop<uint32_t>());
+	for (RenX::LadderDatabase::PlayerRecord &player : record.players)
+	{
+		player.steamid = buffer.pop<uint64_t>();
+		player.score = buffer.pop<double>();
+		player.kills = buffer.pop<uint32_t>();
+		player.deaths = buffer.pop<uint32_t>();
+		player.headshots = buffer.pop<uint32_t>();
+		player.vehicle_kills = buffer.pop<uint32_t>();
+		player.building_kills = buffer.pop<uint32_t>();
+		player.defence_kills = buffer.pop<uint32_t>();
+		player.captures = buffer.pop<uint32_t>();
+		player.game_time = buffer.pop<uint32_t>();
+		player.beacon_placements = buffer.pop<uint32_t>();
+		player.beacon_disarms = buffer.pop<uint32_t>();
+		player.proxy_placements = buffer.pop<uint32_t>();
+		player.proxy_disarms = buffer.pop<uint32_t>();
+		player.ip32 = buffer.pop<uint32_t>();
+		player.team = static_cast<RenX::TeamType>(buffer.pop<int32_t>());
+		player.name = buffer.pop<Jupiter::String_Strict, char>();
+	}
+	return match_id;
+}
+
+/** Appends the contents of one file to another */
+static bool append_file(const std::string &source_filename, const std::string &destination_filename)
+{
+	FILE *source = fopen(source_filename.c_str(), "rb");
+	if (source == nullptr)
+		return true;
+
+	FILE *destination = fopen(destination_filename.c_str(), "ab");
+	if (destination == nullptr)
+	{
+		fclose(source);
+		return false;
+	}
+
+	char chunk[4096];
+	size_t length;
+
+	// skip the source's header; the destination already has one
+	fgetc(source);
+	while ((length = fread(chunk, sizeof(char), sizeof(chunk), source)) != 0)
+		fwrite(chunk, sizeof(char), length, destination);
+
+	fclose(source);
+	fclose(destination);
+	return true;
+}
+
+static double ratio(double numerator, double denominator)
+{
+	return numerator / (denominator == 0.0 ? 1.0 : denominator);
+}
+
+/** Secondary orderings which may be enabled through addSort() */
+static const struct
+{
+	const char *name;
+	double(*value)(const RenX::LadderDatabase::Entry &entry);
+} sort_definitions[] =
+{
+	{ "kills", [](const RenX::LadderDatabase::Entry &entry) { return static_cast<double>(entry.total_kills); } },
+	{ "deaths", [](const RenX::LadderDatabase::Entry &entry) { return static_cast<double>(entry.total_deaths); } },
+	{ "kdr", [](const RenX::LadderDatabase::Entry &entry) { return ratio(entry.total_kills, entry.total_deaths); } },
+	{ "spm", [](const RenX::LadderDatabase::Entry &entry) { return ratio(static_cast<double>(entry.total_score), entry.total_game_time) * 60.0; } },
+	{ "games", [](const RenX::LadderDatabase::Entry &entry) { return static_cast<double>(entry.total_games); } },
+	{ "wins", [](const RenX::LadderDatabase::Entry &entry) { return static_cast<double>(entry.total_wins); } },
+	{ "winrate", [](const RenX::LadderDatabase::Entry &entry) { return ratio(entry.total_wins, entry.total_games); } },
+	{ "headshots", [](const RenX::LadderDatabase::Entry &entry) { return static_cast<double>(entry.total_headshot_kills); } },
+	{ "vehicle_kills", [](const RenX::LadderDatabase::Entry &entry) { return static_cast<double>(entry.total_vehicle_kills); } },
+	{ "building_kills", [](const RenX::LadderDatabase::Entry &entry) { return static_cast<double>(entry.total_building_kills); } },
+	{ "gdi_score", [](const RenX::LadderDatabase::Entry &entry) { return static_cast<double>(entry.total_gdi_score); } },
+	{ "gdi_kills", [](const RenX::LadderDatabase::Entry &entry) { return static_cast<double>(entry.total_gdi_kills); } },
+	{ "gdi_kdr", [](const RenX::LadderDatabase::Entry &entry) { return ratio(entry.total_gdi_kills, entry.total_gdi_deaths); } },
+	{ "gdi_wins", [](const RenX::LadderDatabase::Entry &entry) { return static_cast<double>(entry.total_gdi_wins); } },
+	{ "nod_score", [](const RenX::LadderDatabase::Entry &entry) { return static_cast<double>(entry.total_nod_score); } },
+	{ "nod_kills", [](const RenX::LadderDatabase::Entry &entry) { return static_cast<double>(entry.total_nod_kills); } },
+	{ "nod_kdr", [](const RenX::LadderDatabase::Entry &entry) { return ratio(entry.total_nod_kills, entry.total_nod_deaths); } },
+	{ "nod_wins", [](const RenX::LadderDatabase::Entry &entry) { return static_cast<double>(entry.total_nod_wins); } }
+};
+
+/** Ordering of secondary index elements; unique for each entry, so an entry's position can be found from its current value */
+static bool sort_order(const std::pair<double, RenX::LadderDatabase::Entry *> &lhs, const std::pair<double, RenX::LadderDatabase::Entry *> &rhs)
+{
+	if (lhs.first != rhs.first)
+		return lhs.first > rhs.first;
+	return lhs.second->steam_id < rhs.second->steam_id;
+}
+
+/** Fetches the distinct trigrams of a case-folded name */
+static std::vector<uint32_t> get_trigrams(const Jupiter::ReadableString &name)
+{
+	std::vector<uint32_t> result;
+	if (name.size() < 3)
+		return result;
+
+	result.reserve(name.size() - 2);
+	uint32_t trigram = (static_cast<uint32_t>(tolower(static_cast<unsigned char>(name.get(0)))) << 8) | static_cast<uint32_t>(tolower(static_cast<unsigned char>(name.get(1))));
+	for (size_t index = 2; index != name.size(); ++index)
+	{
+		trigram = ((trigram << 8) | static_cast<uint32_t>(tolower(static_cast<unsigned char>(name.get(index))))) & 0xFFFFFF;
+		result.push_back(trigram);
+	}
+
+	std::sort(result.begin(), result.end());
+	result.erase(std::unique(result.begin(), result.end()), result.end());
+	return result;
+}
+
+/**
+ * Archive files are laid out as:
+ *	version (1 byte), then varints: entry count, archive time (zigzag), database name size, label size
+ *	database name, label
+ *	one column per field, in the same order as columnar database files, each holding every entry's value in rank order:
+ *		64-bit columns and last_game are stored as zigzag varint deltas from the previous entry's value
+ *		32-bit columns are stored as varints
+ *	names: varint size followed by the name, for each entry in rank order
+ */
+static const uint8_t archive_version = 1;
+
+static void push_varint(std::string &out, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		out += static_cast<char>((value & 0x7F) | 0x80);
+		value >>= 7;
+	}
+	out += static_cast<char>(value);
+}
+
+static bool pop_varint(const char *&itr, const char *end, uint64_t &value)
+{
+	value = 0;
+	for (unsigned int shift = 0; shift < 64; shift += 7)
+	{
+		if (itr == end)
+			return false;
+
+		uint8_t byte = static_cast<uint8_t>(*itr++);
+		value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+			return true;
+	}
+	return false;
+}
+
+/** Maps signed deltas to unsigned values, so that small negative deltas stay small */
+static uint64_t zigzag(uint64_t delta)
+{
+	return (delta << 1) ^ (0 - (delta >> 63));
+}
+
+static uint64_t unzigzag(uint64_t value)
+{
+	return (value >> 1) ^ (0 - (value & 1));
+}
+
+/** Writes entries to an archive file */
+static bool write_archive(const std::string &archive_filename, const std::vector<RenX::LadderDatabase::Entry *> &entries, const Jupiter::ReadableString &name, const Jupiter::ReadableString &label)
+{
+	std::string buffer;
+	buffer.reserve(entries.size() * 64);
+	buffer += static_cast<char>(archive_version);
+	push_varint(buffer, entries.size());
+	push_varint(buffer, zigzag(static_cast<uint64_t>(static_cast<int64_t>(time(nullptr)))));
+	push_varint(buffer, name.size());
+	push_varint(buffer, label.size());
+	buffer.append(name.ptr(), name.size());
+	buffer.append(label.ptr(), label.size());
+
+	uint64_t previous;
+	for (uint64_t RenX::LadderDatabase::Entry::* member : wide_columns)
+	{
+		previous = 0;
+		for (const RenX::LadderDatabase::Entry *entry : entries)
+		{
+			push_varint(buffer, zigzag(entry->*member - previous));
+			previous = entry->*member;
+		}
+	}
+
+	for (uint32_t RenX::LadderDatabase::Entry::* member : narrow_columns)
+		for (const RenX::LadderDatabase::Entry *entry : entries)
+			push_varint(buffer, entry->*member);
+
+	previous = 0;
+	for (const RenX::LadderDatabase::Entry *entry : entries)
+	{
+		uint64_t last_game = static_cast<uint64_t>(static_cast<int64_t>(entry->last_game));
+		push_varint(buffer, zigzag(last_game - previous));
+		previous = last_game;
+	}
+
+	for (const RenX::LadderDatabase::Entry *entry : entries)
+	{
+		push_varint(buffer, entry->most_recent_name.size());
+		buffer.append(entry->most_recent_name.ptr(), entry->most_recent_name.size());
+	}
+
+	std::string temp_filename = archive_filename + ".tmp";
+	FILE *file = fopen(temp_filename.c_str(), "wb");
+	if (file == nullptr)
+		return false;
+
+	bool written = fwrite(buffer.data(), sizeof(char), buffer.size(), file) == buffer.size();
+	if (fclose(file) != 0 || written == false || rename(temp_filename.c_str(), archive_filename.c_str()) != 0)
+	{
+		remove(temp_filename.c_str());
+		return false;
+	}
+
+	return true;
+}
+
 RenX::LadderDatabase *RenX::default_ladder_database = nullptr;
 Jupiter::ArrayList<RenX::LadderDatabase> _ladder_databases;
 Jupiter::ArrayList<RenX::LadderDatabase> &RenX::ladder_databases = _ladder_databases;
 
+/** Guards _ladder_databases against changes while the ingest worker is updating ladders */
+static std::mutex registry_mutex;
+
+/**
+ * Guards _ladder_databases, default_ladder_database, ladder_references and released_ladders for other threads; see acquireLadderDatabase().
+ * Nothing else is locked while it is held, so handles may be acquired and released with a ladder locked.
+ */
+static std::mutex lookup_mutex;
+static std::unordered_map<const RenX::LadderDatabase *, size_t> ladder_references;
+
+/** Ladders passed to releaseLadderDatabase() while handles to them were held; the last handle deletes them */
+static std::unordered_set<const RenX::LadderDatabase *> released_ladders;
+
+/** Matches waiting for the ingest worker; see submitMatch() */
+static std::mutex ingest_mutex;
+static std::condition_variable ingest_condition;
+static std::deque<std::shared_ptr<const RenX::LadderDatabase::MatchRecord>> ingest_queue;
+static std::thread ingest_worker;
+static bool ingest_busy = false;
+static bool ingest_stopping = false;
+
+/** Match log; holds every match ingested since the loaded ladders were last checkpointed together */
+static std::mutex match_log_mutex;
+static std::string match_log_filename;
+static uint64_t last_match_id = 0;
+static size_t matches_since_checkpoint = 0;
+static const uint8_t match_log_version = 1;
+
+static const std::string &get_match_log_filename()
+{
+	if (match_log_filename.empty())
+		match_log_filename = static_cast<std::string>(RenX::getCore()->getConfig().get("LadderMatchLog"_jrs, "Ladder.Matches.log"_jrs));
+	return match_log_filename;
+}
+
+/** Appends a match to a match log */
+static void append_match(const std::string &log_filename, uint64_t match_id, const RenX::LadderDatabase::MatchRecord &record)
+{
+	FILE *file = fopen(log_filename.c_str(), "ab");
+	if (file == nullptr)
+		return;
+
+	fseek(file, 0, SEEK_END);
+	if (ftell(file) == 0)
+		fputc(match_log_version, file);
+
+	Jupiter::DataBuffer buffer;
+	push_match(buffer, match_id, record);
+	buffer.push_to(file);
+	fclose(file);
+}
+
+/**
+ * Sets the match log aside, for checkpoints which are about to include every match in it.
+ * The set-aside log is discarded at the next rotation if those checkpoints were all written; otherwise it is kept.
+ */
+static void rotate_match_log(const std::string &log_filename, bool discard_pending)
+{
+	std::string pending_filename = log_filename + ".1";
+	if (discard_pending)
+		remove(pending_filename.c_str());
+
+	FILE *pending = fopen(pending_filename.c_str(), "rb");
+	if (pending == nullptr)
+		rename(log_filename.c_str(), pending_filename.c_str());
+	else
+	{
+		fclose(pending);
+		if (append_file(log_filename, pending_filename))
+			remove(log_filename.c_str());
+	}
+}
+
 RenX::LadderDatabase::LadderDatabase()
 {
+	std::lock_guard<std::mutex> guard(registry_mutex);
+	std::lock_guard<std::mutex> lookup_guard(lookup_mutex);
 	_ladder_databases.add(this);
 
 	if (RenX::default_ladder_database == nullptr)
@@ -38,29 +624,74 @@ RenX::LadderDatabase::LadderDatabase(const Jupiter::ReadableString &in_name) : L
 	RenX::LadderDatabase::setName(in_name);
 }
 
-RenX::LadderDatabase::~LadderDatabase()
+RenX::LadderDatabase::LadderDatabase(const Jupiter::ReadableString &in_name, bool in_registered)
 {
-	while (RenX::LadderDatabase::head != nullptr)
+	RenX::LadderDatabase::registered = in_registered;
+	if (in_registered)
 	{
-		RenX::LadderDatabase::end = RenX::LadderDatabase::head;
-		RenX::LadderDatabase::head = RenX::LadderDatabase::head->next;
-		delete RenX::LadderDatabase::end;
+		std::lock_guard<std::mutex> guard(registry_mutex);
+		std::lock_guard<std::mutex> lookup_guard(lookup_mutex);
+		_ladder_databases.add(this);
+
+		if (RenX::default_ladder_database == nullptr)
+			RenX::default_ladder_database = this;
 	}
 
-	for (size_t index = 0; index != _ladder_databases.size(); ++index)
-		if (_ladder_databases.get(index) == this)
+	RenX::LadderDatabase::setName(in_name);
+}
+
+void RenX::LadderDatabase::unregister()
+{
+	bool last;
+	{
+		// waits for the ingest worker to finish any match it is applying to this ladder
+		std::lock_guard<std::mutex> guard(registry_mutex);
+		std::lock_guard<std::mutex> lookup_guard(lookup_mutex);
+		for (size_t index = 0; index != _ladder_databases.size(); ++index)
+			if (_ladder_databases.get(index) == this)
+			{
+				_ladder_databases.remove(index);
+				break;
+			}
+
+		if (RenX::default_ladder_database == this)
 		{
-			_ladder_databases.remove(index);
-			break;
+			if (_ladder_databases.size() == 0)
+				RenX::default_ladder_database = nullptr;
+			else
+				RenX::default_ladder_database = _ladder_databases.get(0);
 		}
 
-	if (RenX::default_ladder_database == this)
+		RenX::LadderDatabase::registered = false;
+		last = _ladder_databases.size() == 0;
+	}
+
+	// the ingest worker is stopped with the last ladder, after any queued matches are logged
+	if (last)
 	{
-		if (_ladder_databases.size() == 0)
-			RenX::default_ladder_database = nullptr;
-		else
-			RenX::default_ladder_database = _ladder_databases.get(0);
+		{
+			std::lock_guard<std::mutex> guard(ingest_mutex);
+			ingest_stopping = true;
+			ingest_condition.notify_all();
+		}
+		if (ingest_worker.joinable())
+			ingest_worker.join();
+		ingest_stopping = false;
+	}
+}
+
+RenX::LadderDatabase::~LadderDatabase()
+{
+	if (RenX::LadderDatabase::registered)
+		RenX::LadderDatabase::unregister();
+
+	while (RenX::LadderDatabase::head != nullptr)
+	{
+		RenX::LadderDatabase::end = RenX::LadderDatabase::head;
+		RenX::LadderDatabase::head = RenX::LadderDatabase::head->next;
+		RenX::LadderDatabase::release(RenX::LadderDatabase::end);
 	}
+	delete[] RenX::LadderDatabase::arena;
 }
 
 void RenX::LadderDatabase::process_data(Jupiter::DataBuffer &buffer, FILE *file, fpos_t pos)
@@ -148,6 +779,18 @@ void RenX::LadderDatabase::process_data(Jupiter::DataBuffer &buffer, FILE *file,
 	entry->last_game = buffer.pop<time_t>();
 	entry->most_recent_name = buffer.pop<Jupiter::String_Strict, char>();
 
+	// delta log records replace the existing entry for a player
+	RenX::LadderDatabase::Entry *existing = RenX::LadderDatabase::getPlayerEntry(entry->steam_id);
+	if (existing != nullptr)
+	{
+		entry->rank = existing->rank;
+		entry->next = existing->next;
+		entry->prev = existing->prev;
+		*existing = *entry;
+		delete entry;
+		return;
+	}
+
 	// push data to list
 	if (RenX::LadderDatabase::head == nullptr)
 	{
@@ -162,6 +805,8 @@ void RenX::LadderDatabase::process_data(Jupiter::DataBuffer &buffer, FILE *file,
 	}
 
 	entry->rank = ++RenX::LadderDatabase::entries;
+	RenX::LadderDatabase::ranked.push_back(entry);
+	RenX::LadderDatabase::steam_index[entry->steam_id] = entry;
 }
 
 void RenX::LadderDatabase::process_header(FILE *file)
@@ -176,48 +821,267 @@ void RenX::LadderDatabase::create_header(FILE *file)
 	fputc(RenX::LadderDatabase::write_version, file);
 }
 
-void RenX::LadderDatabase::process_file_finish(FILE *file)
+void RenX::LadderDatabase::process_file_finish(FILE *)
+{
+	RenX::LadderDatabase::filename = this->getFilename();
+	RenX::LadderDatabase::finish_load(RenX::LadderDatabase::read_version);
+}
+
+bool RenX::LadderDatabase::load(const std::string &in_filename)
+{
+	std::lock_guard<std::mutex> guard(RenX::LadderDatabase::data_mutex);
+	RenX::LadderDatabase::filename = in_filename;
+
+	RenX::LadderDatabase::archives.clear();
+	FILE *archive_index = fopen((in_filename + ".archives").c_str(), "rb");
+	if (archive_index != nullptr)
+	{
+		Jupiter::StringS label;
+		int chr;
+		while ((chr = fgetc(archive_index)) != EOF)
+		{
+			if (chr == '\n')
+			{
+				if (label.isNotEmpty())
+					RenX::LadderDatabase::archives.push_back(label);
+				label.erase();
+			}
+			else if (chr != '\r')
+				label += static_cast<char>(chr);
+		}
+		fclose(archive_index);
+	}
+
+	{
+		MappedFile file(in_filename);
+		if (file.data == nullptr)
+		{
+			// missing or empty; this is a new ladder, which starts with the next match and is written on the first update
+			if (RenX::LadderDatabase::registered)
+			{
+				std::lock_guard<std::mutex> log_guard(match_log_mutex);
+				RenX::LadderDatabase::replay_matches(true);
+				RenX::LadderDatabase::ingesting = true;
+			}
+			return false;
+		}
+
+		uint8_t base_version = static_cast<uint8_t>(file.data[0]);
+		if (base_version > RenX::LadderDatabase::write_version)
+		{
+			fprintf(stderr, "ERROR: Ladder database \"%s\" has unsupported version %u" ENDL, in_filename.c_str(), static_cast<unsigned int>(base_version));
+			return false;
+		}
+
+		if (base_version >= RenX::LadderDatabase::columnar_version)
+		{
+			if (RenX::LadderDatabase::load_columns(file.data, file.size, base_version) == false)
+			{
+				fprintf(stderr, "ERROR: Ladder database \"%s\" is truncated or corrupt" ENDL, in_filename.c_str());
+				return false;
+			}
+
+			RenX::LadderDatabase::finish_load(base_version);
+			return true;
+		}
+	}
+
+	// older row-based files are read record by record, and then upgraded by process_file_finish()
+	return this->process_file(in_filename);
+}
+
+void RenX::LadderDatabase::finish_load(uint8_t base_version)
 {
-	if (RenX::LadderDatabase::read_version != RenX::LadderDatabase::write_version)
+	const std::string &base_filename = RenX::LadderDatabase::filename;
+	std::lock_guard<std::mutex> log_guard(match_log_mutex);
+	RenX::LadderDatabase::checkpoint_match_id = RenX::LadderDatabase::applied_match_id;
+
+	// older files have their own delta logs, and predate the match log
+	size_t replayed = 0;
+	bool legacy = base_version < RenX::LadderDatabase::match_log_base_version;
+	if (legacy)
+	{
+		replayed += RenX::LadderDatabase::replay_log(base_filename + ".log.1");
+		replayed += RenX::LadderDatabase::replay_log(base_filename + ".log");
+	}
+	if (RenX::LadderDatabase::registered)
+		replayed += RenX::LadderDatabase::replay_matches(legacy);
+	if (replayed != 0)
+		RenX::LadderDatabase::sort_entries();
+
+	RenX::LadderDatabase::rebuild_sorts();
+	RenX::LadderDatabase::rebuild_name_index();
+	RenX::LadderDatabase::has_base = true;
+	if (base_version != RenX::LadderDatabase::write_version)
 	{
 		puts("Notice: Ladder database is out of date; upgrading...");
 		std::chrono::steady_clock::duration write_duration;
 		std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
 
-		RenX::LadderDatabase::write(this->getFilename());
+		// the upgraded file is columnar, so it is loaded by load() from now on
+		RenX::LadderDatabase::write(base_filename);
+		remove((base_filename + ".log.1").c_str());
+		remove((base_filename + ".log").c_str());
 
 		write_duration = std::chrono::steady_clock::now() - start_time;
 		printf("Ladder database upgrade completed in %f seconds", static_cast<double>(write_duration.count()) * (static_cast<double>(std::chrono::steady_clock::duration::period::num) / static_cast<double>(std::chrono::steady_clock::duration::period::den) * static_cast<double>(std::chrono::seconds::duration::period::den / std::chrono::seconds::duration::period::num)));
-		RenX::LadderDatabase::read_version = RenX::LadderDatabase::write_version;
 	}
+	RenX::LadderDatabase::read_version = RenX::LadderDatabase::write_version;
+	RenX::LadderDatabase::ingesting = RenX::LadderDatabase::registered;
 }
 
-RenX::LadderDatabase::Entry *RenX::LadderDatabase::getHead() const
+size_t RenX::LadderDatabase::replay_matches(bool skip)
 {
-	return RenX::LadderDatabase::head;
+	if (last_match_id < RenX::LadderDatabase::applied_match_id)
+		last_match_id = RenX::LadderDatabase::applied_match_id;
+
+	size_t result = 0;
+	RenX::LadderDatabase::MatchRecord record;
+	auto on_record = [this, skip, &record, &result](uint8_t, Jupiter::DataBuffer &buffer, FILE *, fpos_t)
+	{
+		uint64_t match_id = pop_match(buffer, record);
+		if (match_id > last_match_id)
+			last_match_id = match_id;
+
+		if (match_id > RenX::LadderDatabase::applied_match_id)
+		{
+			// skipped matches are already included, or predate this ladder
+			if (skip == false)
+			{
+				for (const RenX::LadderDatabase::PlayerRecord &player : record.players)
+					RenX::LadderDatabase::apply_player(player, record.winner, record.time);
+				++result;
+			}
+			RenX::LadderDatabase::applied_match_id = match_id;
+		}
+	};
+
+	const std::string &log_filename = get_match_log_filename();
+	read_log(log_filename + ".1", on_record);
+	read_log(log_filename, on_record);
+	return result;
 }
 
-RenX::LadderDatabase::Entry *RenX::LadderDatabase::getPlayerEntry(uint64_t steamid) const
+bool RenX::LadderDatabase::load_columns(const char *data, size_t size, uint8_t version)
 {
-	for (RenX::LadderDatabase::Entry *itr = RenX::LadderDatabase::head; itr != nullptr; itr = itr->next)
-		if (itr->steam_id == steamid)
-			return itr;
-	return nullptr;
+	size_t header_size = version >= RenX::LadderDatabase::match_log_base_version ? column_header_size_v3 : column_header_size;
+	if (size < header_size)
+		return false;
+
+	uint64_t count, names_size, match_id = 0;
+	memcpy(&count, data + 8, sizeof(count));
+	memcpy(&names_size, data + 16, sizeof(names_size));
+	if (header_size == column_header_size_v3)
+		memcpy(&match_id, data + 24, sizeof(match_id));
+
+	uint64_t body_size = size - header_size;
+	if (count > body_size / column_row_size || names_size > body_size - count * column_row_size)
+		return false;
+
+	// every entry shares a single allocation; see release()
+	size_t length = static_cast<size_t>(count);
+	RenX::LadderDatabase::Entry *loaded = new RenX::LadderDatabase::Entry[length];
+	const char *itr = data + header_size;
+
+	for (uint64_t RenX::LadderDatabase::Entry::* member : wide_columns)
+		for (size_t index = 0; index != length; ++index, itr += sizeof(uint64_t))
+			memcpy(&(loaded[index].*member), itr, sizeof(uint64_t));
+
+	for (uint32_t RenX::LadderDatabase::Entry::* member : narrow_columns)
+		for (size_t index = 0; index != length; ++index, itr += sizeof(uint32_t))
+			memcpy(&(loaded[index].*member), itr, sizeof(uint32_t));
+
+	int64_t last_game;
+	for (size_t index = 0; index != length; ++index, itr += sizeof(int64_t))
+	{
+		memcpy(&last_game, itr, sizeof(int64_t));
+		loaded[index].last_game = static_cast<time_t>(last_game);
+	}
+
+	const char *names = itr + length * sizeof(uint64_t);
+	uint64_t name_start = 0, name_end;
+	for (size_t index = 0; index != length; ++index, itr += sizeof(uint64_t))
+	{
+		memcpy(&name_end, itr, sizeof(uint64_t));
+		if (name_end < name_start || name_end > names_size)
+		{
+			delete[] loaded;
+			return false;
+		}
+
+		loaded[index].most_recent_name = Jupiter::ReferenceString(names + name_start, static_cast<size_t>(name_end - name_start));
+		name_start = name_end;
+	}
+
+	// entries are stored in rank order
+	RenX::LadderDatabase::erase();
+	RenX::LadderDatabase::arena = loaded;
+	RenX::LadderDatabase::arena_size = length;
+	RenX::LadderDatabase::ranked.reserve(length);
+	RenX::LadderDatabase::steam_index.reserve(length);
+	for (size_t index = 0; index != length; ++index)
+	{
+		RenX::LadderDatabase::Entry *entry = loaded + index;
+		entry->rank = index + 1;
+		entry->prev = index == 0 ? nullptr : entry - 1;
+		entry->next = index + 1 == length ? nullptr : entry + 1;
+		RenX::LadderDatabase::ranked.push_back(entry);
+		RenX::LadderDatabase::steam_index[entry->steam_id] = entry;
+	}
+
+	if (length != 0)
+	{
+		RenX::LadderDatabase::head = loaded;
+		RenX::LadderDatabase::end = loaded + length - 1;
+	}
+	RenX::LadderDatabase::entries = length;
+	RenX::LadderDatabase::applied_match_id = match_id;
+	RenX::LadderDatabase::last_sort = std::chrono::steady_clock::now();
+	return true;
 }
 
-std::pair<RenX::LadderDatabase::Entry *, size_t> RenX::LadderDatabase::getPlayerEntryAndIndex(uint64_t steamid) const
+void RenX::LadderDatabase::release(RenX::LadderDatabase::Entry *entry)
 {
-	size_t index = 0;
-	for (RenX::LadderDatabase::Entry *itr = RenX::LadderDatabase::head; itr != nullptr; itr = itr->next, ++index)
-		if (itr->steam_id == steamid)
-			return std::pair<RenX::LadderDatabase::Entry *, size_t>(itr, index);
-	return std::pair<RenX::LadderDatabase::Entry *, size_t>(nullptr, Jupiter::INVALID_INDEX);
+	// entries loaded from a columnar file are freed all at once, by erase() or the destructor
+	std::less<const RenX::LadderDatabase::Entry *> less;
+	if (less(entry, RenX::LadderDatabase::arena) || less(entry, RenX::LadderDatabase::arena + RenX::LadderDatabase::arena_size) == false)
+		delete entry;
 }
 
-RenX::LadderDatabase::Entry *RenX::LadderDatabase::getPlayerEntryByName(const Jupiter::ReadableString &name) const
+size_t RenX::LadderDatabase::replay_log(const std::string &log_filename)
 {
-	for (RenX::LadderDatabase::Entry *itr = RenX::LadderDatabase::head; itr != nullptr; itr = itr->next)
-		if (itr->most_recent_name.equalsi(name))
+	return read_log(log_filename, [this](uint8_t version, Jupiter::DataBuffer &buffer, FILE *file, fpos_t pos)
+	{
+		RenX::LadderDatabase::read_version = version;
+		this->process_data(buffer, file, pos);
+	});
+}
+
+RenX::LadderDatabase::Entry *RenX::LadderDatabase::getHead() const
+{
+	return RenX::LadderDatabase::head;
+}
+
+RenX::LadderDatabase::Entry *RenX::LadderDatabase::getPlayerEntry(uint64_t steamid) const
+{
+	auto itr = RenX::LadderDatabase::steam_index.find(steamid);
+	if (itr == RenX::LadderDatabase::steam_index.end())
+		return nullptr;
+	return itr->second;
+}
+
+std::pair<RenX::LadderDatabase::Entry *, size_t> RenX::LadderDatabase::getPlayerEntryAndIndex(uint64_t steamid) const
+{
+	RenX::LadderDatabase::Entry *entry = RenX::LadderDatabase::getPlayerEntry(steamid);
+	if (entry == nullptr)
+		return std::pair<RenX::LadderDatabase::Entry *, size_t>(nullptr, Jupiter::INVALID_INDEX);
+	return std::pair<RenX::LadderDatabase::Entry *, size_t>(entry, entry->rank - 1);
+}
+
+RenX::LadderDatabase::Entry *RenX::LadderDatabase::getPlayerEntryByName(const Jupiter::ReadableString &name) const
+{
+	for (RenX::LadderDatabase::Entry *itr = RenX::LadderDatabase::head; itr != nullptr; itr = itr->next)
+		if (itr->most_recent_name.equalsi(name))
 			return itr;
 	return nullptr;
 }
@@ -233,70 +1097,232 @@ std::pair<RenX::LadderDatabase::Entry *, size_t> RenX::LadderDatabase::getPlayer
 
 RenX::LadderDatabase::Entry *RenX::LadderDatabase::getPlayerEntryByPartName(const Jupiter::ReadableString &name) const
 {
-	for (RenX::LadderDatabase::Entry *itr = RenX::LadderDatabase::head; itr != nullptr; itr = itr->next)
-		if (itr->most_recent_name.findi(name) != Jupiter::INVALID_INDEX)
-			return itr;
-	return nullptr;
+	std::vector<RenX::LadderDatabase::Entry *> matches = RenX::LadderDatabase::findPlayerEntriesByPartName(name, 1);
+	if (matches.empty())
+		return nullptr;
+	return matches.front();
 }
 
 std::pair<RenX::LadderDatabase::Entry *, size_t> RenX::LadderDatabase::getPlayerEntryAndIndexByPartName(const Jupiter::ReadableString &name) const
 {
-	size_t index = 0;
-	for (RenX::LadderDatabase::Entry *itr = RenX::LadderDatabase::head; itr != nullptr; itr = itr->next, ++index)
-		if (itr->most_recent_name.findi(name) != Jupiter::INVALID_INDEX)
-			return std::pair<RenX::LadderDatabase::Entry *, size_t>(itr, index);
-	return std::pair<RenX::LadderDatabase::Entry *, size_t>(nullptr, Jupiter::INVALID_INDEX);
+	RenX::LadderDatabase::Entry *entry = RenX::LadderDatabase::getPlayerEntryByPartName(name);
+	if (entry == nullptr)
+		return std::pair<RenX::LadderDatabase::Entry *, size_t>(nullptr, Jupiter::INVALID_INDEX);
+	return std::pair<RenX::LadderDatabase::Entry *, size_t>(entry, entry->rank - 1);
 }
 
-std::forward_list<RenX::LadderDatabase::Entry> RenX::LadderDatabase::getPlayerEntriesByPartName(const Jupiter::ReadableString &name, size_t max) const
+std::vector<RenX::LadderDatabase::Entry *> RenX::LadderDatabase::findPlayerEntriesByPartName(const Jupiter::ReadableString &name, size_t max) const
 {
-	std::forward_list<RenX::LadderDatabase::Entry> list;
-	if (max == 0)
+	std::vector<RenX::LadderDatabase::Entry *> result;
+	std::vector<uint32_t> trigrams = get_trigrams(name);
+
+	if (trigrams.empty())
 	{
-		for (RenX::LadderDatabase::Entry *itr = RenX::LadderDatabase::head; itr != nullptr; itr = itr->next)
-			if (itr->most_recent_name.findi(name) != Jupiter::INVALID_INDEX)
-				list.emplace_front(*itr);
-	}
-	else
+		// too short to index; ranked order is already the result order
 		for (RenX::LadderDatabase::Entry *itr = RenX::LadderDatabase::head; itr != nullptr; itr = itr->next)
 			if (itr->most_recent_name.findi(name) != Jupiter::INVALID_INDEX)
 			{
-				list.emplace_front(*itr);
-				if (--max == 0)
-					return list;
+				result.push_back(itr);
+				if (result.size() == max)
+					break;
 			}
+		return result;
+	}
+
+	// every match contains every trigram of the name; check the entries with the least common one
+	const std::vector<RenX::LadderDatabase::Entry *> *candidates = nullptr;
+	for (uint32_t trigram : trigrams)
+	{
+		auto posting = RenX::LadderDatabase::name_index.find(trigram);
+		if (posting == RenX::LadderDatabase::name_index.end())
+			return result;
+
+		if (candidates == nullptr || posting->second.size() < candidates->size())
+			candidates = &posting->second;
+	}
+
+	for (RenX::LadderDatabase::Entry *entry : *candidates)
+		if (entry->most_recent_name.findi(name) != Jupiter::INVALID_INDEX)
+			result.push_back(entry);
+
+	auto by_rank = [](const RenX::LadderDatabase::Entry *lhs, const RenX::LadderDatabase::Entry *rhs)
+	{
+		return lhs->rank < rhs->rank;
+	};
+
+	if (max != 0 && result.size() > max)
+	{
+		std::partial_sort(result.begin(), result.begin() + max, result.end(), by_rank);
+		result.resize(max);
+	}
+	else
+		std::sort(result.begin(), result.end(), by_rank);
+
+	return result;
+}
+
+std::forward_list<RenX::LadderDatabase::Entry> RenX::LadderDatabase::getPlayerEntriesByPartName(const Jupiter::ReadableString &name, size_t max) const
+{
+	std::forward_list<RenX::LadderDatabase::Entry> list;
+	std::vector<RenX::LadderDatabase::Entry *> matches = RenX::LadderDatabase::findPlayerEntriesByPartName(name, max);
+	for (auto itr = matches.rbegin(); itr != matches.rend(); ++itr)
+		list.emplace_front(**itr);
 	return list;
 }
 
 std::forward_list<std::pair<RenX::LadderDatabase::Entry, size_t>> RenX::LadderDatabase::getPlayerEntriesAndIndexByPartName(const Jupiter::ReadableString &name, size_t max) const
 {
 	std::forward_list<std::pair<RenX::LadderDatabase::Entry, size_t>> list;
-	size_t index = 0;
-	if (max == 0)
+	std::vector<RenX::LadderDatabase::Entry *> matches = RenX::LadderDatabase::findPlayerEntriesByPartName(name, max);
+	for (auto itr = matches.rbegin(); itr != matches.rend(); ++itr)
+		list.emplace_front(**itr, (*itr)->rank - 1);
+	return list;
+}
+
+void RenX::LadderDatabase::index_name(RenX::LadderDatabase::Entry *entry)
+{
+	for (uint32_t trigram : get_trigrams(entry->most_recent_name))
+		RenX::LadderDatabase::name_index[trigram].push_back(entry);
+}
+
+void RenX::LadderDatabase::unindex_name(RenX::LadderDatabase::Entry *entry)
+{
+	for (uint32_t trigram : get_trigrams(entry->most_recent_name))
 	{
-		for (RenX::LadderDatabase::Entry *itr = RenX::LadderDatabase::head; itr != nullptr; itr = itr->next, ++index)
-			if (itr->most_recent_name.findi(name) != Jupiter::INVALID_INDEX)
-				list.emplace_front(*itr, index);
+		auto posting = RenX::LadderDatabase::name_index.find(trigram);
+		if (posting == RenX::LadderDatabase::name_index.end())
+			continue;
+
+		std::vector<RenX::LadderDatabase::Entry *> &entries = posting->second;
+		auto itr = std::find(entries.begin(), entries.end(), entry);
+		if (itr != entries.end())
+		{
+			// postings are unordered
+			*itr = entries.back();
+			entries.pop_back();
+			if (entries.empty())
+				RenX::LadderDatabase::name_index.erase(posting);
+		}
 	}
-	else
-		for (RenX::LadderDatabase::Entry *itr = RenX::LadderDatabase::head; itr != nullptr; itr = itr->next, ++index)
-			if (itr->most_recent_name.findi(name) != Jupiter::INVALID_INDEX)
+}
+
+void RenX::LadderDatabase::rebuild_name_index()
+{
+	RenX::LadderDatabase::name_index.clear();
+	for (RenX::LadderDatabase::Entry *entry = RenX::LadderDatabase::head; entry != nullptr; entry = entry->next)
+		RenX::LadderDatabase::index_name(entry);
+}
+
+RenX::LadderDatabase::Entry *RenX::LadderDatabase::getPlayerEntryByIndex(size_t index) const
+{
+	if (index >= RenX::LadderDatabase::ranked.size())
+		return nullptr;
+	return RenX::LadderDatabase::ranked[index];
+}
+
+RenX::LadderDatabase::Entry *RenX::LadderDatabase::getPlayerEntryByIndex(size_t index, const SortIndex *sort) const
+{
+	if (sort == nullptr)
+		return RenX::LadderDatabase::getPlayerEntryByIndex(index);
+
+	if (index >= sort->ranked.size())
+		return nullptr;
+	return sort->ranked[index].second;
+}
+
+size_t RenX::LadderDatabase::getRank(const RenX::LadderDatabase::Entry &entry, const SortIndex *sort) const
+{
+	if (sort == nullptr)
+		return entry.rank;
+
+	std::pair<double, RenX::LadderDatabase::Entry *> key(sort->value(entry), const_cast<RenX::LadderDatabase::Entry *>(&entry));
+	auto itr = std::lower_bound(sort->ranked.begin(), sort->ranked.end(), key, sort_order);
+	if (itr == sort->ranked.end() || itr->second->steam_id != entry.steam_id)
+		return 0;
+	return static_cast<size_t>(itr - sort->ranked.begin()) + 1;
+}
+
+bool RenX::LadderDatabase::addSort(const Jupiter::ReadableString &in_name)
+{
+	std::lock_guard<std::mutex> guard(RenX::LadderDatabase::data_mutex);
+	if (RenX::LadderDatabase::getSort(in_name) != nullptr)
+		return true;
+
+	for (const auto &definition : sort_definitions)
+	{
+		if (in_name.equalsi(definition.name))
+		{
+			RenX::LadderDatabase::SortIndex *sort = new RenX::LadderDatabase::SortIndex();
+			sort->name = Jupiter::ReferenceString(definition.name);
+			sort->value = definition.value;
 			{
-				list.emplace_front(*itr, index);
-				if (--max)
-					return list;
+				std::lock_guard<std::mutex> sort_guard(RenX::LadderDatabase::sort_mutex);
+				RenX::LadderDatabase::sorts.emplace_back(sort);
 			}
-	return list;
+
+			sort->ranked.reserve(RenX::LadderDatabase::entries);
+			for (RenX::LadderDatabase::Entry *entry = RenX::LadderDatabase::head; entry != nullptr; entry = entry->next)
+				sort->ranked.emplace_back(sort->value(*entry), entry);
+			std::sort(sort->ranked.begin(), sort->ranked.end(), sort_order);
+			return true;
+		}
+	}
+
+	return false;
 }
 
-RenX::LadderDatabase::Entry *RenX::LadderDatabase::getPlayerEntryByIndex(size_t index) const
+void RenX::LadderDatabase::addSorts(const Jupiter::ReadableString &names)
 {
-	for (RenX::LadderDatabase::Entry *itr = RenX::LadderDatabase::head; itr != nullptr; itr = itr->next, --index)
-		if (index == 0)
-			return itr;
+	size_t count = names.wordCount(WHITESPACE);
+	for (size_t index = 0; index != count; ++index)
+	{
+		Jupiter::ReferenceString sort_name = Jupiter::ReferenceString::getWord(names, index, WHITESPACE);
+		if (RenX::LadderDatabase::addSort(sort_name) == false)
+			fprintf(stderr, "Warning: Unknown ladder sort \"%.*s\"" ENDL, static_cast<int>(sort_name.size()), sort_name.ptr());
+	}
+}
+
+const RenX::LadderDatabase::SortIndex *RenX::LadderDatabase::getSort(const Jupiter::ReadableString &in_name) const
+{
+	std::lock_guard<std::mutex> guard(RenX::LadderDatabase::sort_mutex);
+	for (const auto &sort : RenX::LadderDatabase::sorts)
+		if (sort->name.equalsi(in_name))
+			return sort.get();
 	return nullptr;
 }
 
+void RenX::LadderDatabase::index_entry(RenX::LadderDatabase::Entry *entry)
+{
+	for (const auto &sort : RenX::LadderDatabase::sorts)
+	{
+		std::pair<double, RenX::LadderDatabase::Entry *> key(sort->value(*entry), entry);
+		sort->ranked.insert(std::lower_bound(sort->ranked.begin(), sort->ranked.end(), key, sort_order), key);
+	}
+}
+
+void RenX::LadderDatabase::unindex_entry(RenX::LadderDatabase::Entry *entry)
+{
+	for (const auto &sort : RenX::LadderDatabase::sorts)
+	{
+		std::pair<double, RenX::LadderDatabase::Entry *> key(sort->value(*entry), entry);
+		auto itr = std::lower_bound(sort->ranked.begin(), sort->ranked.end(), key, sort_order);
+		if (itr != sort->ranked.end() && itr->second == entry)
+			sort->ranked.erase(itr);
+	}
+}
+
+void RenX::LadderDatabase::rebuild_sorts()
+{
+	for (const auto &sort : RenX::LadderDatabase::sorts)
+	{
+		sort->ranked.clear();
+		sort->ranked.reserve(RenX::LadderDatabase::entries);
+		for (RenX::LadderDatabase::Entry *entry = RenX::LadderDatabase::head; entry != nullptr; entry = entry->next)
+			sort->ranked.emplace_back(sort->value(*entry), entry);
+		std::sort(sort->ranked.begin(), sort->ranked.end(), sort_order);
+	}
+}
+
 size_t RenX::LadderDatabase::getEntries() const
 {
 	return RenX::LadderDatabase::entries;
@@ -309,7 +1335,9 @@ std::chrono::steady_clock::time_point RenX::LadderDatabase::getLastSortTime() co
 
 void RenX::LadderDatabase::append(RenX::LadderDatabase::Entry *entry)
 {
-	++RenX::LadderDatabase::entries;
+	entry->rank = ++RenX::LadderDatabase::entries;
+	RenX::LadderDatabase::ranked.push_back(entry);
+	RenX::LadderDatabase::steam_index[entry->steam_id] = entry;
 	if (RenX::LadderDatabase::head == nullptr)
 	{
 		RenX::LadderDatabase::head = entry;
@@ -333,94 +1361,24 @@ void RenX::LadderDatabase::write(const char *filename)
 		FILE *file = fopen(filename, "wb");
 		if (file != nullptr)
 		{
-			size_t rank = 0;
-			Jupiter::DataBuffer buffer;
-			RenX::LadderDatabase::create_header(file);
-			RenX::LadderDatabase::Entry *entry = RenX::LadderDatabase::head;
-			while (entry != nullptr)
-			{
-				// update rank
-				entry->rank = ++rank;
-
-				// push data from entry to buffer
-				buffer.push(entry->steam_id);
-				buffer.push(entry->total_score);
-
-				buffer.push(entry->total_kills);
-				buffer.push(entry->total_deaths);
-				buffer.push(entry->total_headshot_kills);
-				buffer.push(entry->total_vehicle_kills);
-				buffer.push(entry->total_building_kills);
-				buffer.push(entry->total_defence_kills);
-				buffer.push(entry->total_captures);
-				buffer.push(entry->total_game_time);
-				buffer.push(entry->total_games);
-				buffer.push(entry->total_wins);
-				buffer.push(entry->total_beacon_placements);
-				buffer.push(entry->total_beacon_disarms);
-				buffer.push(entry->total_proxy_placements);
-				buffer.push(entry->total_proxy_disarms);
-
-				buffer.push(entry->total_gdi_games);
-				buffer.push(entry->total_gdi_wins);
-				buffer.push(entry->total_gdi_ties);
-				buffer.push(entry->total_gdi_game_time);
-				buffer.push(entry->total_gdi_score);
-				buffer.push(entry->total_gdi_beacon_placements);
-				buffer.push(entry->total_gdi_beacon_disarms);
-				buffer.push(entry->total_gdi_proxy_placements);
-				buffer.push(entry->total_gdi_proxy_disarms);
-				buffer.push(entry->total_gdi_kills);
-				buffer.push(entry->total_gdi_deaths);
-				buffer.push(entry->total_gdi_vehicle_kills);
-				buffer.push(entry->total_gdi_defence_kills);
-				buffer.push(entry->total_gdi_building_kills);
-				buffer.push(entry->total_gdi_headshots);
-
-				buffer.push(entry->total_nod_games);
-				buffer.push(entry->total_nod_wins);
-				buffer.push(entry->total_nod_game_time);
-				buffer.push(entry->total_nod_score);
-				buffer.push(entry->total_nod_beacon_placements);
-				buffer.push(entry->total_nod_beacon_disarms);
-				buffer.push(entry->total_nod_proxy_placements);
-				buffer.push(entry->total_nod_proxy_disarms);
-				buffer.push(entry->total_nod_kills);
-				buffer.push(entry->total_nod_deaths);
-				buffer.push(entry->total_nod_vehicle_kills);
-				buffer.push(entry->total_nod_defence_kills);
-				buffer.push(entry->total_nod_building_kills);
-				buffer.push(entry->total_nod_headshots);
-
-				buffer.push(entry->top_score);
-				buffer.push(entry->top_kills);
-				buffer.push(entry->most_deaths);
-				buffer.push(entry->top_headshot_kills);
-				buffer.push(entry->top_vehicle_kills);
-				buffer.push(entry->top_building_kills);
-				buffer.push(entry->top_defence_kills);
-				buffer.push(entry->top_captures);
-				buffer.push(entry->top_game_time);
-				buffer.push(entry->top_beacon_placements);
-				buffer.push(entry->top_beacon_disarms);
-				buffer.push(entry->top_proxy_placements);
-				buffer.push(entry->top_proxy_disarms);
-
-				buffer.push(entry->most_recent_ip);
-				buffer.push(entry->last_game);
-				buffer.push(entry->most_recent_name);
-
-				// push buffer to file
-				buffer.push_to(file);
-
-				// iterate
-				entry = entry->next;
-			}
+			std::vector<const RenX::LadderDatabase::Entry *> rows(RenX::LadderDatabase::ranked.begin(), RenX::LadderDatabase::ranked.end());
+			write_columns(file, rows, RenX::LadderDatabase::write_version, RenX::LadderDatabase::applied_match_id);
 			fclose(file);
 		}
 	}
 }
 
+void RenX::LadderDatabase::checkpoint()
+{
+	if (RenX::LadderDatabase::filename.empty())
+		return;
+
+	// entries are read in place; readers may hold lock() meanwhile, since they don't modify them
+	RenX::LadderDatabase::has_base = true;
+	RenX::LadderDatabase::checkpoint_match_id = RenX::LadderDatabase::applied_match_id;
+	RenX::LadderDatabase::checkpoint_ok = write_checkpoint(RenX::LadderDatabase::filename, RenX::LadderDatabase::head, RenX::LadderDatabase::entries, RenX::LadderDatabase::write_version, RenX::LadderDatabase::applied_match_id);
+}
+
 void RenX::LadderDatabase::sort_entries()
 {
 	if (RenX::LadderDatabase::entries <= 1)
@@ -471,157 +1429,584 @@ void RenX::LadderDatabase::sort_entries()
 	}
 
 	RenX::LadderDatabase::end = itr;
+	RenX::LadderDatabase::rebuild_ranks();
+	RenX::LadderDatabase::last_sort = std::chrono::steady_clock::now();
+}
+
+void RenX::LadderDatabase::rerank_entries(std::vector<RenX::LadderDatabase::Entry *> &changed)
+{
+	// Process from the top down; everything ranked above an unprocessed entry is then in order
+	std::sort(changed.begin(), changed.end(), [](const RenX::LadderDatabase::Entry *lhs, const RenX::LadderDatabase::Entry *rhs)
+	{
+		return lhs->rank < rhs->rank;
+	});
+	changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+	for (RenX::LadderDatabase::Entry *entry : changed)
+	{
+		auto old_position = RenX::LadderDatabase::ranked.begin() + (entry->rank - 1);
+
+		// find the first entry which doesn't outscore this one; moved entries go ahead of ties, as in sort_entries()
+		auto new_position = std::lower_bound(RenX::LadderDatabase::ranked.begin(), old_position, entry, [](const RenX::LadderDatabase::Entry *lhs, const RenX::LadderDatabase::Entry *rhs)
+		{
+			return lhs->total_score > rhs->total_score;
+		});
+
+		if (new_position == old_position)
+			continue;
+
+		// unlink entry
+		if (entry->prev == nullptr)
+			RenX::LadderDatabase::head = entry->next;
+		else
+			entry->prev->next = entry->next;
+
+		if (entry->next == nullptr)
+			RenX::LadderDatabase::end = entry->prev;
+		else
+			entry->next->prev = entry->prev;
+
+		// relink entry in front of the entry it overtakes
+		RenX::LadderDatabase::Entry *successor = *new_position;
+		entry->next = successor;
+		entry->prev = successor->prev;
+		if (successor->prev == nullptr)
+			RenX::LadderDatabase::head = entry;
+		else
+			successor->prev->next = entry;
+		successor->prev = entry;
+
+		// shift the overtaken entries down a rank
+		std::rotate(new_position, old_position, old_position + 1);
+		for (auto itr = new_position; itr != old_position + 1; ++itr)
+			(*itr)->rank = static_cast<size_t>(itr - RenX::LadderDatabase::ranked.begin()) + 1;
+	}
+
 	RenX::LadderDatabase::last_sort = std::chrono::steady_clock::now();
 }
 
+void RenX::LadderDatabase::rebuild_ranks()
+{
+	RenX::LadderDatabase::ranked.clear();
+	RenX::LadderDatabase::ranked.reserve(RenX::LadderDatabase::entries);
+	for (RenX::LadderDatabase::Entry *itr = RenX::LadderDatabase::head; itr != nullptr; itr = itr->next)
+	{
+		RenX::LadderDatabase::ranked.push_back(itr);
+		itr->rank = RenX::LadderDatabase::ranked.size();
+	}
+}
+
+std::shared_ptr<const RenX::LadderDatabase::MatchRecord> RenX::LadderDatabase::snapshotMatch(RenX::Server &server, const RenX::TeamType &team)
+{
+	std::shared_ptr<RenX::LadderDatabase::MatchRecord> record(new RenX::LadderDatabase::MatchRecord());
+	record->server = &server;
+	record->time = time(nullptr);
+	record->winner = team;
+	record->players.reserve(server.players.size());
+
+	for (auto player = server.players.begin(); player != server.players.end(); ++player)
+	{
+		if (player->steamid != 0 && (player->ban_flags & RenX::BanDatabase::Entry::FLAG_TYPE_LADDER) == 0)
+		{
+			record->players.emplace_back();
+			RenX::LadderDatabase::PlayerRecord &stats = record->players.back();
+
+			stats.steamid = player->steamid;
+			stats.score = player->score;
+			stats.kills = player->kills;
+			stats.deaths = player->deaths;
+			stats.headshots = player->headshots;
+			stats.vehicle_kills = player->vehicleKills;
+			stats.building_kills = player->buildingKills;
+			stats.defence_kills = player->defenceKills;
+			stats.captures = player->captures;
+			stats.game_time = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(server.getGameTime(*player)).count());
+			stats.beacon_placements = player->beaconPlacements;
+			stats.beacon_disarms = player->beaconDisarms;
+			stats.proxy_placements = player->proxy_placements;
+			stats.proxy_disarms = player->proxy_disarms;
+			stats.ip32 = player->ip32;
+			stats.team = player->team;
+			stats.name = player->name;
+		}
+	}
+
+	return record;
+}
+
 void RenX::LadderDatabase::updateLadder(RenX::Server &server, const RenX::TeamType &team)
 {
 	if (server.players.size() != server.getBotCount())
 	{
+		RenX::LadderDatabase::waitForUpdates();
+
 		// call the PreUpdateLadder event
 		if (this->OnPreUpdateLadder != nullptr)
+		{
+			std::lock_guard<std::mutex> guard(RenX::LadderDatabase::data_mutex);
 			this->OnPreUpdateLadder(*this, server, team);
+		}
+
+		RenX::LadderDatabase::updateLadder(*RenX::LadderDatabase::snapshotMatch(server, team));
+	}
+}
 
-		// update player stats in memory
-		RenX::LadderDatabase::Entry *entry;
-		for (auto player = server.players.begin(); player != server.players.end(); ++player)
+void RenX::LadderDatabase::submitMatch(RenX::Server &server, const std::shared_ptr<const MatchRecord> &record)
+{
+	if (server.players.size() == server.getBotCount())
+		return;
+
+	// PreUpdateLadder events may modify their ladders (i.e: erase them), so they must run after any queued matches
+	bool waited = false;
+	for (size_t index = 0; index != _ladder_databases.size(); ++index)
+	{
+		RenX::LadderDatabase *ladder = _ladder_databases.get(index);
+		if (ladder->OnPreUpdateLadder != nullptr)
 		{
-			if (player->steamid != 0 && (player->ban_flags & RenX::BanDatabase::Entry::FLAG_TYPE_LADDER) == 0)
+			if (waited == false)
 			{
-				entry = RenX::LadderDatabase::getPlayerEntry(player->steamid);
-				if (entry == nullptr)
-				{
-					entry = new RenX::LadderDatabase::Entry();
-					RenX::LadderDatabase::append(entry);
-					entry->steam_id = player->steamid;
-				}
+				RenX::LadderDatabase::waitForUpdates();
+				waited = true;
+			}
 
-				entry->total_score += static_cast<uint64_t>(player->score);
-
-				entry->total_kills += player->kills;
-				entry->total_deaths += player->deaths;
-				entry->total_headshot_kills += player->headshots;
-				entry->total_vehicle_kills += player->vehicleKills;
-				entry->total_building_kills += player->buildingKills;
-				entry->total_defence_kills += player->defenceKills;
-				entry->total_captures += player->captures;
-				entry->total_game_time += static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(server.getGameTime(*player)).count());
-				entry->total_beacon_placements += player->beaconPlacements;
-				entry->total_beacon_disarms += player->beaconDisarms;
-				entry->total_proxy_placements += player->proxy_placements;
-				entry->total_proxy_disarms += player->proxy_disarms;
-
-				++entry->total_games;
-				switch (player->team)
-				{
-				case RenX::TeamType::GDI:
-					++entry->total_gdi_games;
-					if (player->team == team)
-						++entry->total_wins, ++entry->total_gdi_wins;
-					else if (team == RenX::TeamType::None)
-						++entry->total_gdi_ties;
-
-					entry->total_gdi_game_time += static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(server.getGameTime(*player)).count());
-					entry->total_gdi_score += static_cast<uint64_t>(player->score);
-					entry->total_gdi_beacon_placements += player->beaconPlacements;
-					entry->total_gdi_beacon_disarms += player->beaconDisarms;
-					entry->total_gdi_proxy_placements += player->proxy_placements;
-					entry->total_gdi_proxy_disarms += player->proxy_disarms;
-					entry->total_gdi_kills += player->kills;
-					entry->total_gdi_deaths += player->deaths;
-					entry->total_gdi_vehicle_kills += player->vehicleKills;
-					entry->total_gdi_defence_kills += player->defenceKills;
-					entry->total_gdi_building_kills += player->buildingKills;
-					entry->total_gdi_headshots += player->headshots;
-					break;
-				case RenX::TeamType::Nod:
-					++entry->total_nod_games;
-					if (player->team == team)
-						++entry->total_wins, ++entry->total_nod_wins;
-					else if (team == RenX::TeamType::None)
-						++entry->total_nod_ties;
-
-					entry->total_nod_game_time += static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(server.getGameTime(*player)).count());
-					entry->total_nod_score += static_cast<uint64_t>(player->score);
-					entry->total_nod_beacon_placements += player->beaconPlacements;
-					entry->total_nod_beacon_disarms += player->beaconDisarms;
-					entry->total_nod_proxy_placements += player->proxy_placements;
-					entry->total_nod_proxy_disarms += player->proxy_disarms;
-					entry->total_nod_kills += player->kills;
-					entry->total_nod_deaths += player->deaths;
-					entry->total_nod_vehicle_kills += player->vehicleKills;
-					entry->total_nod_defence_kills += player->defenceKills;
-					entry->total_nod_building_kills += player->buildingKills;
-					entry->total_nod_headshots += player->headshots;
-					break;
-				default:
-					if (player->team == team)
-						++entry->total_wins;
-					break;
-				}
+			std::lock_guard<std::mutex> guard(ladder->data_mutex);
+			ladder->OnPreUpdateLadder(*ladder, server, record->winner);
+		}
+	}
 
-				auto set_if_greater = [](uint32_t &src, const uint32_t &cmp)
-				{
-					if (cmp > src)
-						src = cmp;
-				};
-
-				set_if_greater(entry->top_score, static_cast<uint32_t>(player->score));
-				set_if_greater(entry->top_kills, player->kills);
-				set_if_greater(entry->most_deaths, player->deaths);
-				set_if_greater(entry->top_headshot_kills, player->headshots);
-				set_if_greater(entry->top_vehicle_kills, player->vehicleKills);
-				set_if_greater(entry->top_building_kills, player->buildingKills);
-				set_if_greater(entry->top_defence_kills, player->defenceKills);
-				set_if_greater(entry->top_captures, player->captures);
-				set_if_greater(entry->top_game_time, static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(server.getGameTime(*player)).count()));
-				set_if_greater(entry->top_beacon_placements, player->beaconPlacements);
-				set_if_greater(entry->top_beacon_disarms, player->beaconDisarms);
-				set_if_greater(entry->top_proxy_placements, player->proxy_placements);
-				set_if_greater(entry->top_proxy_disarms, player->proxy_disarms);
-
-				entry->most_recent_ip = player->ip32;
-				entry->last_game = time(nullptr);
-				entry->most_recent_name = player->name;
-			}
+	std::lock_guard<std::mutex> guard(ingest_mutex);
+	if (ingest_worker.joinable() == false)
+		ingest_worker = std::thread(&RenX::LadderDatabase::ingest_loop);
+
+	ingest_queue.push_back(record);
+	ingest_condition.notify_all();
+}
+
+void RenX::LadderDatabase::waitForUpdates()
+{
+	std::unique_lock<std::mutex> guard(ingest_mutex);
+	ingest_condition.wait(guard, []()
+	{
+		return ingest_queue.empty() && ingest_busy == false;
+	});
+}
+
+void RenX::LadderDatabase::ingest_loop()
+{
+	std::unique_lock<std::mutex> guard(ingest_mutex);
+	while (true)
+	{
+		ingest_condition.wait(guard, []()
+		{
+			return ingest_queue.empty() == false || ingest_stopping;
+		});
+
+		// queued matches are finished before stopping
+		if (ingest_queue.empty())
+			return;
+
+		std::shared_ptr<const MatchRecord> record = ingest_queue.front();
+		ingest_queue.pop_front();
+		ingest_busy = true;
+		guard.unlock();
+
+		RenX::LadderDatabase::ingest(*record);
+
+		guard.lock();
+		ingest_busy = false;
+		ingest_condition.notify_all();
+	}
+}
+
+void RenX::LadderDatabase::ingest(const MatchRecord &record)
+{
+	std::lock_guard<std::mutex> registry_guard(registry_mutex);
+
+	// find every loaded ladder
+	std::vector<RenX::LadderDatabase *> ladders;
+	size_t checkpoint_interval = 0;
+	for (size_t index = 0; index != _ladder_databases.size(); ++index)
+	{
+		RenX::LadderDatabase *ladder = _ladder_databases.get(index);
+		std::lock_guard<std::mutex> guard(ladder->data_mutex);
+		if (ladder->ingesting)
+		{
+			ladders.push_back(ladder);
+			if (checkpoint_interval == 0 || ladder->checkpoint_interval < checkpoint_interval)
+				checkpoint_interval = ladder->checkpoint_interval;
 		}
+	}
 
-		// sort new stats
-		std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
-		RenX::LadderDatabase::sort_entries();
-		std::chrono::steady_clock::duration sort_duration = std::chrono::steady_clock::now() - start_time;
+	// log the match once for every ladder, before any are locked; once the log is long enough, every ladder is checkpointed and the log is set aside
+	uint64_t match_id;
+	bool checkpoint_due;
+	{
+		std::lock_guard<std::mutex> log_guard(match_log_mutex);
+		match_id = ++last_match_id;
+		append_match(get_match_log_filename(), match_id, record);
+
+		checkpoint_due = ++matches_since_checkpoint >= checkpoint_interval && ladders.empty() == false;
+		if (checkpoint_due)
+		{
+			bool discard_pending = true;
+			for (RenX::LadderDatabase *ladder : ladders)
+				discard_pending &= ladder->checkpoint_ok;
+
+			rotate_match_log(get_match_log_filename(), discard_pending);
+			matches_since_checkpoint = 0;
+		}
+	}
+
+	// lock every ladder in registry order, and update them in one pass over the match's players
+	std::vector<std::chrono::steady_clock::duration> sort_durations(ladders.size());
+	{
+		std::vector<std::unique_lock<std::mutex>> guards;
+		guards.reserve(ladders.size());
+		for (RenX::LadderDatabase *ladder : ladders)
+			guards.emplace_back(ladder->data_mutex);
+
+		std::vector<std::vector<RenX::LadderDatabase::Entry *>> changed(ladders.size());
+		for (auto &ladder_changed : changed)
+			ladder_changed.reserve(record.players.size());
 
-		// write new stats
-		start_time = std::chrono::steady_clock::now();
-		RenX::LadderDatabase::write(this->getFilename());
-		std::chrono::steady_clock::duration write_duration = std::chrono::steady_clock::now() - start_time;
+		for (const RenX::LadderDatabase::PlayerRecord &player : record.players)
+			for (size_t index = 0; index != ladders.size(); ++index)
+				changed[index].push_back(ladders[index]->apply_player(player, record.winner, record.time));
 
-		if (RenX::LadderDatabase::output_times)
+		for (size_t index = 0; index != ladders.size(); ++index)
 		{
-			Jupiter::StringS str = Jupiter::StringS::Format("Ladder: %zu entries sorted in %f seconds; Database written in %f seconds." ENDL,
-				RenX::LadderDatabase::getEntries(),
-				static_cast<double>(sort_duration.count()) * (static_cast<double>(std::chrono::steady_clock::duration::period::num) / static_cast<double>(std::chrono::steady_clock::duration::period::den) * static_cast<double>(std::chrono::seconds::duration::period::den / std::chrono::seconds::duration::period::num)),
-				static_cast<double>(write_duration.count()) * (static_cast<double>(std::chrono::steady_clock::duration::period::num) / static_cast<double>(std::chrono::steady_clock::duration::period::den) * static_cast<double>(std::chrono::seconds::duration::period::den / std::chrono::seconds::duration::period::num)));
-			str.println(stdout);
-			server.sendLogChan(str);
+			ladders[index]->applied_match_id = match_id;
+			sort_durations[index] = ladders[index]->finish_update(changed[index]);
 		}
 	}
+
+	// checkpoints are written once the ladders are unlocked; nothing else modifies them until this worker is idle
+	for (size_t index = 0; index != ladders.size(); ++index)
+		ladders[index]->finish_write(record.server, sort_durations[index], checkpoint_due);
+}
+
+void RenX::LadderDatabase::updateLadder(const MatchRecord &record)
+{
+	// the database file is written outside of the lock, so queued matches must not be applied meanwhile
+	if (RenX::LadderDatabase::registered)
+		RenX::LadderDatabase::waitForUpdates();
+
+	std::chrono::steady_clock::duration sort_duration;
+	{
+		std::lock_guard<std::mutex> guard(RenX::LadderDatabase::data_mutex);
+
+		std::vector<RenX::LadderDatabase::Entry *> changed;
+		changed.reserve(record.players.size());
+		for (const RenX::LadderDatabase::PlayerRecord &player : record.players)
+			changed.push_back(RenX::LadderDatabase::apply_player(player, record.winner, record.time));
+
+		// this match isn't in the match log, so the database is written in full
+		RenX::LadderDatabase::has_base = false;
+		sort_duration = RenX::LadderDatabase::finish_update(changed);
+	}
+
+	RenX::LadderDatabase::finish_write(record.server, sort_duration, false);
+}
+
+void RenX::LadderDatabase::ingestMatch(const MatchRecord &record, const std::string &log_filename)
+{
+	if (RenX::LadderDatabase::registered)
+	{
+		fprintf(stderr, "ERROR: Matches can only be ingested into unregistered ladders individually; use submitMatch()" ENDL);
+		return;
+	}
+
+	// log the match before locking the ladder, and checkpoint it once the log is long enough, as the ingest worker does
+	uint64_t match_id = RenX::LadderDatabase::applied_match_id + 1;
+	append_match(log_filename, match_id, record);
+	bool checkpoint_due = match_id - RenX::LadderDatabase::checkpoint_match_id >= RenX::LadderDatabase::checkpoint_interval;
+	if (checkpoint_due)
+		rotate_match_log(log_filename, RenX::LadderDatabase::checkpoint_ok);
+
+	std::chrono::steady_clock::duration sort_duration;
+	{
+		std::lock_guard<std::mutex> guard(RenX::LadderDatabase::data_mutex);
+
+		std::vector<RenX::LadderDatabase::Entry *> changed;
+		changed.reserve(record.players.size());
+		for (const RenX::LadderDatabase::PlayerRecord &player : record.players)
+			changed.push_back(RenX::LadderDatabase::apply_player(player, record.winner, record.time));
+
+		RenX::LadderDatabase::applied_match_id = match_id;
+		sort_duration = RenX::LadderDatabase::finish_update(changed);
+	}
+
+	RenX::LadderDatabase::finish_write(record.server, sort_duration, checkpoint_due);
+}
+
+RenX::LadderDatabase::Entry *RenX::LadderDatabase::apply_player(const PlayerRecord &player, const RenX::TeamType &team, time_t match_time)
+{
+	RenX::LadderDatabase::Entry *entry = RenX::LadderDatabase::getPlayerEntry(player.steamid);
+	if (entry == nullptr)
+	{
+		entry = new RenX::LadderDatabase::Entry();
+		entry->steam_id = player.steamid;
+		RenX::LadderDatabase::append(entry);
+	}
+	else
+		RenX::LadderDatabase::unindex_entry(entry);
+
+	entry->total_score += static_cast<uint64_t>(player.score);
+
+	entry->total_kills += player.kills;
+	entry->total_deaths += player.deaths;
+	entry->total_headshot_kills += player.headshots;
+	entry->total_vehicle_kills += player.vehicle_kills;
+	entry->total_building_kills += player.building_kills;
+	entry->total_defence_kills += player.defence_kills;
+	entry->total_captures += player.captures;
+	entry->total_game_time += player.game_time;
+	entry->total_beacon_placements += player.beacon_placements;
+	entry->total_beacon_disarms += player.beacon_disarms;
+	entry->total_proxy_placements += player.proxy_placements;
+	entry->total_proxy_disarms += player.proxy_disarms;
+
+	++entry->total_games;
+	switch (player.team)
+	{
+	case RenX::TeamType::GDI:
+		++entry->total_gdi_games;
+		if (player.team == team)
+			++entry->total_wins, ++entry->total_gdi_wins;
+		else if (team == RenX::TeamType::None)
+			++entry->total_gdi_ties;
+
+		entry->total_gdi_game_time += player.game_time;
+		entry->total_gdi_score += static_cast<uint64_t>(player.score);
+		entry->total_gdi_beacon_placements += player.beacon_placements;
+		entry->total_gdi_beacon_disarms += player.beacon_disarms;
+		entry->total_gdi_proxy_placements += player.proxy_placements;
+		entry->total_gdi_proxy_disarms += player.proxy_disarms;
+		entry->total_gdi_kills += player.kills;
+		entry->total_gdi_deaths += player.deaths;
+		entry->total_gdi_vehicle_kills += player.vehicle_kills;
+		entry->total_gdi_defence_kills += player.defence_kills;
+		entry->total_gdi_building_kills += player.building_kills;
+		entry->total_gdi_headshots += player.headshots;
+		break;
+	case RenX::TeamType::Nod:
+		++entry->total_nod_games;
+		if (player.team == team)
+			++entry->total_wins, ++entry->total_nod_wins;
+		else if (team == RenX::TeamType::None)
+			++entry->total_nod_ties;
+
+		entry->total_nod_game_time += player.game_time;
+		entry->total_nod_score += static_cast<uint64_t>(player.score);
+		entry->total_nod_beacon_placements += player.beacon_placements;
+		entry->total_nod_beacon_disarms += player.beacon_disarms;
+		entry->total_nod_proxy_placements += player.proxy_placements;
+		entry->total_nod_proxy_disarms += player.proxy_disarms;
+		entry->total_nod_kills += player.kills;
+		entry->total_nod_deaths += player.deaths;
+		entry->total_nod_vehicle_kills += player.vehicle_kills;
+		entry->total_nod_defence_kills += player.defence_kills;
+		entry->total_nod_building_kills += player.building_kills;
+		entry->total_nod_headshots += player.headshots;
+		break;
+	default:
+		if (player.team == team)
+			++entry->total_wins;
+		break;
+	}
+
+	auto set_if_greater = [](uint32_t &src, const uint32_t &cmp)
+	{
+		if (cmp > src)
+			src = cmp;
+	};
+
+	set_if_greater(entry->top_score, static_cast<uint32_t>(player.score));
+	set_if_greater(entry->top_kills, player.kills);
+	set_if_greater(entry->most_deaths, player.deaths);
+	set_if_greater(entry->top_headshot_kills, player.headshots);
+	set_if_greater(entry->top_vehicle_kills, player.vehicle_kills);
+	set_if_greater(entry->top_building_kills, player.building_kills);
+	set_if_greater(entry->top_defence_kills, player.defence_kills);
+	set_if_greater(entry->top_captures, player.captures);
+	set_if_greater(entry->top_game_time, player.game_time);
+	set_if_greater(entry->top_beacon_placements, player.beacon_placements);
+	set_if_greater(entry->top_beacon_disarms, player.beacon_disarms);
+	set_if_greater(entry->top_proxy_placements, player.proxy_placements);
+	set_if_greater(entry->top_proxy_disarms, player.proxy_disarms);
+
+	entry->most_recent_ip = player.ip32;
+	entry->last_game = match_time;
+	if (entry->most_recent_name.equals(player.name) == false)
+	{
+		RenX::LadderDatabase::unindex_name(entry);
+		entry->most_recent_name = player.name;
+		RenX::LadderDatabase::index_name(entry);
+	}
+	RenX::LadderDatabase::index_entry(entry);
+	return entry;
+}
+
+std::chrono::steady_clock::duration RenX::LadderDatabase::finish_update(std::vector<RenX::LadderDatabase::Entry *> &changed)
+{
+	// sort new stats
+	std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+	RenX::LadderDatabase::rerank_entries(changed);
+	std::chrono::steady_clock::duration sort_duration = std::chrono::steady_clock::now() - start_time;
+
+	// publish the new ladder to readers
+	++RenX::LadderDatabase::version;
+	return sort_duration;
+}
+
+void RenX::LadderDatabase::finish_write(RenX::Server *server, std::chrono::steady_clock::duration sort_duration, bool checkpoint_due)
+{
+	// write new stats; between checkpoints, they're in the match log
+	std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+	if (RenX::LadderDatabase::has_base == false || checkpoint_due)
+		RenX::LadderDatabase::checkpoint();
+	std::chrono::steady_clock::duration write_duration = std::chrono::steady_clock::now() - start_time;
+
+	{
+		std::lock_guard<std::mutex> guard(RenX::LadderDatabase::data_mutex);
+		RenX::LadderDatabase::last_update_times = std::make_pair(sort_duration, write_duration);
+	}
+
+	if (RenX::LadderDatabase::output_times)
+	{
+		Jupiter::StringS str = Jupiter::StringS::Format("Ladder: %zu entries sorted in %f seconds; Database written in %f seconds." ENDL,
+			RenX::LadderDatabase::getEntries(),
+			static_cast<double>(sort_duration.count()) * (static_cast<double>(std::chrono::steady_clock::duration::period::num) / static_cast<double>(std::chrono::steady_clock::duration::period::den) * static_cast<double>(std::chrono::seconds::duration::period::den / std::chrono::seconds::duration::period::num)),
+			static_cast<double>(write_duration.count()) * (static_cast<double>(std::chrono::steady_clock::duration::period::num) / static_cast<double>(std::chrono::steady_clock::duration::period::den) * static_cast<double>(std::chrono::seconds::duration::period::den / std::chrono::seconds::duration::period::num)));
+		str.println(stdout);
+
+		// log channel messages must be sent from the event thread; see flushOutput()
+		std::lock_guard<std::mutex> output_guard(RenX::LadderDatabase::output_mutex);
+		RenX::LadderDatabase::pending_output.emplace_back(server, str);
+	}
+}
+
+void RenX::LadderDatabase::flushOutput()
+{
+	std::vector<std::pair<RenX::Server *, Jupiter::StringS>> output;
+	{
+		std::lock_guard<std::mutex> guard(RenX::LadderDatabase::output_mutex);
+		output.swap(RenX::LadderDatabase::pending_output);
+	}
+
+	for (auto &message : output)
+		if (message.first != nullptr && RenX::getCore()->getServerIndex(message.first) != Jupiter::INVALID_INDEX)
+			message.first->sendLogChan(message.second);
+}
+
+std::unique_lock<std::mutex> RenX::LadderDatabase::lock() const
+{
+	return std::unique_lock<std::mutex>(RenX::LadderDatabase::data_mutex);
+}
+
+uint64_t RenX::LadderDatabase::getVersion() const
+{
+	return RenX::LadderDatabase::version;
+}
+
+std::pair<std::chrono::steady_clock::duration, std::chrono::steady_clock::duration> RenX::LadderDatabase::getLastUpdateTimes() const
+{
+	return RenX::LadderDatabase::last_update_times;
 }
 
 void RenX::LadderDatabase::erase()
 {
+	// the base file and match log no longer describe this ladder; rewrite it in full on the next update
+	RenX::LadderDatabase::has_base = false;
+
 	if (RenX::LadderDatabase::head != nullptr)
 	{
 		RenX::LadderDatabase::entries = 0;
 		while (RenX::LadderDatabase::head->next != nullptr)
 		{
 			RenX::LadderDatabase::head = head->next;
-			delete head->prev;
+			RenX::LadderDatabase::release(head->prev);
 		}
-		delete RenX::LadderDatabase::head;
+		RenX::LadderDatabase::release(RenX::LadderDatabase::head);
 		RenX::LadderDatabase::head = nullptr;
 		RenX::LadderDatabase::end = nullptr;
+		RenX::LadderDatabase::ranked.clear();
+		RenX::LadderDatabase::steam_index.clear();
+		for (const auto &sort : RenX::LadderDatabase::sorts)
+			sort->ranked.clear();
+		RenX::LadderDatabase::name_index.clear();
 	}
+
+	delete[] RenX::LadderDatabase::arena;
+	RenX::LadderDatabase::arena = nullptr;
+	RenX::LadderDatabase::arena_size = 0;
+}
+
+bool RenX::LadderDatabase::archive(const Jupiter::ReadableString &label)
+{
+	// files are written outside of the lock; readers are only locked out while the ladder is reset
+	if (RenX::LadderDatabase::filename.empty() || RenX::LadderDatabase::entries == 0)
+		return false;
+
+	std::string archive_filename = RenX::LadderDatabase::filename + '.' + static_cast<std::string>(label) + ".archive";
+	if (write_archive(archive_filename, RenX::LadderDatabase::ranked, RenX::LadderDatabase::name, label) == false)
+	{
+		fprintf(stderr, "ERROR: Failed to write ladder archive \"%s\"" ENDL, archive_filename.c_str());
+		return false;
+	}
+
+	bool listed = false;
+	{
+		std::lock_guard<std::mutex> guard(RenX::LadderDatabase::data_mutex);
+		for (const Jupiter::StringS &archive_label : RenX::LadderDatabase::archives)
+			if (archive_label.equals(label))
+				listed = true;
+
+		if (listed == false)
+			RenX::LadderDatabase::archives.emplace_back(label);
+
+		RenX::LadderDatabase::erase();
+		++RenX::LadderDatabase::version;
+	}
+
+	if (listed == false)
+	{
+		FILE *file = fopen((RenX::LadderDatabase::filename + ".archives").c_str(), "ab");
+		if (file != nullptr)
+		{
+			fwrite(label.ptr(), sizeof(char), label.size(), file);
+			fputc('\n', file);
+			fclose(file);
+		}
+	}
+
+	// start the new period with an empty database file, so that the archived entries are not loaded again
+	RenX::LadderDatabase::checkpoint();
+	return true;
+}
+
+const std::vector<Jupiter::StringS> &RenX::LadderDatabase::getArchives() const
+{
+	return RenX::LadderDatabase::archives;
+}
+
+std::string RenX::LadderDatabase::getArchiveFilename(const Jupiter::ReadableString &label) const
+{
+	for (const Jupiter::StringS &archive_label : RenX::LadderDatabase::archives)
+		if (archive_label.equals(label))
+			return RenX::LadderDatabase::filename + '.' + static_cast<std::string>(label) + ".archive";
+
+	return std::string();
+}
+
+time_t RenX::LadderDatabase::getLastGameTime() const
+{
+	time_t result = 0;
+	for (const RenX::LadderDatabase::Entry *entry : RenX::LadderDatabase::ranked)
+		if (entry->last_game > result)
+			result = entry->last_game;
+
+	return result;
 }
 
 const Jupiter::ReadableString &RenX::LadderDatabase::getName() const
@@ -634,6 +2019,16 @@ void RenX::LadderDatabase::setName(const Jupiter::ReadableString &in_name)
 	RenX::LadderDatabase::name = in_name;
 }
 
+size_t RenX::LadderDatabase::getCheckpointInterval() const
+{
+	return RenX::LadderDatabase::checkpoint_interval;
+}
+
+void RenX::LadderDatabase::setCheckpointInterval(size_t in_checkpoint_interval)
+{
+	RenX::LadderDatabase::checkpoint_interval = in_checkpoint_interval == 0 ? 1 : in_checkpoint_interval;
+}
+
 bool RenX::LadderDatabase::getOutputTimes() const
 {
 	return RenX::LadderDatabase::output_times;
@@ -643,3 +2038,243 @@ void RenX::LadderDatabase::setOutputTimes(bool in_output_times)
 {
 	RenX::LadderDatabase::output_times = in_output_times;
 }
+
+/** Handles for other threads */
+
+/** Keeps a registered database from being deleted until the handle is released; lookup_mutex must be held */
+static std::shared_ptr<RenX::LadderDatabase> acquire_ladder(RenX::LadderDatabase *database)
+{
+	if (database == nullptr)
+		return nullptr;
+
+	++ladder_references[database];
+	return std::shared_ptr<RenX::LadderDatabase>(database, [](RenX::LadderDatabase *handle)
+	{
+		bool released = false;
+		{
+			std::lock_guard<std::mutex> guard(lookup_mutex);
+			auto itr = ladder_references.find(handle);
+			if (--itr->second == 0)
+			{
+				ladder_references.erase(itr);
+				released = released_ladders.erase(handle) != 0;
+			}
+		}
+
+		// the database was unloaded while this handle was held
+		if (released)
+			delete handle;
+	});
+}
+
+std::shared_ptr<RenX::LadderDatabase> RenX::acquireDefaultLadderDatabase()
+{
+	std::lock_guard<std::mutex> guard(lookup_mutex);
+	return acquire_ladder(RenX::default_ladder_database);
+}
+
+std::shared_ptr<RenX::LadderDatabase> RenX::acquireLadderDatabase(const Jupiter::ReadableString &name)
+{
+	std::lock_guard<std::mutex> guard(lookup_mutex);
+	for (size_t index = 0; index != _ladder_databases.size(); ++index)
+		if (_ladder_databases.get(index)->getName().equalsi(name))
+			return acquire_ladder(_ladder_databases.get(index));
+
+	return nullptr;
+}
+
+std::vector<std::shared_ptr<RenX::LadderDatabase>> RenX::acquireLadderDatabases()
+{
+	std::vector<std::shared_ptr<RenX::LadderDatabase>> result;
+	std::lock_guard<std::mutex> guard(lookup_mutex);
+	result.reserve(_ladder_databases.size());
+	for (size_t index = 0; index != _ladder_databases.size(); ++index)
+		result.push_back(acquire_ladder(_ladder_databases.get(index)));
+
+	return result;
+}
+
+bool RenX::isDefaultLadderDatabase(const RenX::LadderDatabase *database)
+{
+	std::lock_guard<std::mutex> guard(lookup_mutex);
+	return database == RenX::default_ladder_database;
+}
+
+void RenX::setDefaultLadderDatabase(RenX::LadderDatabase *database)
+{
+	std::lock_guard<std::mutex> guard(lookup_mutex);
+	RenX::default_ladder_database = database;
+}
+
+void RenX::releaseLadderDatabase(RenX::LadderDatabase *database)
+{
+	if (database->registered)
+		database->unregister();
+
+	// no more handles can be acquired; if any are still held, the last of them deletes the database
+	{
+		std::lock_guard<std::mutex> guard(lookup_mutex);
+		if (ladder_references.find(database) != ladder_references.end())
+		{
+			released_ladders.insert(database);
+			return;
+		}
+	}
+
+	delete database;
+}
+
+/** LadderArchive */
+
+bool RenX::LadderArchive::load(const std::string &filename)
+{
+	MappedFile file(filename);
+	if (file.data == nullptr || static_cast<uint8_t>(file.data[0]) != archive_version)
+		return false;
+
+	const char *itr = file.data + 1;
+	const char *end = file.data + file.size;
+	uint64_t count, time_value, name_size, label_size, value;
+	if (pop_varint(itr, end, count) == false
+		|| pop_varint(itr, end, time_value) == false
+		|| pop_varint(itr, end, name_size) == false
+		|| pop_varint(itr, end, label_size) == false
+		|| name_size > static_cast<uint64_t>(end - itr)
+		|| label_size > static_cast<uint64_t>(end - itr) - name_size
+		|| count > static_cast<uint64_t>(end - itr)) // every entry takes at least one byte
+		return false;
+
+	Jupiter::ReferenceString database_name(itr, static_cast<size_t>(name_size));
+	itr += name_size;
+	Jupiter::ReferenceString archive_label(itr, static_cast<size_t>(label_size));
+	itr += label_size;
+
+	size_t length = static_cast<size_t>(count);
+	std::unique_ptr<RenX::LadderDatabase::Entry[]> loaded(new RenX::LadderDatabase::Entry[length]);
+
+	uint64_t previous;
+	for (uint64_t RenX::LadderDatabase::Entry::* member : wide_columns)
+	{
+		previous = 0;
+		for (size_t index = 0; index != length; ++index)
+		{
+			if (pop_varint(itr, end, value) == false)
+				return false;
+
+			previous += unzigzag(value);
+			loaded[index].*member = previous;
+		}
+	}
+
+	for (uint32_t RenX::LadderDatabase::Entry::* member : narrow_columns)
+		for (size_t index = 0; index != length; ++index)
+		{
+			if (pop_varint(itr, end, value) == false)
+				return false;
+
+			loaded[index].*member = static_cast<uint32_t>(value);
+		}
+
+	previous = 0;
+	for (size_t index = 0; index != length; ++index)
+	{
+		if (pop_varint(itr, end, value) == false)
+			return false;
+
+		previous += unzigzag(value);
+		loaded[index].last_game = static_cast<time_t>(static_cast<int64_t>(previous));
+	}
+
+	for (size_t index = 0; index != length; ++index)
+	{
+		if (pop_varint(itr, end, value) == false || value > static_cast<uint64_t>(end - itr))
+			return false;
+
+		loaded[index].most_recent_name = Jupiter::ReferenceString(itr, static_cast<size_t>(value));
+		itr += value;
+	}
+
+	RenX::LadderArchive::steam_index.clear();
+	RenX::LadderArchive::steam_index.reserve(length);
+	for (size_t index = 0; index != length; ++index)
+	{
+		RenX::LadderDatabase::Entry *entry = loaded.get() + index;
+		entry->rank = index + 1;
+		entry->prev = index == 0 ? nullptr : entry - 1;
+		entry->next = index + 1 == length ? nullptr : entry + 1;
+		RenX::LadderArchive::steam_index[entry->steam_id] = entry;
+	}
+
+	RenX::LadderArchive::entries = std::move(loaded);
+	RenX::LadderArchive::entry_count = length;
+	RenX::LadderArchive::label = archive_label;
+	RenX::LadderArchive::name = database_name;
+	RenX::LadderArchive::name += '/';
+	RenX::LadderArchive::name += archive_label;
+	RenX::LadderArchive::archive_time = static_cast<time_t>(static_cast<int64_t>(unzigzag(time_value)));
+	return true;
+}
+
+const Jupiter::ReadableString &RenX::LadderArchive::getName() const
+{
+	return RenX::LadderArchive::name;
+}
+
+const Jupiter::ReadableString &RenX::LadderArchive::getLabel() const
+{
+	return RenX::LadderArchive::label;
+}
+
+time_t RenX::LadderArchive::getArchiveTime() const
+{
+	return RenX::LadderArchive::archive_time;
+}
+
+size_t RenX::LadderArchive::getEntries() const
+{
+	return RenX::LadderArchive::entry_count;
+}
+
+RenX::LadderDatabase::Entry *RenX::LadderArchive::getHead() const
+{
+	return RenX::LadderArchive::entry_count == 0 ? nullptr : RenX::LadderArchive::entries.get();
+}
+
+RenX::LadderDatabase::Entry *RenX::LadderArchive::getPlayerEntry(uint64_t steamid) const
+{
+	auto itr = RenX::LadderArchive::steam_index.find(steamid);
+	if (itr == RenX::LadderArchive::steam_index.end())
+		return nullptr;
+	return itr->second;
+}
+
+RenX::LadderDatabase::Entry *RenX::LadderArchive::getPlayerEntryByIndex(size_t index, const RenX::LadderDatabase::SortIndex *) const
+{
+	if (index >= RenX::LadderArchive::entry_count)
+		return nullptr;
+	return RenX::LadderArchive::entries.get() + index;
+}
+
+size_t RenX::LadderArchive::getRank(const RenX::LadderDatabase::Entry &entry, const RenX::LadderDatabase::SortIndex *) const
+{
+	return entry.rank;
+}
+
+const RenX::LadderDatabase::SortIndex *RenX::LadderArchive::getSort(const Jupiter::ReadableString &) const
+{
+	return nullptr;
+}
+
+std::vector<RenX::LadderDatabase::Entry *> RenX::LadderArchive::findPlayerEntriesByPartName(const Jupiter::ReadableString &in_name, size_t max) const
+{
+	std::vector<RenX::LadderDatabase::Entry *> result;
+	for (size_t index = 0; index != RenX::LadderArchive::entry_count; ++index)
+		if (RenX::LadderArchive::entries[index].most_recent_name.findi(in_name) != Jupiter::INVALID_INDEX)
+		{
+			result.push_back(RenX::LadderArchive::entries.get() + index);
+			if (result.size() == max)
+				break;
+		}
+
+	return result;
+}
@@ -19,10 +19,20 @@
 #if !defined _RENX_LADDERDATABASE_H_HEADER
 #define _RENX_LADDERDATABASE_H_HEADER
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <forward_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include "Jupiter/Database.h"
 #include "Jupiter/String.hpp"
+#include "Jupiter/Reference_String.h"
 #include "Jupiter/ArrayList.h"
 #include "RenX.h"
 
@@ -73,7 +83,7 @@ namespace RenX
 	public: // LadderDatabase
 		struct RENX_API Entry
 		{
-			size_t rank;
+			size_t rank; /** 1-based position of the entry in the ladder; kept current by rerank_entries() as entries change, and set by sort_entries() when the ladder is loaded */
 
 			uint64_t steam_id, total_score, total_gdi_score, total_nod_score; // 64-bit fields (4)
 			uint32_t total_kills, total_deaths, total_headshot_kills, total_vehicle_kills, total_building_kills, total_defence_kills, total_captures, total_game_time, total_games, total_wins, total_beacon_placements, total_beacon_disarms, total_proxy_placements, total_proxy_disarms, // totals (14)
@@ -87,6 +97,50 @@ namespace RenX
 			Entry *prev = nullptr;
 		};
 
+		/**
+		* @brief Secondary ordering of the ladder, by a stat other than total score.
+		* Entries are kept ordered by value (descending), and then by Steam ID.
+		*/
+		struct RENX_API SortIndex
+		{
+			Jupiter::ReferenceString name;
+			double(*value)(const Entry &entry);
+			std::vector<std::pair<double, Entry *>> ranked;
+		};
+
+		/**
+		* @brief Final stats of a single player in a match, as recorded when the match ended.
+		*/
+		struct RENX_API PlayerRecord
+		{
+			uint64_t steamid;
+			double score;
+			uint32_t kills, deaths, headshots, vehicle_kills, building_kills, defence_kills, captures, game_time, beacon_placements, beacon_disarms, proxy_placements, proxy_disarms, ip32;
+			RenX::TeamType team;
+			Jupiter::StringS name;
+		};
+
+		/**
+		* @brief Compact record of a finished match, which can be applied to a ladder independently of the server.
+		*/
+		struct RENX_API MatchRecord
+		{
+			RenX::Server *server; /** Server the match was played on; only used to report output times */
+			time_t time; /** Time the match ended */
+			RenX::TeamType winner;
+			std::vector<PlayerRecord> players;
+		};
+
+		/**
+		* @brief Loads a ladder database file, along with any matches in the match log which it does not include.
+		* Columnar files are memory-mapped and read a column at a time; older row-based files are read
+		* through process_file(), and rewritten in the columnar format.
+		*
+		* @param in_filename Name of the database file; it is created on the first update if it does not exist
+		* @return True if the file was loaded, false otherwise.
+		*/
+		bool load(const std::string &in_filename);
+
 		/**
 		* @brief Fetches the head of the entry list.
 		*
@@ -95,7 +149,7 @@ namespace RenX
 		Entry *getHead() const;
 
 		/**
-		* @brief Fetches a ladder entry by Steam ID.
+		* @brief Fetches a ladder entry by Steam ID in constant time.
 		*
 		* @param steamid Steam ID to search ladder for
 		* @return Ladder entry with a matching steamid if one exists, nullptr otherwise.
@@ -113,7 +167,8 @@ namespace RenX
 		std::pair<Entry *, size_t> getPlayerEntryAndIndexByName(const Jupiter::ReadableString &name) const;
 
 		/**
-		* @brief Searches for a ladder entry by part name
+		* @brief Searches for the highest ranked ladder entry by part name
+		* Names of three or more characters are searched through a trigram index; see findPlayerEntriesByPartName().
 		*
 		* @param name Part of name to search ladder for
 		* @return Ladder entry with a matching name if one exists, nullptr otherwise.
@@ -122,23 +177,78 @@ namespace RenX
 		std::pair<Entry *, size_t> getPlayerEntryAndIndexByPartName(const Jupiter::ReadableString &name) const;
 
 		/**
-		* @brief Fetches all entries matching a part name.
+		* @brief Fetches the highest ranked entries matching a part name, in rank order.
+		* Names of three or more characters only check entries which share the name's least common trigram
+		* (case-insensitive sequence of three characters); shorter names check every entry.
 		*
 		* @param name Part of name to search for
-		* @param max Maximum number of entries to return
+		* @param max Maximum number of entries to return, or 0 to return every match
+		* @return Entries with matching names, in rank order.
+		*/
+		std::vector<Entry *> findPlayerEntriesByPartName(const Jupiter::ReadableString &name, size_t max) const;
+
+		/**
+		* @brief Fetches the highest ranked entries matching a part name, in rank order.
+		*
+		* @param name Part of name to search for
+		* @param max Maximum number of entries to return, or 0 to return every match
 		* @return List containing entries with matching names.
 		*/
 		std::forward_list<Entry> getPlayerEntriesByPartName(const Jupiter::ReadableString &name, size_t max) const;
 		std::forward_list<std::pair<Entry, size_t>> getPlayerEntriesAndIndexByPartName(const Jupiter::ReadableString &name, size_t max) const;
 
 		/**
-		* @brief Fetches a ladder entry at a specified index
+		* @brief Fetches a ladder entry at a specified index in constant time
 		*
-		* @param index Index of the element to fetch
-		* @return Ladder entry with a matching name if one exists, nullptr otherwise.
+		* @param index Index of the element to fetch (rank - 1)
+		* @return Ladder entry at the specified index if one exists, nullptr otherwise.
 		*/
 		Entry *getPlayerEntryByIndex(size_t index) const;
 
+		/**
+		* @brief Fetches a ladder entry at a specified index of a secondary ordering in constant time
+		*
+		* @param index Index of the element to fetch (rank - 1)
+		* @param sort Ordering to index into, or nullptr to index by total score
+		* @return Ladder entry at the specified index if one exists, nullptr otherwise.
+		*/
+		Entry *getPlayerEntryByIndex(size_t index, const SortIndex *sort) const;
+
+		/**
+		* @brief Fetches the rank of an entry within a secondary ordering in logarithmic time
+		*
+		* @param entry Entry to fetch the rank of
+		* @param sort Ordering to rank the entry in, or nullptr to rank by total score
+		* @return 1-based rank of the entry if it is in the ladder, 0 otherwise.
+		*/
+		size_t getRank(const Entry &entry, const SortIndex *sort) const;
+
+		/**
+		* @brief Enables a secondary ordering of the ladder, which is maintained as the ladder is updated.
+		* Available orderings are: kills, deaths, kdr, spm, games, wins, winrate, headshots, vehicle_kills,
+		* building_kills, gdi_score, gdi_kills, gdi_kdr, gdi_wins, nod_score, nod_kills, nod_kdr and nod_wins.
+		*
+		* @param in_name Name of the ordering to enable
+		* @return True if the ordering exists, false otherwise.
+		*/
+		bool addSort(const Jupiter::ReadableString &in_name);
+
+		/**
+		* @brief Enables each of a whitespace-separated list of secondary orderings; see addSort().
+		*
+		* @param names Names of the orderings to enable
+		*/
+		void addSorts(const Jupiter::ReadableString &names);
+
+		/**
+		* @brief Fetches an enabled secondary ordering by name. This may be called with or without holding lock(),
+		* but lock() must be held while using the result.
+		*
+		* @param in_name Name of the ordering to fetch
+		* @return Ordering with a matching name if it is enabled, nullptr otherwise.
+		*/
+		const SortIndex *getSort(const Jupiter::ReadableString &in_name) const;
+
 		/**
 		* @brief Fetches the total number of ladder entries in the list.
 		*
@@ -165,25 +275,145 @@ namespace RenX
 		void write(const std::string &filename);
 		void write(const char *filename);
 
+		/**
+		* @brief Rewrites the database file from the current ladder data, including every match applied to it so far.
+		* Between checkpoints, matches are only appended to the match log (see submitMatch()), and any matches
+		* which the database file does not include are replayed from the match log when the database is loaded.
+		* Entries are read without lock(), so that readers aren't held up by file I/O; the caller must not hold lock(),
+		* and the ladder must not be modified until this returns (see waitForUpdates()).
+		*/
+		void checkpoint();
+
 		/**
 		* @brief Sorts the ladder data in memory.
 		*/
 		void sort_entries();
 
+		/**
+		* @brief Moves entries whose scores have increased to their new ranks, without sorting the entire ladder.
+		* Cost is proportional to the number of changed entries times log n, plus the distance each entry moves.
+		*
+		* @param changed Entries whose total_score increased since the ladder was last sorted; reordered by this call
+		*/
+		void rerank_entries(std::vector<Entry *> &changed);
+
 		/**
 		* @brief Pushes the player data from the server into the ladder, sorts the data, and writes it to file storage.
+		* This runs on the calling thread, after any queued matches; see submitMatch() to update asynchronously.
 		*
 		* @param server Renegade-X server to pull player data from
 		* @param team Team which just won
-		* @param output_times True if the sort/write times should be output, false otherwise.
 		*/
 		void updateLadder(RenX::Server &server, const RenX::TeamType &team);
 
+		/**
+		* @brief Records the final stats of a server's players, for use with submitMatch().
+		*
+		* @param server Renegade-X server to pull player data from
+		* @param team Team which just won
+		* @return Record of the match
+		*/
+		static std::shared_ptr<const MatchRecord> snapshotMatch(RenX::Server &server, const RenX::TeamType &team);
+
+		/**
+		* @brief Queues a match to be pushed into every loaded ladder by the ingest worker thread.
+		* The worker appends the match to the match log once, and then updates every ladder in a single pass over
+		* the match's players. The PreUpdateLadder event of each ladder is called before returning.
+		*
+		* @param server Renegade-X server the match was played on
+		* @param record Record of the match, from snapshotMatch()
+		*/
+		static void submitMatch(RenX::Server &server, const std::shared_ptr<const MatchRecord> &record);
+
+		/**
+		* @brief Pushes a match record into this ladder alone, re-ranks it, and writes the database file.
+		* The match is not added to the match log. Queued matches are applied first, and the file is written after unlocking the ladder.
+		*
+		* @param record Record of the match
+		*/
+		void updateLadder(const MatchRecord &record);
+
+		/**
+		* @brief Pushes a match record into an unregistered ladder the same way the ingest worker does: the match is appended
+		* to a match log before the ladder is locked, and the database file is only rewritten every getCheckpointInterval() matches.
+		* This is meant for measuring ingestion apart from the loaded ladders; the match log is not replayed when the ladder is loaded.
+		*
+		* @param record Record of the match
+		* @param log_filename Match log to append the match to; this must not be the shared match log
+		*/
+		void ingestMatch(const MatchRecord &record, const std::string &log_filename);
+
+		/**
+		* @brief Blocks until all queued matches have been applied.
+		*/
+		static void waitForUpdates();
+
+		/**
+		* @brief Sends any sort/write times reported by the ingest worker to their servers' log channels.
+		* This must be called from the thread which processes server events.
+		*/
+		void flushOutput();
+
+		/**
+		* @brief Locks the database against updates from the ingest worker.
+		* Hold this while reading entries, or any data derived from their order.
+		*
+		* @return Lock on the database
+		*/
+		std::unique_lock<std::mutex> lock() const;
+
+		/**
+		* @brief Fetches the version of the ladder data, which is incremented each time an update is published.
+		*
+		* @return Ladder version
+		*/
+		uint64_t getVersion() const;
+
+		/**
+		* @brief Fetches how long the most recent update took to re-rank the ladder, and to write it to file storage.
+		*
+		* @return Sort duration and write duration of the most recent update
+		*/
+		std::pair<std::chrono::steady_clock::duration, std::chrono::steady_clock::duration> getLastUpdateTimes() const;
+
 		/**
 		* @brief Erases all entries in the database.
 		*/
 		void erase();
 
+		/**
+		* @brief Freezes the current ladder into a read-only archive, and starts a new, empty ladder.
+		* Archives are delta/varint encoded, and can be read with RenX::LadderArchive. Files are written without lock(),
+		* so queued matches must be applied first (see waitForUpdates()).
+		*
+		* @param label Label of the period being archived (i.e: "2017-06"); it must be usable in a file name
+		* @return True if the archive was written and the ladder was reset, false otherwise.
+		*/
+		bool archive(const Jupiter::ReadableString &label);
+
+		/**
+		* @brief Fetches the labels of this database's archives, from oldest to newest.
+		* Hold lock() while using the result.
+		*
+		* @return Labels of archived periods
+		*/
+		const std::vector<Jupiter::StringS> &getArchives() const;
+
+		/**
+		* @brief Fetches the file name of one of this database's archives.
+		*
+		* @param label Label of the archived period
+		* @return Name of the archive file if the archive exists, an empty string otherwise.
+		*/
+		std::string getArchiveFilename(const Jupiter::ReadableString &label) const;
+
+		/**
+		* @brief Fetches the time of the most recent game included in the ladder.
+		*
+		* @return Time of the most recent game, or 0 if there are no entries.
+		*/
+		time_t getLastGameTime() const;
+
 		/**
 		* @brief Gets the name of this database.
 		*/
@@ -194,6 +424,20 @@ namespace RenX
 		*/
 		void setName(const Jupiter::ReadableString &in_name);
 
+		/**
+		* @brief Fetches the number of matches between checkpoints of this database.
+		*
+		* @return Number of matches between checkpoints
+		*/
+		size_t getCheckpointInterval() const;
+
+		/**
+		* @brief Sets the number of matches between checkpoints of this database.
+		*
+		* @param in_checkpoint_interval Number of matches between checkpoints
+		*/
+		void setCheckpointInterval(size_t in_checkpoint_interval);
+
 		/**
 		* @brief Checks if this database outputs sort/write times when 'updateLadder' is called.
 		*
@@ -219,7 +463,17 @@ namespace RenX
 		LadderDatabase(const Jupiter::ReadableString &in_name);
 
 		/**
-		* @brief Deconstructor for the LadderDatabase class
+		* @brief Named constructor for the LadderDatabase class, which optionally leaves the database out of ladder_databases.
+		* Unregistered databases are never the default, never receive matches from the ingest worker, and don't replay the match log when loaded.
+		*
+		* @param in_name Name of the database
+		* @param in_registered False for a private database (i.e: benchmarks), true otherwise
+		*/
+		LadderDatabase(const Jupiter::ReadableString &in_name, bool in_registered);
+
+		/**
+		* @brief Deconstructor for the LadderDatabase class.
+		* This does not wait for handles held by other threads; registered databases which may have been handed out should be released with releaseLadderDatabase() instead.
 		*/
 		~LadderDatabase();
 
@@ -227,20 +481,203 @@ namespace RenX
 		PreUpdateLadderFunction *OnPreUpdateLadder = nullptr;
 
 	private:
-		/** Database version */
-		const uint8_t write_version = 1;
+		friend RENX_API void releaseLadderDatabase(LadderDatabase *database);
+		void unregister();
+
+		/** Database version; versions before columnar_version are stored as one record per entry, and versions before match_log_base_version have their own delta logs */
+		const uint8_t write_version = 3;
+		const uint8_t columnar_version = 2;
+		const uint8_t match_log_base_version = 3;
 		uint8_t read_version = write_version;
+		std::string filename;
 
 		bool output_times = false;
+		bool registered = true; /** True if this database is listed in ladder_databases */
+		bool has_base = false; /** True if the database file exists and reflects this ladder, aside from the match log */
+		bool ingesting = false; /** True once the database is loaded, and receives matches from the ingest worker */
+		uint64_t applied_match_id = 0; /** ID of the last match from the match log which has been applied */
+		size_t checkpoint_interval = 50;
+		bool checkpoint_ok = true; /** True if the most recent checkpoint was written */
+		uint64_t checkpoint_match_id = 0; /** applied_match_id as of the most recent checkpoint */
+
+		/** Ingest worker; shared by every ladder */
+		static void ingest_loop();
+		static void ingest(const MatchRecord &record);
+		Entry *apply_player(const PlayerRecord &player, const RenX::TeamType &team, time_t match_time);
+		std::chrono::steady_clock::duration finish_update(std::vector<Entry *> &changed);
+		void finish_write(RenX::Server *server, std::chrono::steady_clock::duration sort_duration, bool checkpoint_due);
+		mutable std::mutex data_mutex;
+		std::mutex output_mutex;
+		std::vector<std::pair<RenX::Server *, Jupiter::StringS>> pending_output;
+		std::atomic<uint64_t> version{ 0 };
+		std::pair<std::chrono::steady_clock::duration, std::chrono::steady_clock::duration> last_update_times;
 		Jupiter::StringS name;
+		std::vector<Jupiter::StringS> archives; /** Labels of archived periods; listed in the database file name followed by ".archives" */
 		std::chrono::steady_clock::time_point last_sort = std::chrono::steady_clock::now();
 		size_t entries = 0;
 		Entry *head = nullptr;
 		Entry *end = nullptr;
+
+		/** Entries in rank order; ranked[index]->rank == index + 1 */
+		std::vector<Entry *> ranked;
+		std::unordered_map<uint64_t, Entry *> steam_index;
+
+		/** Entries loaded from a columnar file, which are allocated together */
+		Entry *arena = nullptr;
+		size_t arena_size = 0;
+
+		/** Secondary orderings; see addSort(). Entries are never removed, and changes to the list also hold sort_mutex, so that getSort() may be called without holding lock() */
+		std::vector<std::unique_ptr<SortIndex>> sorts;
+		mutable std::mutex sort_mutex;
+		void index_entry(Entry *entry);
+		void unindex_entry(Entry *entry);
+		void rebuild_sorts();
+
+		/** Entries containing each trigram of case-folded names; see findPlayerEntriesByPartName() */
+		std::unordered_map<uint32_t, std::vector<Entry *>> name_index;
+		void index_name(Entry *entry);
+		void unindex_name(Entry *entry);
+		void rebuild_name_index();
+
+		bool load_columns(const char *data, size_t size, uint8_t version);
+		void finish_load(uint8_t base_version);
+		size_t replay_matches(bool skip);
+		void release(Entry *entry);
+		size_t replay_log(const std::string &log_filename);
+		void rebuild_ranks();
+	};
+
+	/**
+	* @brief Read-only ladder of a finished period, as written by LadderDatabase::archive().
+	* Archives are kept apart from the live ladders; they are neither registered in ladder_databases, nor updated.
+	*/
+	class RENX_API LadderArchive
+	{
+	public:
+		/**
+		* @brief Loads an archive file.
+		*
+		* @param filename Name of the archive file
+		* @return True if the file was loaded, false otherwise.
+		*/
+		bool load(const std::string &filename);
+
+		/**
+		* @brief Fetches the name of this archive, which is the archived database's name followed by '/' and the archive's label.
+		*/
+		const Jupiter::ReadableString &getName() const;
+
+		/**
+		* @brief Fetches the label of the archived period.
+		*/
+		const Jupiter::ReadableString &getLabel() const;
+
+		/**
+		* @brief Fetches the time the archive was written.
+		*/
+		time_t getArchiveTime() const;
+
+		/**
+		* @brief Fetches the total number of ladder entries in the archive.
+		*/
+		size_t getEntries() const;
+
+		/**
+		* @brief Fetches the head of the entry list.
+		*/
+		LadderDatabase::Entry *getHead() const;
+
+		/**
+		* @brief Fetches a ladder entry by Steam ID in constant time.
+		*
+		* @param steamid Steam ID to search the archive for
+		* @return Ladder entry with a matching steamid if one exists, nullptr otherwise.
+		*/
+		LadderDatabase::Entry *getPlayerEntry(uint64_t steamid) const;
+
+		/**
+		* @brief Fetches a ladder entry by its 0-based rank, in constant time.
+		* Archives keep only the total score ordering, so sort is ignored.
+		*/
+		LadderDatabase::Entry *getPlayerEntryByIndex(size_t index, const LadderDatabase::SortIndex *sort = nullptr) const;
+
+		/**
+		* @brief Fetches the 1-based rank of an entry; sort is ignored.
+		*/
+		size_t getRank(const LadderDatabase::Entry &entry, const LadderDatabase::SortIndex *sort = nullptr) const;
+
+		/**
+		* @brief Fetches a secondary ordering; archives keep none, so this always returns nullptr.
+		*/
+		const LadderDatabase::SortIndex *getSort(const Jupiter::ReadableString &in_name) const;
+
+		/**
+		* @brief Fetches the entries whose names contain a string, in rank order.
+		*
+		* @param name Part of the name to search for (case insensitive)
+		* @param max Maximum number of entries to return (0 for no limit)
+		* @return Matching entries, in rank order
+		*/
+		std::vector<LadderDatabase::Entry *> findPlayerEntriesByPartName(const Jupiter::ReadableString &name, size_t max) const;
+
+	private:
+		std::unique_ptr<LadderDatabase::Entry[]> entries;
+		size_t entry_count = 0;
+		std::unordered_map<uint64_t, LadderDatabase::Entry *> steam_index;
+		Jupiter::StringS name;
+		Jupiter::StringS label;
+		time_t archive_time = 0;
 	};
 
 	RENX_API extern RenX::LadderDatabase *default_ladder_database;
 	RENX_API extern Jupiter::ArrayList<RenX::LadderDatabase> &ladder_databases;
+
+	/**
+	* @brief Fetches the default ladder database, and keeps it from being destroyed until the returned handle is released.
+	* Ladders are loaded and unloaded on the main thread; other threads must use handles instead of default_ladder_database and ladder_databases.
+	* A ladder released while handles to it are held is destroyed when the last of them is released, by the thread releasing it; see releaseLadderDatabase().
+	*
+	* @return Handle to the default database, or nullptr if no databases are loaded
+	*/
+	RENX_API std::shared_ptr<RenX::LadderDatabase> acquireDefaultLadderDatabase();
+
+	/**
+	* @brief Fetches a ladder database by name (case insensitive), and keeps it from being destroyed until the returned handle is released.
+	*
+	* @param name Name of the database
+	* @return Handle to the database, or nullptr if no such database is loaded
+	*/
+	RENX_API std::shared_ptr<RenX::LadderDatabase> acquireLadderDatabase(const Jupiter::ReadableString &name);
+
+	/**
+	* @brief Fetches every loaded ladder database, and keeps them from being destroyed until the returned handles are released.
+	*
+	* @return Handles to the databases, in the order they were loaded
+	*/
+	RENX_API std::vector<std::shared_ptr<RenX::LadderDatabase>> acquireLadderDatabases();
+
+	/**
+	* @brief Checks if a database is the default ladder database; safe to use from any thread.
+	*
+	* @param database Database to check
+	* @return True if the database is the default database, false otherwise
+	*/
+	RENX_API bool isDefaultLadderDatabase(const RenX::LadderDatabase *database);
+
+	/**
+	* @brief Sets the default ladder database; must be used instead of assigning default_ladder_database directly.
+	*
+	* @param database Registered database to use as the default
+	*/
+	RENX_API void setDefaultLadderDatabase(RenX::LadderDatabase *database);
+
+	/**
+	* @brief Unregisters a database which was allocated with new, and deletes it once every handle to it has been released.
+	* Ladder plugins release their databases this way when unloaded, so that they never wait on threads which are still using them (i.e: web pages being sent).
+	*
+	* @param database Database to release
+	*/
+	RENX_API void releaseLadderDatabase(RenX::LadderDatabase *database);
 }
 
 /** Re-enable warnings */
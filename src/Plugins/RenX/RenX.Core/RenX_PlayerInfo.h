@@ -31,6 +31,8 @@
 #include "Jupiter/String.hpp"
 #include "Jupiter/Config.h"
 #include "RenX.h"
+#include "RenX_BanDatabase.h"
+#include "RenX_ExemptionDatabase.h"
 
 /** DLL Linkage Nagging */
 #if defined _MSC_VER
@@ -94,6 +96,9 @@ namespace RenX
 		mutable std::thread rdns_thread;
 		mutable int access = 0;
 		mutable Jupiter::Config varData;
+
+		RenX::BanDatabase::CheckCache ban_check_cache;
+		RenX::ExemptionDatabase::CheckCache exemption_check_cache;
 	};
 
 	static Jupiter::ReferenceString rdns_pending = STRING_LITERAL_AS_REFERENCE("RDNS_PENDING");
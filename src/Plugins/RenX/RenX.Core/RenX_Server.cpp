@@ -539,68 +539,109 @@ void RenX::Server::banCheck(RenX::PlayerInfo &player)
 	if ((player.exemption_flags & (RenX::ExemptionDatabase::Entry::FLAG_TYPE_BAN | RenX::ExemptionDatabase::Entry::FLAG_TYPE_KICK)) != 0)
 		return;
 
-	const Jupiter::ArrayList<RenX::BanDatabase::Entry> &entries = RenX::banDatabase->getEntries();
-	RenX::BanDatabase::Entry *entry = nullptr;
-	uint32_t netmask;
+	RenX::BanDatabase::CheckCache &cache = player.ban_check_cache;
+	RenX::BanDatabase::Entry **last_to_expire = cache.last_to_expire;
+	const size_t last_to_expire_size = sizeof(cache.last_to_expire) / sizeof(RenX::BanDatabase::Entry *);
+	std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+	bool rdns_ready = player.rdns_thread.joinable() == false;
+	uint8_t check_types = (this->localSteamBan ? 0x01 : 0x00)
+		| (this->localIPBan ? 0x02 : 0x00)
+		| (this->localHWIDBan ? 0x04 : 0x00)
+		| (this->localRDNSBan ? 0x08 : 0x00)
+		| (this->localNameBan ? 0x10 : 0x00)
+		| (rdns_ready ? 0x20 : 0x00);
+
+	// Reuse the previous verdict if nothing it depends upon has changed
+	if (cache.generation != RenX::banDatabase->getGeneration()
+		|| now >= cache.valid_until
+		|| cache.check_types != check_types
+		|| cache.steamid != player.steamid
+		|| cache.ip != player.ip32
+		|| cache.hwid.equals(player.hwid) == false
+		|| (rdns_ready && cache.rdns.equals(player.rdns) == false)
+		|| cache.name.equals(player.name) == false)
+	{
+		const Jupiter::ArrayList<RenX::BanDatabase::Entry> &entries = RenX::banDatabase->getEntries();
+		RenX::BanDatabase::Entry *entry = nullptr;
+		uint32_t netmask;
 
-	RenX::BanDatabase::Entry *last_to_expire[7];
-	for (size_t index = 0; index != sizeof(last_to_expire) / sizeof(RenX::BanDatabase::Entry *); ++index)
-		last_to_expire[index] = nullptr;
+		cache.flags = 0;
+		cache.valid_until = std::chrono::system_clock::time_point::max();
+		for (size_t index = 0; index != last_to_expire_size; ++index)
+			last_to_expire[index] = nullptr;
 
-	auto handle_type = [&entry, &last_to_expire](size_t index)
-	{
-		if (last_to_expire[index] == nullptr)
-			last_to_expire[index] = entry;
-		else if (last_to_expire[index]->length == std::chrono::seconds::zero())
+		auto handle_type = [&entry, &last_to_expire](size_t index)
 		{
-			// favor older bans if they're also permanent
-			if (entry->length == std::chrono::seconds::zero() && entry->timestamp < last_to_expire[index]->timestamp)
+			if (last_to_expire[index] == nullptr)
 				last_to_expire[index] = entry;
-		}
-		else if (entry->length == std::chrono::seconds::zero() || entry->timestamp + entry->length > last_to_expire[index]->timestamp + last_to_expire[index]->length)
-			last_to_expire[index] = entry;
-	};
+			else if (last_to_expire[index]->length == std::chrono::seconds::zero())
+			{
+				// favor older bans if they're also permanent
+				if (entry->length == std::chrono::seconds::zero() && entry->timestamp < last_to_expire[index]->timestamp)
+					last_to_expire[index] = entry;
+			}
+			else if (entry->length == std::chrono::seconds::zero() || entry->timestamp + entry->length > last_to_expire[index]->timestamp + last_to_expire[index]->length)
+				last_to_expire[index] = entry;
+		};
 
-	for (size_t i = 0; i != entries.size(); i++)
-	{
-		entry = entries.get(i);
-		if (entry->is_active())
+		std::vector<size_t> candidates;
+		RenX::banDatabase->getCandidates(player, candidates);
+		for (size_t i : candidates)
 		{
-			if (entry->length != std::chrono::seconds::zero() && entry->timestamp + entry->length < std::chrono::system_clock::now())
-				banDatabase->deactivate(i);
-			else
+			entry = entries.get(i);
+			if (entry->is_active())
 			{
-				if (entry->prefix_length >= 32)
-					netmask = 0xFFFFFFFF;
+				if (entry->is_expired(now))
+					banDatabase->deactivate(i);
 				else
-					netmask = Jupiter_prefix_length_to_netmask(entry->prefix_length);
-
-				if ((this->localSteamBan && entry->steamid != 0 && entry->steamid == player.steamid)
-					|| (this->localIPBan && entry->ip != 0 && (entry->ip & netmask) == (player.ip32 & netmask))
-					|| (this->localHWIDBan && entry->hwid.isNotEmpty() && entry->hwid.equals(player.hwid))
-					|| (this->localRDNSBan && entry->rdns.isNotEmpty() && entry->is_rdns_ban() && player.rdns_thread.joinable() == false && player.rdns.match(entry->rdns))
-					|| (this->localNameBan && entry->name.isNotEmpty() && entry->name.equalsi(player.name)))
 				{
-					player.ban_flags |= entry->flags;
-					if (entry->is_type_game())
-						handle_type(0);
-					if (entry->is_type_chat())
-						handle_type(1);
-					if (entry->is_type_bot())
-						handle_type(2);
-					if (entry->is_type_vote())
-						handle_type(3);
-					if (entry->is_type_mine())
-						handle_type(4);
-					if (entry->is_type_ladder())
-						handle_type(5);
-					if (entry->is_type_alert())
-						handle_type(6);
+					if (entry->prefix_length >= 32)
+						netmask = 0xFFFFFFFF;
+					else
+						netmask = Jupiter_prefix_length_to_netmask(entry->prefix_length);
+
+					if ((this->localSteamBan && entry->steamid != 0 && entry->steamid == player.steamid)
+						|| (this->localIPBan && entry->ip != 0 && (entry->ip & netmask) == (player.ip32 & netmask))
+						|| (this->localHWIDBan && entry->hwid.isNotEmpty() && entry->hwid.equals(player.hwid))
+						|| (this->localRDNSBan && entry->rdns.isNotEmpty() && entry->is_rdns_ban() && rdns_ready && player.rdns.match(entry->rdns))
+						|| (this->localNameBan && entry->name.isNotEmpty() && entry->name.equalsi(player.name)))
+					{
+						cache.flags |= entry->flags;
+						if (entry->length != std::chrono::seconds::zero() && entry->timestamp + entry->length < cache.valid_until)
+							cache.valid_until = entry->timestamp + entry->length;
+
+						if (entry->is_type_game())
+							handle_type(0);
+						if (entry->is_type_chat())
+							handle_type(1);
+						if (entry->is_type_bot())
+							handle_type(2);
+						if (entry->is_type_vote())
+							handle_type(3);
+						if (entry->is_type_mine())
+							handle_type(4);
+						if (entry->is_type_ladder())
+							handle_type(5);
+						if (entry->is_type_alert())
+							handle_type(6);
+					}
 				}
 			}
 		}
+
+		// Expired entries deactivated above are reflected in the current generation
+		cache.generation = RenX::banDatabase->getGeneration();
+		cache.check_types = check_types;
+		cache.steamid = player.steamid;
+		cache.ip = player.ip32;
+		cache.hwid = player.hwid;
+		if (rdns_ready)
+			cache.rdns = player.rdns;
+		cache.name = player.name;
 	}
 
+	player.ban_flags |= cache.flags;
+
 	char timeStr[256];
 	if (last_to_expire[0] != nullptr) // Game ban
 	{
@@ -2814,22 +2855,17 @@ void RenX::Server::processLine(const Jupiter::ReadableString &line)
 
 						if (steamid != 0ULL && default_ladder_database != nullptr && (player->ban_flags & RenX::BanDatabase::Entry::FLAG_TYPE_LADDER) == 0)
 						{
-							RenX::LadderDatabase::Entry *itr = RenX::default_ladder_database->getHead();
-							while (itr != nullptr)
+							std::unique_lock<std::mutex> guard = RenX::default_ladder_database->lock();
+							RenX::LadderDatabase::Entry *entry = RenX::default_ladder_database->getPlayerEntry(steamid);
+							if (entry != nullptr)
 							{
-								if (itr->steam_id == steamid)
+								player->local_rank = entry->rank;
+								if (this->devBot)
 								{
-									player->local_rank = itr->rank;
-									if (this->devBot)
-									{
-										player->global_rank = itr->rank;
-										if (this->rconVersion >= 4)
-											this->sendData(Jupiter::StringS::Format("dset_rank %d %d\n", player->id, player->global_rank));
-									}
-									break;
+									player->global_rank = entry->rank;
+									if (this->rconVersion >= 4)
+										this->sendData(Jupiter::StringS::Format("dset_rank %d %d\n", player->id, player->global_rank));
 								}
-
-								itr = itr->next;
 							}
 						}
 						for (size_t i = 0; i < xPlugins.size(); i++)
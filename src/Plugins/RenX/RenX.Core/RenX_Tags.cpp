@@ -16,6 +16,11 @@
  * Written by Jessica James <jessica.aj@outlook.com>
  */
 
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iterator>
+#include <algorithm>
 #include "Jupiter/Reference_String.h"
 #include "Jupiter/IRC_Client.h"
 #include "RenX_Core.h"
@@ -28,6 +33,18 @@
 
 using namespace Jupiter::literals;
 
+/** Formats the time of an entry's last game; safe to use from any thread */
+static size_t format_last_game(char *buffer, size_t size, const std::string &format, time_t last_game)
+{
+	tm last_game_tm;
+#if defined _WIN32
+	localtime_s(&last_game_tm, &last_game);
+#else // _WIN32
+	localtime_r(&last_game, &last_game_tm);
+#endif // _WIN32
+	return strftime(buffer, size, format.c_str(), &last_game_tm);
+}
+
 struct TagsImp : RenX::Tags
 {
 	bool initialize();
@@ -594,7 +611,8 @@ void TagsImp::processTags(Jupiter::StringType &msg, const RenX::LadderDatabase::
 	PROCESS_TAG(this->INTERNAL_NAME_TAG, entry.most_recent_name);
 	PROCESS_TAG(this->INTERNAL_STEAM_TAG, Jupiter::StringS::Format("%llu", entry.steam_id));
 	PROCESS_TAG(this->INTERNAL_RANK_TAG, Jupiter::StringS::Format("%u", entry.rank));
-	PROCESS_TAG(this->INTERNAL_LAST_GAME_TAG, Jupiter::StringS::Format("XX Xuary 20XX at 00:00:00")); // TODO: format this!
+	char last_game[256];
+	PROCESS_TAG(this->INTERNAL_LAST_GAME_TAG, Jupiter::ReferenceString(last_game, format_last_game(last_game, sizeof(last_game), this->dateFmt + " at " + this->timeFmt, entry.last_game)));
 
 	/** Totals */
 	PROCESS_TAG(this->INTERNAL_SCORE_TAG, Jupiter::StringS::Format("%llu", entry.total_score));
@@ -681,6 +699,502 @@ void TagsImp::processTags(Jupiter::StringType &msg, const RenX::LadderDatabase::
 	PROCESS_TAG(this->INTERNAL_VICTIM_PROXY_DISARMS_TAG, Jupiter::StringS::Format("%u", entry.top_proxy_disarms));
 }
 
+/** Compiled ladder entry templates */
+
+enum : uint16_t
+{
+	FIELD_LITERAL,
+	FIELD_NAME,
+	FIELD_STEAM,
+	FIELD_RANK,
+	FIELD_LAST_GAME,
+	FIELD_SCORE,
+	FIELD_KILLS,
+	FIELD_DEATHS,
+	FIELD_KDR,
+	FIELD_SCORE_PER_MINUTE,
+	FIELD_HEADSHOTS,
+	FIELD_HEADSHOT_KILL_RATIO,
+	FIELD_VEHICLE_KILLS,
+	FIELD_BUILDING_KILLS,
+	FIELD_DEFENCE_KILLS,
+	FIELD_CAPTURES,
+	FIELD_GAME_TIME,
+	FIELD_GAMES,
+	FIELD_WINS,
+	FIELD_TIES,
+	FIELD_LOSSES,
+	FIELD_WIN_LOSS_RATIO,
+	FIELD_BEACON_PLACEMENTS,
+	FIELD_BEACON_DISARMS,
+	FIELD_PROXY_PLACEMENTS,
+	FIELD_PROXY_DISARMS,
+	FIELD_GDI_GAMES,
+	FIELD_GDI_WINS,
+	FIELD_GDI_TIES,
+	FIELD_GDI_LOSSES,
+	FIELD_GDI_WIN_LOSS_RATIO,
+	FIELD_GDI_SCORE,
+	FIELD_GDI_SPM,
+	FIELD_GDI_GAME_TIME,
+	FIELD_GDI_BEACON_PLACEMENTS,
+	FIELD_GDI_BEACON_DISARMS,
+	FIELD_GDI_PROXY_PLACEMENTS,
+	FIELD_GDI_PROXY_DISARMS,
+	FIELD_GDI_KILLS,
+	FIELD_GDI_DEATHS,
+	FIELD_GDI_VEHICLE_KILLS,
+	FIELD_GDI_DEFENCE_KILLS,
+	FIELD_GDI_BUILDING_KILLS,
+	FIELD_GDI_KDR,
+	FIELD_GDI_HEADSHOTS,
+	FIELD_GDI_HEADSHOT_KILL_RATIO,
+	FIELD_NOD_GAMES,
+	FIELD_NOD_WINS,
+	FIELD_NOD_TIES,
+	FIELD_NOD_LOSSES,
+	FIELD_NOD_WIN_LOSS_RATIO,
+	FIELD_NOD_SCORE,
+	FIELD_NOD_SPM,
+	FIELD_NOD_GAME_TIME,
+	FIELD_NOD_BEACON_PLACEMENTS,
+	FIELD_NOD_BEACON_DISARMS,
+	FIELD_NOD_PROXY_PLACEMENTS,
+	FIELD_NOD_PROXY_DISARMS,
+	FIELD_NOD_KILLS,
+	FIELD_NOD_DEATHS,
+	FIELD_NOD_VEHICLE_KILLS,
+	FIELD_NOD_DEFENCE_KILLS,
+	FIELD_NOD_BUILDING_KILLS,
+	FIELD_NOD_KDR,
+	FIELD_NOD_HEADSHOTS,
+	FIELD_NOD_HEADSHOT_KILL_RATIO,
+	FIELD_VICTIM_SCORE,
+	FIELD_VICTIM_KILLS,
+	FIELD_VICTIM_DEATHS,
+	FIELD_VICTIM_HEADSHOTS,
+	FIELD_VICTIM_VEHICLE_KILLS,
+	FIELD_VICTIM_BUILDING_KILLS,
+	FIELD_VICTIM_DEFENCE_KILLS,
+	FIELD_VICTIM_CAPTURES,
+	FIELD_VICTIM_GAME_TIME,
+	FIELD_VICTIM_BEACON_PLACEMENTS,
+	FIELD_VICTIM_BEACON_DISARMS,
+	FIELD_VICTIM_PROXY_PLACEMENTS,
+	FIELD_VICTIM_PROXY_DISARMS,
+	FIELD_PARAMETER
+};
+
+static void append_integer(Jupiter::StringType &out, uint64_t value)
+{
+	char buffer[20];
+	char *end = buffer + sizeof(buffer);
+	char *ptr = end;
+	do
+	{
+		*--ptr = static_cast<char>('0' + value % 10);
+		value /= 10;
+	} while (value != 0);
+	out.concat(ptr, end - ptr);
+}
+
+static void append_ratio(Jupiter::StringType &out, double value)
+{
+	char buffer[64];
+	int length = snprintf(buffer, sizeof(buffer), "%.2f", value);
+	if (length > 0)
+		out.concat(buffer, std::min(static_cast<size_t>(length), sizeof(buffer) - 1));
+}
+
+void RenX::LadderEntryTemplate::compile(const Jupiter::ReadableString &format, std::initializer_list<const Jupiter::ReadableString *> parameter_tags)
+{
+	struct Field
+	{
+		const Jupiter::ReadableString *tag;
+		uint16_t field;
+	};
+
+	RenX::LadderEntryTemplate::last_game_format = RenX::tags->dateFmt + " at " + RenX::tags->timeFmt;
+
+	// parameters take precedence over entry fields, as they would be replaced first
+	std::vector<Field> fields;
+	uint16_t parameter_index = FIELD_PARAMETER;
+	for (const Jupiter::ReadableString *tag : parameter_tags)
+		fields.push_back({ tag, parameter_index++ });
+
+	const Field entry_fields[] =
+	{
+		{ &RenX::tags->INTERNAL_NAME_TAG, FIELD_NAME },
+		{ &RenX::tags->INTERNAL_STEAM_TAG, FIELD_STEAM },
+		{ &RenX::tags->INTERNAL_RANK_TAG, FIELD_RANK },
+		{ &RenX::tags->INTERNAL_LAST_GAME_TAG, FIELD_LAST_GAME },
+		{ &RenX::tags->INTERNAL_SCORE_TAG, FIELD_SCORE },
+		{ &RenX::tags->INTERNAL_KILLS_TAG, FIELD_KILLS },
+		{ &RenX::tags->INTERNAL_DEATHS_TAG, FIELD_DEATHS },
+		{ &RenX::tags->INTERNAL_KDR_TAG, FIELD_KDR },
+		{ &RenX::tags->INTERNAL_SCORE_PER_MINUTE_TAG, FIELD_SCORE_PER_MINUTE },
+		{ &RenX::tags->INTERNAL_HEADSHOTS_TAG, FIELD_HEADSHOTS },
+		{ &RenX::tags->INTERNAL_HEADSHOT_KILL_RATIO_TAG, FIELD_HEADSHOT_KILL_RATIO },
+		{ &RenX::tags->INTERNAL_VEHICLE_KILLS_TAG, FIELD_VEHICLE_KILLS },
+		{ &RenX::tags->INTERNAL_BUILDING_KILLS_TAG, FIELD_BUILDING_KILLS },
+		{ &RenX::tags->INTERNAL_DEFENCE_KILLS_TAG, FIELD_DEFENCE_KILLS },
+		{ &RenX::tags->INTERNAL_CAPTURES_TAG, FIELD_CAPTURES },
+		{ &RenX::tags->INTERNAL_GAME_TIME_TAG, FIELD_GAME_TIME },
+		{ &RenX::tags->INTERNAL_GAMES_TAG, FIELD_GAMES },
+		{ &RenX::tags->INTERNAL_WINS_TAG, FIELD_WINS },
+		{ &RenX::tags->INTERNAL_TIES_TAG, FIELD_TIES },
+		{ &RenX::tags->INTERNAL_LOSSES_TAG, FIELD_LOSSES },
+		{ &RenX::tags->INTERNAL_WIN_LOSS_RATIO_TAG, FIELD_WIN_LOSS_RATIO },
+		{ &RenX::tags->INTERNAL_BEACON_PLACEMENTS_TAG, FIELD_BEACON_PLACEMENTS },
+		{ &RenX::tags->INTERNAL_BEACON_DISARMS_TAG, FIELD_BEACON_DISARMS },
+		{ &RenX::tags->INTERNAL_PROXY_PLACEMENTS_TAG, FIELD_PROXY_PLACEMENTS },
+		{ &RenX::tags->INTERNAL_PROXY_DISARMS_TAG, FIELD_PROXY_DISARMS },
+		{ &RenX::tags->INTERNAL_GDI_GAMES_TAG, FIELD_GDI_GAMES },
+		{ &RenX::tags->INTERNAL_GDI_WINS_TAG, FIELD_GDI_WINS },
+		{ &RenX::tags->INTERNAL_GDI_TIES_TAG, FIELD_GDI_TIES },
+		{ &RenX::tags->INTERNAL_GDI_LOSSES_TAG, FIELD_GDI_LOSSES },
+		{ &RenX::tags->INTERNAL_GDI_WIN_LOSS_RATIO_TAG, FIELD_GDI_WIN_LOSS_RATIO },
+		{ &RenX::tags->INTERNAL_GDI_SCORE_TAG, FIELD_GDI_SCORE },
+		{ &RenX::tags->INTERNAL_GDI_SPM_TAG, FIELD_GDI_SPM },
+		{ &RenX::tags->INTERNAL_GDI_GAME_TIME_TAG, FIELD_GDI_GAME_TIME },
+		{ &RenX::tags->INTERNAL_GDI_BEACON_PLACEMENTS_TAG, FIELD_GDI_BEACON_PLACEMENTS },
+		{ &RenX::tags->INTERNAL_GDI_BEACON_DISARMS_TAG, FIELD_GDI_BEACON_DISARMS },
+		{ &RenX::tags->INTERNAL_GDI_PROXY_PLACEMENTS_TAG, FIELD_GDI_PROXY_PLACEMENTS },
+		{ &RenX::tags->INTERNAL_GDI_PROXY_DISARMS_TAG, FIELD_GDI_PROXY_DISARMS },
+		{ &RenX::tags->INTERNAL_GDI_KILLS_TAG, FIELD_GDI_KILLS },
+		{ &RenX::tags->INTERNAL_GDI_DEATHS_TAG, FIELD_GDI_DEATHS },
+		{ &RenX::tags->INTERNAL_GDI_VEHICLE_KILLS_TAG, FIELD_GDI_VEHICLE_KILLS },
+		{ &RenX::tags->INTERNAL_GDI_DEFENCE_KILLS_TAG, FIELD_GDI_DEFENCE_KILLS },
+		{ &RenX::tags->INTERNAL_GDI_BUILDING_KILLS_TAG, FIELD_GDI_BUILDING_KILLS },
+		{ &RenX::tags->INTERNAL_GDI_KDR_TAG, FIELD_GDI_KDR },
+		{ &RenX::tags->INTERNAL_GDI_HEADSHOTS_TAG, FIELD_GDI_HEADSHOTS },
+		{ &RenX::tags->INTERNAL_GDI_HEADSHOT_KILL_RATIO_TAG, FIELD_GDI_HEADSHOT_KILL_RATIO },
+		{ &RenX::tags->INTERNAL_NOD_GAMES_TAG, FIELD_NOD_GAMES },
+		{ &RenX::tags->INTERNAL_NOD_WINS_TAG, FIELD_NOD_WINS },
+		{ &RenX::tags->INTERNAL_NOD_TIES_TAG, FIELD_NOD_TIES },
+		{ &RenX::tags->INTERNAL_NOD_LOSSES_TAG, FIELD_NOD_LOSSES },
+		{ &RenX::tags->INTERNAL_NOD_WIN_LOSS_RATIO_TAG, FIELD_NOD_WIN_LOSS_RATIO },
+		{ &RenX::tags->INTERNAL_NOD_SCORE_TAG, FIELD_NOD_SCORE },
+		{ &RenX::tags->INTERNAL_NOD_SPM_TAG, FIELD_NOD_SPM },
+		{ &RenX::tags->INTERNAL_NOD_GAME_TIME_TAG, FIELD_NOD_GAME_TIME },
+		{ &RenX::tags->INTERNAL_NOD_BEACON_PLACEMENTS_TAG, FIELD_NOD_BEACON_PLACEMENTS },
+		{ &RenX::tags->INTERNAL_NOD_BEACON_DISARMS_TAG, FIELD_NOD_BEACON_DISARMS },
+		{ &RenX::tags->INTERNAL_NOD_PROXY_PLACEMENTS_TAG, FIELD_NOD_PROXY_PLACEMENTS },
+		{ &RenX::tags->INTERNAL_NOD_PROXY_DISARMS_TAG, FIELD_NOD_PROXY_DISARMS },
+		{ &RenX::tags->INTERNAL_NOD_KILLS_TAG, FIELD_NOD_KILLS },
+		{ &RenX::tags->INTERNAL_NOD_DEATHS_TAG, FIELD_NOD_DEATHS },
+		{ &RenX::tags->INTERNAL_NOD_VEHICLE_KILLS_TAG, FIELD_NOD_VEHICLE_KILLS },
+		{ &RenX::tags->INTERNAL_NOD_DEFENCE_KILLS_TAG, FIELD_NOD_DEFENCE_KILLS },
+		{ &RenX::tags->INTERNAL_NOD_BUILDING_KILLS_TAG, FIELD_NOD_BUILDING_KILLS },
+		{ &RenX::tags->INTERNAL_NOD_KDR_TAG, FIELD_NOD_KDR },
+		{ &RenX::tags->INTERNAL_NOD_HEADSHOTS_TAG, FIELD_NOD_HEADSHOTS },
+		{ &RenX::tags->INTERNAL_NOD_HEADSHOT_KILL_RATIO_TAG, FIELD_NOD_HEADSHOT_KILL_RATIO },
+		{ &RenX::tags->INTERNAL_VICTIM_SCORE_TAG, FIELD_VICTIM_SCORE },
+		{ &RenX::tags->INTERNAL_VICTIM_KILLS_TAG, FIELD_VICTIM_KILLS },
+		{ &RenX::tags->INTERNAL_VICTIM_DEATHS_TAG, FIELD_VICTIM_DEATHS },
+		{ &RenX::tags->INTERNAL_VICTIM_HEADSHOTS_TAG, FIELD_VICTIM_HEADSHOTS },
+		{ &RenX::tags->INTERNAL_VICTIM_VEHICLE_KILLS_TAG, FIELD_VICTIM_VEHICLE_KILLS },
+		{ &RenX::tags->INTERNAL_VICTIM_BUILDING_KILLS_TAG, FIELD_VICTIM_BUILDING_KILLS },
+		{ &RenX::tags->INTERNAL_VICTIM_DEFENCE_KILLS_TAG, FIELD_VICTIM_DEFENCE_KILLS },
+		{ &RenX::tags->INTERNAL_VICTIM_CAPTURES_TAG, FIELD_VICTIM_CAPTURES },
+		{ &RenX::tags->INTERNAL_VICTIM_GAME_TIME_TAG, FIELD_VICTIM_GAME_TIME },
+		{ &RenX::tags->INTERNAL_VICTIM_BEACON_PLACEMENTS_TAG, FIELD_VICTIM_BEACON_PLACEMENTS },
+		{ &RenX::tags->INTERNAL_VICTIM_BEACON_DISARMS_TAG, FIELD_VICTIM_BEACON_DISARMS },
+		{ &RenX::tags->INTERNAL_VICTIM_PROXY_PLACEMENTS_TAG, FIELD_VICTIM_PROXY_PLACEMENTS },
+		{ &RenX::tags->INTERNAL_VICTIM_PROXY_DISARMS_TAG, FIELD_VICTIM_PROXY_DISARMS },
+	};
+	fields.insert(fields.end(), std::begin(entry_fields), std::end(entry_fields));
+
+	RenX::LadderEntryTemplate::text = format;
+	RenX::LadderEntryTemplate::segments.clear();
+
+	size_t literal_start = 0;
+	size_t index = 0;
+	while (index < format.size())
+	{
+		const Field *match = nullptr;
+		for (const Field &field : fields)
+			if (field.tag->isNotEmpty() && field.tag->size() <= format.size() - index && memcmp(format.ptr() + index, field.tag->ptr(), field.tag->size()) == 0)
+			{
+				match = &field;
+				break;
+			}
+
+		if (match == nullptr)
+		{
+			++index;
+			continue;
+		}
+
+		if (index != literal_start)
+			RenX::LadderEntryTemplate::segments.push_back({ FIELD_LITERAL, literal_start, index - literal_start });
+		RenX::LadderEntryTemplate::segments.push_back({ match->field, 0, 0 });
+		index += match->tag->size();
+		literal_start = index;
+	}
+
+	if (index != literal_start)
+		RenX::LadderEntryTemplate::segments.push_back({ FIELD_LITERAL, literal_start, index - literal_start });
+}
+
+void RenX::LadderEntryTemplate::render(Jupiter::StringType &out, const RenX::LadderDatabase::Entry &entry, size_t rank, std::initializer_list<Jupiter::ReferenceString> parameters) const
+{
+	uint32_t total_tied_games = entry.total_wins - entry.total_gdi_wins - entry.total_nod_wins;
+
+	for (const Segment &segment : RenX::LadderEntryTemplate::segments)
+	{
+		switch (segment.field)
+		{
+		case FIELD_LITERAL:
+			out.concat(RenX::LadderEntryTemplate::text.ptr() + segment.offset, segment.length);
+			break;
+
+		case FIELD_NAME:
+			out.concat(entry.most_recent_name);
+			break;
+		case FIELD_STEAM:
+			append_integer(out, entry.steam_id);
+			break;
+		case FIELD_RANK:
+			append_integer(out, rank != 0 ? rank : entry.rank);
+			break;
+		case FIELD_LAST_GAME:
+		{
+			char last_game[256];
+			out.concat(Jupiter::ReferenceString(last_game, format_last_game(last_game, sizeof(last_game), RenX::LadderEntryTemplate::last_game_format, entry.last_game)));
+			break;
+		}
+		case FIELD_SCORE:
+			append_integer(out, entry.total_score);
+			break;
+		case FIELD_KILLS:
+			append_integer(out, entry.total_kills);
+			break;
+		case FIELD_DEATHS:
+			append_integer(out, entry.total_deaths);
+			break;
+		case FIELD_KDR:
+			append_ratio(out, get_ratio(static_cast<double>(entry.total_kills), static_cast<double>(entry.total_deaths)));
+			break;
+		case FIELD_SCORE_PER_MINUTE:
+			append_ratio(out, get_ratio(static_cast<double>(entry.total_score), static_cast<double>(entry.total_game_time) / 60.0));
+			break;
+		case FIELD_HEADSHOTS:
+			append_integer(out, entry.total_headshot_kills);
+			break;
+		case FIELD_HEADSHOT_KILL_RATIO:
+			append_ratio(out, get_ratio(entry.total_headshot_kills, entry.total_kills));
+			break;
+		case FIELD_VEHICLE_KILLS:
+			append_integer(out, entry.total_vehicle_kills);
+			break;
+		case FIELD_BUILDING_KILLS:
+			append_integer(out, entry.total_building_kills);
+			break;
+		case FIELD_DEFENCE_KILLS:
+			append_integer(out, entry.total_defence_kills);
+			break;
+		case FIELD_CAPTURES:
+			append_integer(out, entry.total_captures);
+			break;
+		case FIELD_GAME_TIME:
+			append_integer(out, entry.total_game_time);
+			break;
+		case FIELD_GAMES:
+			append_integer(out, entry.total_games);
+			break;
+		case FIELD_WINS:
+			append_integer(out, entry.total_wins);
+			break;
+		case FIELD_TIES:
+			append_integer(out, total_tied_games);
+			break;
+		case FIELD_LOSSES:
+			append_integer(out, entry.total_games - total_tied_games - entry.total_wins);
+			break;
+		case FIELD_WIN_LOSS_RATIO:
+			append_ratio(out, get_ratio(static_cast<double>(entry.total_wins), static_cast<double>(entry.total_games - entry.total_wins)));
+			break;
+		case FIELD_BEACON_PLACEMENTS:
+			append_integer(out, entry.total_beacon_placements);
+			break;
+		case FIELD_BEACON_DISARMS:
+			append_integer(out, entry.total_beacon_disarms);
+			break;
+		case FIELD_PROXY_PLACEMENTS:
+			append_integer(out, entry.total_proxy_placements);
+			break;
+		case FIELD_PROXY_DISARMS:
+			append_integer(out, entry.total_proxy_disarms);
+			break;
+		case FIELD_GDI_GAMES:
+			append_integer(out, entry.total_gdi_games);
+			break;
+		case FIELD_GDI_WINS:
+			append_integer(out, entry.total_gdi_wins);
+			break;
+		case FIELD_GDI_TIES:
+			append_integer(out, entry.total_gdi_ties);
+			break;
+		case FIELD_GDI_LOSSES:
+			append_integer(out, entry.total_gdi_games - entry.total_gdi_wins - entry.total_gdi_ties);
+			break;
+		case FIELD_GDI_WIN_LOSS_RATIO:
+			append_ratio(out, get_ratio(static_cast<double>(entry.total_gdi_wins), static_cast<double>(entry.total_gdi_games - entry.total_gdi_wins - entry.total_gdi_ties)));
+			break;
+		case FIELD_GDI_SCORE:
+			append_integer(out, entry.total_gdi_score);
+			break;
+		case FIELD_GDI_SPM:
+			append_ratio(out, get_ratio(static_cast<double>(entry.total_gdi_score), static_cast<double>(entry.total_gdi_game_time) / 60.0));
+			break;
+		case FIELD_GDI_GAME_TIME:
+			append_integer(out, entry.total_gdi_game_time);
+			break;
+		case FIELD_GDI_BEACON_PLACEMENTS:
+			append_integer(out, entry.total_gdi_beacon_placements);
+			break;
+		case FIELD_GDI_BEACON_DISARMS:
+			append_integer(out, entry.total_gdi_beacon_disarms);
+			break;
+		case FIELD_GDI_PROXY_PLACEMENTS:
+			append_integer(out, entry.total_gdi_proxy_placements);
+			break;
+		case FIELD_GDI_PROXY_DISARMS:
+			append_integer(out, entry.total_gdi_proxy_disarms);
+			break;
+		case FIELD_GDI_KILLS:
+			append_integer(out, entry.total_gdi_kills);
+			break;
+		case FIELD_GDI_DEATHS:
+			append_integer(out, entry.total_gdi_deaths);
+			break;
+		case FIELD_GDI_VEHICLE_KILLS:
+			append_integer(out, entry.total_gdi_vehicle_kills);
+			break;
+		case FIELD_GDI_DEFENCE_KILLS:
+			append_integer(out, entry.total_gdi_defence_kills);
+			break;
+		case FIELD_GDI_BUILDING_KILLS:
+			append_integer(out, entry.total_gdi_building_kills);
+			break;
+		case FIELD_GDI_KDR:
+			append_ratio(out, get_ratio(static_cast<double>(entry.total_gdi_kills), static_cast<double>(entry.total_gdi_deaths)));
+			break;
+		case FIELD_GDI_HEADSHOTS:
+			append_integer(out, entry.total_gdi_headshots);
+			break;
+		case FIELD_GDI_HEADSHOT_KILL_RATIO:
+			append_ratio(out, get_ratio(static_cast<double>(entry.total_gdi_headshots), static_cast<double>(entry.total_gdi_kills)));
+			break;
+		case FIELD_NOD_GAMES:
+			append_integer(out, entry.total_nod_games);
+			break;
+		case FIELD_NOD_WINS:
+			append_integer(out, entry.total_nod_wins);
+			break;
+		case FIELD_NOD_TIES:
+			append_integer(out, entry.total_nod_ties);
+			break;
+		case FIELD_NOD_LOSSES:
+			append_integer(out, entry.total_nod_games - entry.total_nod_wins - entry.total_nod_ties);
+			break;
+		case FIELD_NOD_WIN_LOSS_RATIO:
+			append_ratio(out, get_ratio(static_cast<double>(entry.total_nod_wins), static_cast<double>(entry.total_nod_games - entry.total_nod_wins - entry.total_nod_ties)));
+			break;
+		case FIELD_NOD_SCORE:
+			append_integer(out, entry.total_nod_score);
+			break;
+		case FIELD_NOD_SPM:
+			append_ratio(out, get_ratio(static_cast<double>(entry.total_nod_score), static_cast<double>(entry.total_nod_game_time) / 60.0));
+			break;
+		case FIELD_NOD_GAME_TIME:
+			append_integer(out, entry.total_nod_game_time);
+			break;
+		case FIELD_NOD_BEACON_PLACEMENTS:
+			append_integer(out, entry.total_nod_beacon_placements);
+			break;
+		case FIELD_NOD_BEACON_DISARMS:
+			append_integer(out, entry.total_nod_beacon_disarms);
+			break;
+		case FIELD_NOD_PROXY_PLACEMENTS:
+			append_integer(out, entry.total_nod_proxy_placements);
+			break;
+		case FIELD_NOD_PROXY_DISARMS:
+			append_integer(out, entry.total_nod_proxy_disarms);
+			break;
+		case FIELD_NOD_KILLS:
+			append_integer(out, entry.total_nod_kills);
+			break;
+		case FIELD_NOD_DEATHS:
+			append_integer(out, entry.total_nod_deaths);
+			break;
+		case FIELD_NOD_VEHICLE_KILLS:
+			append_integer(out, entry.total_nod_vehicle_kills);
+			break;
+		case FIELD_NOD_DEFENCE_KILLS:
+			append_integer(out, entry.total_nod_defence_kills);
+			break;
+		case FIELD_NOD_BUILDING_KILLS:
+			append_integer(out, entry.total_nod_building_kills);
+			break;
+		case FIELD_NOD_KDR:
+			append_ratio(out, get_ratio(static_cast<double>(entry.total_nod_kills), static_cast<double>(entry.total_nod_deaths)));
+			break;
+		case FIELD_NOD_HEADSHOTS:
+			append_integer(out, entry.total_nod_headshots);
+			break;
+		case FIELD_NOD_HEADSHOT_KILL_RATIO:
+			append_ratio(out, get_ratio(static_cast<double>(entry.total_nod_headshots), static_cast<double>(entry.total_nod_kills)));
+			break;
+		case FIELD_VICTIM_SCORE:
+			append_integer(out, entry.top_score);
+			break;
+		case FIELD_VICTIM_KILLS:
+			append_integer(out, entry.top_kills);
+			break;
+		case FIELD_VICTIM_DEATHS:
+			append_integer(out, entry.most_deaths);
+			break;
+		case FIELD_VICTIM_HEADSHOTS:
+			append_integer(out, entry.top_headshot_kills);
+			break;
+		case FIELD_VICTIM_VEHICLE_KILLS:
+			append_integer(out, entry.top_vehicle_kills);
+			break;
+		case FIELD_VICTIM_BUILDING_KILLS:
+			append_integer(out, entry.top_building_kills);
+			break;
+		case FIELD_VICTIM_DEFENCE_KILLS:
+			append_integer(out, entry.top_defence_kills);
+			break;
+		case FIELD_VICTIM_CAPTURES:
+			append_integer(out, entry.top_captures);
+			break;
+		case FIELD_VICTIM_GAME_TIME:
+			append_integer(out, entry.top_game_time);
+			break;
+		case FIELD_VICTIM_BEACON_PLACEMENTS:
+			append_integer(out, entry.top_beacon_placements);
+			break;
+		case FIELD_VICTIM_BEACON_DISARMS:
+			append_integer(out, entry.top_beacon_disarms);
+			break;
+		case FIELD_VICTIM_PROXY_PLACEMENTS:
+			append_integer(out, entry.top_proxy_placements);
+			break;
+		case FIELD_VICTIM_PROXY_DISARMS:
+			append_integer(out, entry.top_proxy_disarms);
+			break;
+
+		default: // parameter
+			if (static_cast<size_t>(segment.field - FIELD_PARAMETER) < parameters.size())
+				out.concat(parameters.begin()[segment.field - FIELD_PARAMETER]);
+			break;
+		}
+	}
+}
+
 void TagsImp::sanitizeTags(Jupiter::StringType &fmt)
 {
 	/** Global tags */
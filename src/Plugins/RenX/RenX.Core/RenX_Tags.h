@@ -24,7 +24,10 @@
  * @brief Provides tag processing functions
  */
 
+#include <vector>
+#include <initializer_list>
 #include "Jupiter/String.hpp"
+#include "Jupiter/Reference_String.h"
 #include "RenX.h"
 #include "RenX_LadderDatabase.h"
 
@@ -426,6 +429,46 @@ namespace RenX
 	};
 
 	RENX_API extern Tags *tags;
+
+	/**
+	* @brief Ladder entry template, parsed once into literal segments and field references.
+	* Rendering an entry is a single pass over the segments, which formats each field straight into the output.
+	*/
+	class RENX_API LadderEntryTemplate
+	{
+	public:
+		/**
+		* @brief Parses a template.
+		*
+		* @param format Template to parse; this should already have been passed through sanitizeTags()
+		* @param parameter_tags Additional internal tags, which are replaced by the parameters passed to render()
+		*/
+		void compile(const Jupiter::ReadableString &format, std::initializer_list<const Jupiter::ReadableString *> parameter_tags = {});
+
+		/**
+		* @brief Renders the template for a ladder entry, and appends the result to a string.
+		* This produces the same output as processTags(), applied to the template after replacing the parameter tags.
+		*
+		* @param out String to append to
+		* @param entry Ladder entry to render
+		* @param rank Rank to display, or 0 to display the entry's own rank
+		* @param parameters Values for the parameter tags, in the order the tags were passed to compile()
+		*/
+		void render(Jupiter::StringType &out, const RenX::LadderDatabase::Entry &entry, size_t rank = 0, std::initializer_list<Jupiter::ReferenceString> parameters = {}) const;
+
+	private:
+		/** Literal text (field 0), an entry field, or a parameter */
+		struct Segment
+		{
+			uint16_t field;
+			size_t offset;
+			size_t length;
+		};
+
+		Jupiter::StringS text;
+		std::vector<Segment> segments;
+		std::string last_game_format; /** DateFormat and TimeFormat, as of compile() */
+	};
 }
 
 /** Helper macro for processing tags */
@@ -24,17 +24,25 @@ using namespace Jupiter::literals;
 bool RenX_Ladder_All_TimePlugin::initialize()
 {
 	// Load database
-	this->database.process_file(this->config.get("LadderDatabase"_jrs, "Ladder.db"_jrs));
-	this->database.setName(this->config.get("DatabaseName"_jrs, "All-Time"_jrs));
-	this->database.setOutputTimes(this->config.get<bool>("OutputTimes"_jrs, true));
+	this->database->load(static_cast<std::string>(this->config.get("LadderDatabase"_jrs, "Ladder.db"_jrs)));
+	this->database->setName(this->config.get("DatabaseName"_jrs, "All-Time"_jrs));
+	this->database->setOutputTimes(this->config.get<bool>("OutputTimes"_jrs, true));
+	this->database->setCheckpointInterval(this->config.get<size_t>("CheckpointInterval"_jrs, 50));
+	this->database->addSorts(this->config.get("Sorts"_jrs, "kills kdr spm wins winrate headshots gdi_score nod_score"_jrs));
 
 	// Force database to default, if desired
 	if (this->config.get<bool>("ForceDefault"_jrs, true))
-		RenX::default_ladder_database = &this->database;
+		RenX::setDefaultLadderDatabase(this->database);
 
 	return true;
 }
 
+RenX_Ladder_All_TimePlugin::~RenX_Ladder_All_TimePlugin()
+{
+	// web pages which are still being sent may hold handles to the database, so it may outlive the plugin
+	RenX::releaseLadderDatabase(this->database);
+}
+
 // Plugin instantiation and entry point.
 RenX_Ladder_All_TimePlugin pluginInstance;
 
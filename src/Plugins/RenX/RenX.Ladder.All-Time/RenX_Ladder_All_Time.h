@@ -28,9 +28,10 @@ class RenX_Ladder_All_TimePlugin : public RenX::Plugin
 {
 public:
 	virtual bool initialize() override;
+	~RenX_Ladder_All_TimePlugin();
 
 private:
-	RenX::LadderDatabase database;
+	RenX::LadderDatabase *database = new RenX::LadderDatabase(); /** Released when unloaded; see RenX::releaseLadderDatabase() */
 };
 
 #endif // _RENX_LADDER_ALL_TIME
\ No newline at end of file
@@ -0,0 +1,559 @@
+/**
+ * Copyright (C) 2020 Jessica James.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Written by Jessica James <jessica.aj@outlook.com>
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#if defined __linux__
+#include <unistd.h>
+#endif // __linux__
+#include "RenX_LadderDatabase.h"
+#include "RenX_Tags.h"
+#include "RenX_Ladder_Bench.h"
+
+using namespace Jupiter::literals;
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+	using Entry = RenX::LadderDatabase::Entry;
+
+	const uint64_t steamid_base = 0x0110000100000000ULL;
+
+	struct Percentiles
+	{
+		double p50 = 0.0;
+		double p90 = 0.0;
+		double p99 = 0.0;
+		double max = 0.0;
+	};
+
+	double elapsed_ms(Clock::time_point start)
+	{
+		return std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(Clock::now() - start).count();
+	}
+
+	double elapsed_us(Clock::time_point start)
+	{
+		return std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(Clock::now() - start).count();
+	}
+
+	double to_ms(Clock::duration duration)
+	{
+		return std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(duration).count();
+	}
+
+	Percentiles get_percentiles(std::vector<double> &samples)
+	{
+		Percentiles result;
+		if (samples.empty())
+			return result;
+
+		std::sort(samples.begin(), samples.end());
+		auto at = [&samples](double fraction)
+		{
+			return samples[std::min(samples.size() - 1, static_cast<size_t>(fraction * samples.size()))];
+		};
+
+		result.p50 = at(0.50);
+		result.p90 = at(0.90);
+		result.p99 = at(0.99);
+		result.max = samples.back();
+		return result;
+	}
+
+	size_t resident_memory()
+	{
+#if defined __linux__
+		unsigned long size, resident;
+		FILE *file = fopen("/proc/self/statm", "r");
+		if (file == nullptr)
+			return 0;
+
+		if (fscanf(file, "%lu %lu", &size, &resident) != 2)
+			resident = 0;
+		fclose(file);
+		return static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else // __linux__
+		return 0;
+#endif // __linux__
+	}
+
+	/** Process-wide peak resident memory, which includes anything the bot allocated before the benchmark */
+	size_t peak_resident_memory()
+	{
+#if defined __linux__
+		char line[256];
+		unsigned long peak = 0;
+		FILE *file = fopen("/proc/self/status", "r");
+		if (file == nullptr)
+			return 0;
+
+		while (fgets(line, sizeof(line), file) != nullptr)
+			if (sscanf(line, "VmHWM: %lu kB", &peak) == 1)
+				break;
+		fclose(file);
+		return static_cast<size_t>(peak) * 1024;
+#else // __linux__
+		return 0;
+#endif // __linux__
+	}
+
+	long file_size(const std::string &filename)
+	{
+		FILE *file = fopen(filename.c_str(), "rb");
+		if (file == nullptr)
+			return 0;
+
+		fseek(file, 0, SEEK_END);
+		long result = ftell(file);
+		fclose(file);
+		return result;
+	}
+
+	uint32_t random_ip(std::mt19937_64 &rng)
+	{
+		return static_cast<uint32_t>(rng() % 0xFFFFFFFEULL) + 1;
+	}
+
+	/** Generates a player's name from their index; the same player always has the same name */
+	Jupiter::StringS make_name(size_t index)
+	{
+		static const char *syllables[] = { "ka", "zor", "mi", "tek", "ra", "vos", "li", "gun", "shi", "dar", "nu", "rex", "ba", "tor", "el", "fyn" };
+		std::mt19937_64 rng(index);
+		Jupiter::StringS result;
+		size_t length = 2 + rng() % 3;
+		while (length-- != 0)
+			result += Jupiter::ReferenceString(syllables[rng() % (sizeof(syllables) / sizeof(*syllables))]);
+		result += Jupiter::StringS::Format("%u", static_cast<unsigned int>(rng() % 1000));
+		return result;
+	}
+
+	uint32_t poisson(std::mt19937_64 &rng, double mean)
+	{
+		if (mean <= 0.0)
+			return 0;
+		return std::poisson_distribution<uint32_t>(mean)(rng);
+	}
+
+	uint32_t binomial(std::mt19937_64 &rng, uint32_t trials, double probability)
+	{
+		return std::binomial_distribution<uint32_t>(trials, probability)(rng);
+	}
+
+	/** Generates the totals of a player with a long-tailed number of games, and per-game stats around a typical match */
+	Entry *make_entry(std::mt19937_64 &rng, size_t index, time_t now)
+	{
+		Entry *entry = new Entry();
+		uint32_t games = 1 + std::geometric_distribution<uint32_t>(0.05)(rng);
+		double skill = std::lognormal_distribution<double>(0.0, 0.5)(rng);
+
+		entry->steam_id = steamid_base + index;
+		entry->total_games = games;
+		entry->total_gdi_games = binomial(rng, games, 0.5);
+		entry->total_nod_games = games - entry->total_gdi_games;
+		entry->total_gdi_wins = binomial(rng, entry->total_gdi_games, std::min(0.9, 0.5 * skill));
+		entry->total_nod_wins = binomial(rng, entry->total_nod_games, std::min(0.9, 0.5 * skill));
+		entry->total_wins = entry->total_gdi_wins + entry->total_nod_wins;
+		entry->total_game_time = games * (900 + static_cast<uint32_t>(rng() % 1200));
+
+		entry->total_gdi_score = static_cast<uint64_t>(entry->total_gdi_games * 1000.0 * skill * std::lognormal_distribution<double>(0.0, 0.2)(rng));
+		entry->total_nod_score = static_cast<uint64_t>(entry->total_nod_games * 1000.0 * skill * std::lognormal_distribution<double>(0.0, 0.2)(rng));
+		entry->total_score = entry->total_gdi_score + entry->total_nod_score;
+
+		entry->total_gdi_kills = poisson(rng, entry->total_gdi_games * 10.0 * skill);
+		entry->total_nod_kills = poisson(rng, entry->total_nod_games * 10.0 * skill);
+		entry->total_kills = entry->total_gdi_kills + entry->total_nod_kills;
+		entry->total_gdi_deaths = poisson(rng, entry->total_gdi_games * 10.0 / skill);
+		entry->total_nod_deaths = poisson(rng, entry->total_nod_games * 10.0 / skill);
+		entry->total_deaths = entry->total_gdi_deaths + entry->total_nod_deaths;
+		entry->total_headshot_kills = binomial(rng, entry->total_kills, 0.2);
+		entry->total_vehicle_kills = poisson(rng, games * 2.0 * skill);
+		entry->total_building_kills = poisson(rng, games * 0.3 * skill);
+		entry->total_defence_kills = poisson(rng, games * 1.0);
+		entry->total_captures = poisson(rng, games * 0.5);
+		entry->total_beacon_placements = poisson(rng, games * 0.2);
+		entry->total_beacon_disarms = poisson(rng, games * 0.1);
+		entry->total_proxy_placements = poisson(rng, games * 1.0);
+		entry->total_proxy_disarms = poisson(rng, games * 0.5);
+
+		entry->top_score = static_cast<uint32_t>(2000.0 * skill);
+		entry->top_kills = poisson(rng, 20.0 * skill);
+		entry->most_deaths = poisson(rng, 20.0 / skill);
+		entry->top_game_time = 2100;
+
+		entry->most_recent_ip = random_ip(rng);
+		entry->last_game = now - static_cast<time_t>(rng() % (86400 * 30));
+		entry->most_recent_name = make_name(index);
+		return entry;
+	}
+
+	/** Generates a match; most players are already on the ladder, and the rest are new */
+	RenX::LadderDatabase::MatchRecord make_match(std::mt19937_64 &rng, size_t &player_count, size_t players_per_match, time_t now)
+	{
+		RenX::LadderDatabase::MatchRecord record;
+		record.server = nullptr;
+		record.time = now;
+		unsigned int outcome = rng() % 100;
+		record.winner = outcome < 49 ? RenX::TeamType::GDI : outcome < 98 ? RenX::TeamType::Nod : RenX::TeamType::None;
+		record.players.resize(players_per_match);
+
+		for (size_t index = 0; index != players_per_match; ++index)
+		{
+			RenX::LadderDatabase::PlayerRecord &player = record.players[index];
+			size_t player_index = rng() % 100 < 90 && player_count != 0 ? rng() % player_count : player_count++;
+			double skill = std::lognormal_distribution<double>(0.0, 0.5)(rng);
+
+			player.steamid = steamid_base + player_index;
+			player.score = 1000.0 * skill * std::lognormal_distribution<double>(0.0, 0.4)(rng);
+			player.kills = poisson(rng, 10.0 * skill);
+			player.deaths = poisson(rng, 10.0 / skill);
+			player.headshots = binomial(rng, player.kills, 0.2);
+			player.vehicle_kills = poisson(rng, 2.0 * skill);
+			player.building_kills = poisson(rng, 0.3 * skill);
+			player.defence_kills = poisson(rng, 1.0);
+			player.captures = poisson(rng, 0.5);
+			player.game_time = 300 + static_cast<uint32_t>(rng() % 1800);
+			player.beacon_placements = poisson(rng, 0.2);
+			player.beacon_disarms = poisson(rng, 0.1);
+			player.proxy_placements = poisson(rng, 1.0);
+			player.proxy_disarms = poisson(rng, 0.5);
+			player.ip32 = random_ip(rng);
+			player.team = index % 2 == 0 ? RenX::TeamType::GDI : RenX::TeamType::Nod;
+			player.name = make_name(player_index);
+		}
+
+		return record;
+	}
+
+	/** Mirrors RenX.Ladder.Web's leaderboard table, without the page around it */
+	size_t render_page(const RenX::LadderDatabase &database, const RenX::LadderEntryTemplate &row_template, size_t index, size_t count, const RenX::LadderDatabase::SortIndex *sort)
+	{
+		Jupiter::String result(count * 512);
+		Jupiter::ReferenceString database_name(database.getName());
+		for (; count != 0 && index < database.getEntries(); ++index, --count)
+			row_template.render(result, *database.getPlayerEntryByIndex(index, sort), sort != nullptr ? index + 1 : 0, { database_name });
+		return result.size();
+	}
+
+	void print_percentiles(const char *label, const Percentiles &value)
+	{
+		printf("%-24s %12.2f %12.2f %12.2f %12.2f" ENDL, label, value.p50, value.p90, value.p99, value.max);
+	}
+
+	void append_percentiles(std::string &json, const char *key, const Percentiles &value)
+	{
+		char buffer[256];
+		snprintf(buffer, sizeof(buffer), ",\"%s\":{\"p50\":%.3f,\"p90\":%.3f,\"p99\":%.3f,\"max\":%.3f}", key, value.p50, value.p90, value.p99, value.max);
+		json += buffer;
+	}
+}
+
+bool RenX_LadderBenchPlugin::initialize()
+{
+	RenX_LadderBenchPlugin::filename = static_cast<std::string>(this->config.get("BenchFile"_jrs, "Ladder.Bench.db"_jrs));
+	RenX_LadderBenchPlugin::sorts = this->config.get("Sorts"_jrs, "kills kdr spm wins winrate headshots gdi_score nod_score"_jrs);
+	RenX_LadderBenchPlugin::match_count = this->config.get<size_t>("MatchCount"_jrs, 50);
+	RenX_LadderBenchPlugin::checkpoint_interval = this->config.get<size_t>("CheckpointInterval"_jrs, 50);
+	RenX_LadderBenchPlugin::players_per_match = this->config.get<size_t>("PlayersPerMatch"_jrs, 64);
+	RenX_LadderBenchPlugin::lookup_count = this->config.get<size_t>("LookupCount"_jrs, 10000);
+	RenX_LadderBenchPlugin::entries_per_page = this->config.get<size_t>("EntriesPerPage"_jrs, 50);
+	RenX_LadderBenchPlugin::row_format = this->config.get("EntryTableRow"_jrs, R"html(<tr><td class="data-col-a">{RANK}</td><td class="data-col-b"><a href="profile?id={STEAM}&database={OBJECT}">{NAME}</a></td><td class="data-col-a">{SCORE}</td><td class="data-col-b">{SPM}</td><td class="data-col-a">{GAMES}</td><td class="data-col-b">{WINS}</td><td class="data-col-a">{LOSSES}</td><td class="data-col-b">{WLR}</td><td class="data-col-a">{KILLS}</td><td class="data-col-b">{DEATHS}</td><td class="data-col-a">{KDR}</td></tr>)html"_jrs);
+	RenX::sanitizeTags(RenX_LadderBenchPlugin::row_format);
+	RenX_LadderBenchPlugin::row_template.compile(RenX_LadderBenchPlugin::row_format, { &RenX::tags->INTERNAL_OBJECT_TAG });
+	return true;
+}
+
+bool RenX_LadderBenchPlugin::run(size_t entry_count)
+{
+	std::mt19937_64 rng(entry_count);
+	time_t now = time(nullptr);
+	Clock::time_point start;
+
+	// Generate the synthetic ladder; entries are appended in score order, so sort_entries() only verifies the order
+	std::vector<Entry *> batch;
+	batch.reserve(entry_count);
+	for (size_t index = 0; index != entry_count; ++index)
+		batch.push_back(make_entry(rng, index, now));
+	std::sort(batch.begin(), batch.end(), [](const Entry *lhs, const Entry *rhs)
+	{
+		return lhs->total_score > rhs->total_score;
+	});
+
+	double generate_ms, write_ms;
+	{
+		// unregistered, so that it is never listed or sent matches
+		std::unique_ptr<RenX::LadderDatabase> generated(new RenX::LadderDatabase("Bench"_jrs, false));
+		std::unique_lock<std::mutex> guard = generated->lock();
+		start = Clock::now();
+		for (Entry *entry : batch)
+			generated->append(entry);
+		generated->sort_entries();
+		generate_ms = elapsed_ms(start);
+
+		remove(RenX_LadderBenchPlugin::filename.c_str());
+		start = Clock::now();
+		generated->write(RenX_LadderBenchPlugin::filename);
+		write_ms = elapsed_ms(start);
+	}
+	batch.clear();
+	batch.shrink_to_fit();
+
+	long file_bytes = file_size(RenX_LadderBenchPlugin::filename);
+	if (file_bytes == 0)
+		return false;
+
+	// Load, as the ladder plugins do; the ladder is unregistered, so the live match log isn't replayed into it, and live matches aren't ingested into it
+	size_t resident_before = resident_memory();
+	std::unique_ptr<RenX::LadderDatabase> database(new RenX::LadderDatabase("Bench"_jrs, false));
+	start = Clock::now();
+	database->load(RenX_LadderBenchPlugin::filename);
+	double load_ms = elapsed_ms(start);
+	database->setCheckpointInterval(RenX_LadderBenchPlugin::checkpoint_interval);
+
+	start = Clock::now();
+	database->addSorts(RenX_LadderBenchPlugin::sorts);
+	double sort_index_ms = elapsed_ms(start);
+	size_t resident_after = resident_memory();
+	size_t resident_bytes = resident_after > resident_before ? resident_after - resident_before : 0;
+	size_t loaded_count = database->getEntries();
+
+	// Matches; each is logged, aggregated, and re-ranked as the ingest worker does, with a checkpoint every CheckpointInterval matches
+	std::string log_filename = RenX_LadderBenchPlugin::filename + ".matches";
+	remove(log_filename.c_str());
+	remove((log_filename + ".1").c_str());
+	std::vector<double> update_samples, sort_samples, write_samples;
+	size_t player_count = entry_count;
+	for (size_t index = 0; index != RenX_LadderBenchPlugin::match_count; ++index)
+	{
+		RenX::LadderDatabase::MatchRecord record = make_match(rng, player_count, RenX_LadderBenchPlugin::players_per_match, now);
+		start = Clock::now();
+		database->ingestMatch(record, log_filename);
+		update_samples.push_back(elapsed_ms(start));
+
+		std::pair<Clock::duration, Clock::duration> times;
+		{
+			std::unique_lock<std::mutex> guard = database->lock();
+			times = database->getLastUpdateTimes();
+		}
+		sort_samples.push_back(to_ms(times.first));
+		write_samples.push_back(to_ms(times.second));
+	}
+	Percentiles update_ms = get_percentiles(update_samples);
+	Percentiles update_sort_ms = get_percentiles(sort_samples);
+	Percentiles update_write_ms = get_percentiles(write_samples);
+
+	std::unique_lock<std::mutex> guard = database->lock();
+	size_t ladder_count = database->getEntries();
+	const RenX::LadderDatabase::SortIndex *sort = database->getSort(Jupiter::ReferenceString::getWord(RenX_LadderBenchPlugin::sorts, 0, WHITESPACE));
+	std::vector<double> samples;
+	size_t checksum = 0;
+
+	// Rank lookups, by score and by the first configured secondary ordering
+	samples.clear();
+	for (size_t index = 0; index != RenX_LadderBenchPlugin::lookup_count && ladder_count != 0; ++index)
+	{
+		uint64_t steam_id = steamid_base + rng() % player_count;
+		start = Clock::now();
+		checksum += database->getPlayerEntryAndIndex(steam_id).second;
+		samples.push_back(elapsed_us(start));
+	}
+	Percentiles rank_us = get_percentiles(samples);
+
+	samples.clear();
+	for (size_t index = 0; index != RenX_LadderBenchPlugin::lookup_count && ladder_count != 0 && sort != nullptr; ++index)
+	{
+		Entry *entry = database->getPlayerEntryByIndex(rng() % ladder_count);
+		start = Clock::now();
+		checksum += database->getRank(*entry, sort);
+		samples.push_back(elapsed_us(start));
+	}
+	Percentiles sort_rank_us = get_percentiles(samples);
+
+	// Part-name searches, for 4 characters from the middle of a random player's name
+	size_t search_results = 0;
+	samples.clear();
+	for (size_t index = 0; index != RenX_LadderBenchPlugin::lookup_count && ladder_count != 0; ++index)
+	{
+		const Jupiter::ReadableString &name = database->getPlayerEntryByIndex(rng() % ladder_count)->most_recent_name;
+		size_t offset = name.size() > 4 ? rng() % (name.size() - 4) : 0;
+		Jupiter::ReferenceString query(name.ptr() + offset, std::min<size_t>(4, name.size()));
+		start = Clock::now();
+		search_results += database->findPlayerEntriesByPartName(query, 0).size();
+		samples.push_back(elapsed_us(start));
+	}
+	Percentiles search_us = get_percentiles(samples);
+	double average_search_results = samples.empty() ? 0.0 : static_cast<double>(search_results) / samples.size();
+
+	// Page rendering, as RenX.Ladder.Web renders leaderboard tables
+	size_t page_samples = std::max<size_t>(10, RenX_LadderBenchPlugin::lookup_count / 100);
+	size_t page_count = ladder_count / std::max<size_t>(1, RenX_LadderBenchPlugin::entries_per_page) + 1;
+	samples.clear();
+	for (size_t index = 0; index != page_samples && ladder_count != 0; ++index)
+	{
+		size_t page_start = rng() % page_count * RenX_LadderBenchPlugin::entries_per_page;
+		start = Clock::now();
+		checksum += render_page(*database, RenX_LadderBenchPlugin::row_template, page_start, RenX_LadderBenchPlugin::entries_per_page, nullptr);
+		samples.push_back(elapsed_us(start));
+	}
+	Percentiles page_us = get_percentiles(samples);
+
+	samples.clear();
+	for (size_t index = 0; index != page_samples && ladder_count != 0 && sort != nullptr; ++index)
+	{
+		size_t page_start = rng() % page_count * RenX_LadderBenchPlugin::entries_per_page;
+		start = Clock::now();
+		checksum += render_page(*database, RenX_LadderBenchPlugin::row_template, page_start, RenX_LadderBenchPlugin::entries_per_page, sort);
+		samples.push_back(elapsed_us(start));
+	}
+	Percentiles sorted_page_us = get_percentiles(samples);
+	guard.unlock();
+
+	size_t peak_resident_bytes = peak_resident_memory();
+
+	// Table
+	printf(ENDL "Ladder database benchmark: %zu entries (%zu loaded, %zu after %zu matches of %zu players; checkpoint every %zu matches)" ENDL, entry_count, loaded_count, ladder_count, RenX_LadderBenchPlugin::match_count, RenX_LadderBenchPlugin::players_per_match, RenX_LadderBenchPlugin::checkpoint_interval);
+	printf("%-24s %12s" ENDL, "Metric", "Value");
+	printf("%-24s %12.2f ms" ENDL, "Generate and sort", generate_ms);
+	printf("%-24s %12.2f ms (%ld bytes)" ENDL, "Write", write_ms, file_bytes);
+	printf("%-24s %12.2f ms" ENDL, "Load", load_ms);
+	printf("%-24s %12.2f ms" ENDL, "Build sort indexes", sort_index_ms);
+	printf("%-24s %12.2f MiB" ENDL, "Resident memory", resident_bytes / 1048576.0);
+	printf("%-24s %12.2f MiB" ENDL, "Peak process memory", peak_resident_bytes / 1048576.0);
+	printf("%-24s %12s %12s %12s %12s" ENDL, "Match update (ms)", "p50", "p90", "p99", "max");
+	print_percentiles("Total", update_ms);
+	print_percentiles("Sort", update_sort_ms);
+	print_percentiles("Write", update_write_ms);
+	printf("%-24s %12s %12s %12s %12s" ENDL, "Lookup (us)", "p50", "p90", "p99", "max");
+	print_percentiles("Rank", rank_us);
+	print_percentiles("Sorted rank", sort_rank_us);
+	print_percentiles("Name search", search_us);
+	print_percentiles("Page render", page_us);
+	print_percentiles("Sorted page render", sorted_page_us);
+	printf("Name searches averaged %.1f results (checksum %zu)" ENDL, average_search_results, checksum);
+
+	// JSON
+	char buffer[512];
+	std::string json;
+	snprintf(buffer, sizeof(buffer), "{\"entries\":%zu,\"loaded\":%zu,\"final_entries\":%zu,\"matches\":%zu,\"players_per_match\":%zu,\"checkpoint_interval\":%zu,\"generate_ms\":%.3f,\"write_ms\":%.3f,\"file_bytes\":%ld,\"load_ms\":%.3f,\"sort_index_ms\":%.3f,\"resident_bytes\":%zu,\"peak_resident_bytes\":%zu,\"search_results_avg\":%.3f",
+		entry_count, loaded_count, ladder_count, RenX_LadderBenchPlugin::match_count, RenX_LadderBenchPlugin::players_per_match, RenX_LadderBenchPlugin::checkpoint_interval, generate_ms, write_ms, file_bytes, load_ms, sort_index_ms, resident_bytes, peak_resident_bytes, average_search_results);
+	json = buffer;
+	append_percentiles(json, "update_ms", update_ms);
+	append_percentiles(json, "update_sort_ms", update_sort_ms);
+	append_percentiles(json, "update_write_ms", update_write_ms);
+	append_percentiles(json, "rank_us", rank_us);
+	append_percentiles(json, "sort_rank_us", sort_rank_us);
+	append_percentiles(json, "search_us", search_us);
+	append_percentiles(json, "page_us", page_us);
+	append_percentiles(json, "sorted_page_us", sorted_page_us);
+	json += '}';
+	puts(json.c_str());
+
+	database.reset();
+	remove(RenX_LadderBenchPlugin::filename.c_str());
+	remove(log_filename.c_str());
+	remove((log_filename + ".1").c_str());
+	return true;
+}
+
+bool RenX_LadderBenchPlugin::start(std::vector<size_t> sizes)
+{
+	if (RenX_LadderBenchPlugin::running)
+		return false;
+
+	if (RenX_LadderBenchPlugin::worker.joinable())
+		RenX_LadderBenchPlugin::worker.join();
+
+	// the benchmark takes seconds to minutes, so it runs beside the event loop rather than on it
+	RenX_LadderBenchPlugin::running = true;
+	RenX_LadderBenchPlugin::worker = std::thread([this](std::vector<size_t> sizes)
+	{
+		for (size_t size : sizes)
+			if (RenX_LadderBenchPlugin::run(size) == false)
+			{
+				printf("Error: Unable to create benchmark database: %s" ENDL, RenX_LadderBenchPlugin::filename.c_str());
+				break;
+			}
+
+		RenX_LadderBenchPlugin::running = false;
+	}, std::move(sizes));
+	return true;
+}
+
+RenX_LadderBenchPlugin::~RenX_LadderBenchPlugin()
+{
+	if (RenX_LadderBenchPlugin::worker.joinable())
+		RenX_LadderBenchPlugin::worker.join();
+}
+
+const std::string &RenX_LadderBenchPlugin::getFileName() const
+{
+	return RenX_LadderBenchPlugin::filename;
+}
+
+// Plugin instantiation and entry point.
+RenX_LadderBenchPlugin pluginInstance;
+
+extern "C" JUPITER_EXPORT Jupiter::Plugin *getPlugin()
+{
+	return &pluginInstance;
+}
+
+/** Console Commands */
+
+// LadderBench Console Command
+
+LadderBenchConsoleCommand::LadderBenchConsoleCommand()
+{
+	this->addTrigger(STRING_LITERAL_AS_REFERENCE("ladderbench"));
+}
+
+void LadderBenchConsoleCommand::trigger(const Jupiter::ReadableString &parameters)
+{
+	std::vector<size_t> sizes;
+	size_t words = parameters.wordCount(WHITESPACE);
+	for (size_t index = 0; index != words; ++index)
+	{
+		size_t size = static_cast<size_t>(Jupiter::ReferenceString::getWord(parameters, index, WHITESPACE).asUnsignedLongLong());
+		if (size != 0)
+			sizes.push_back(size);
+	}
+
+	if (sizes.empty())
+		sizes = { 10000, 100000, 1000000 };
+
+	if (pluginInstance.start(std::move(sizes)))
+		puts("Ladder benchmark started; results are printed as each size completes.");
+	else
+		puts("Error: A ladder benchmark is already running.");
+}
+
+const Jupiter::ReadableString &LadderBenchConsoleCommand::getHelp(const Jupiter::ReadableString &)
+{
+	static STRING_LITERAL_AS_NAMED_REFERENCE(defaultHelp, "Benchmarks the ladder database against generated ladders of each size (default: 10000 100000 1000000; up to 2000000 is typical). Syntax: ladderbench [entries...]");
+	return defaultHelp;
+}
+
+CONSOLE_COMMAND_INIT(LadderBenchConsoleCommand)
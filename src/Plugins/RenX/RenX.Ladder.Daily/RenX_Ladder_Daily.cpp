@@ -22,36 +22,81 @@
 
 using namespace Jupiter::literals;
 
+/** Periods are UTC days, counted from the epoch */
+static int64_t get_period(time_t in_time)
+{
+	return static_cast<int64_t>(in_time) / 86400;
+}
+
+static void get_label(int64_t period, char (&label)[16])
+{
+	time_t period_start = static_cast<time_t>(period * 86400);
+	strftime(label, sizeof(label), "%Y-%m-%d", gmtime(&period_start));
+}
+
 bool RenX_Ladder_Daily_TimePlugin::initialize()
 {
 	time_t current_time = time(0);
 	// Load database
-	this->database.process_file(this->config.get("LadderDatabase"_jrs, "Ladder.Daily.db"_jrs));
-	this->database.setName(this->config.get("DatabaseName"_jrs, "Daily"_jrs));
-	this->database.setOutputTimes(this->config.get<bool>("OutputTimes"_jrs, false));
+	this->database->load(static_cast<std::string>(this->config.get("LadderDatabase"_jrs, "Ladder.Daily.db"_jrs)));
+	this->database->setName(this->config.get("DatabaseName"_jrs, "Daily"_jrs));
+	this->database->setOutputTimes(this->config.get<bool>("OutputTimes"_jrs, false));
+	this->database->setCheckpointInterval(this->config.get<size_t>("CheckpointInterval"_jrs, 50));
+	this->database->addSorts(this->config.get("Sorts"_jrs, "kills kdr spm wins winrate headshots gdi_score nod_score"_jrs));
 
-	this->last_sorted_day = gmtime(&current_time)->tm_wday;
-	this->database.OnPreUpdateLadder = OnPreUpdateLadder;
+	// a ladder left over from an earlier day is archived under that day
+	time_t last_game_time;
+	{
+		std::unique_lock<std::mutex> guard = this->database->lock();
+		last_game_time = this->database->getLastGameTime();
+	}
+	this->period = get_period(last_game_time == 0 ? current_time : last_game_time);
+	this->checkRollover(current_time);
 
 	// Force database to default, if desired
 	if (this->config.get<bool>("ForceDefault"_jrs, false))
-		RenX::default_ladder_database = &this->database;
+		RenX::setDefaultLadderDatabase(this->database);
 
 	return true;
 }
 
-// Plugin instantiation and entry point.
-RenX_Ladder_Daily_TimePlugin pluginInstance;
+RenX_Ladder_Daily_TimePlugin::~RenX_Ladder_Daily_TimePlugin()
+{
+	// web pages which are still being sent may hold handles to the database, so it may outlive the plugin
+	RenX::releaseLadderDatabase(this->database);
+}
 
-void OnPreUpdateLadder(RenX::LadderDatabase &database, RenX::Server &, const RenX::TeamType &)
+int RenX_Ladder_Daily_TimePlugin::think()
 {
-	time_t current_time = time(0);
-	tm *tm_ptr = gmtime(&current_time);
-	if (pluginInstance.last_sorted_day != tm_ptr->tm_wday)
-		database.erase();
-	pluginInstance.last_sorted_day = tm_ptr->tm_wday;
+	// the period is checked at most once per second
+	time_t current_time = time(nullptr);
+	if (current_time != this->last_check_time)
+	{
+		this->last_check_time = current_time;
+		this->checkRollover(current_time);
+	}
+
+	return Jupiter::Plugin::think();
 }
 
+void RenX_Ladder_Daily_TimePlugin::checkRollover(time_t current_time)
+{
+	int64_t current_period = get_period(current_time);
+	if (current_period != this->period)
+	{
+		// matches which ended before the rollover belong to the finished day
+		RenX::LadderDatabase::waitForUpdates();
+
+		char label[16];
+		get_label(this->period, label);
+		this->database->archive(Jupiter::ReferenceString(label));
+		this->period = current_period;
+	}
+}
+
+// Plugin instantiation and entry point.
+RenX_Ladder_Daily_TimePlugin pluginInstance;
+
 extern "C" JUPITER_EXPORT Jupiter::Plugin *getPlugin()
 {
 	return &pluginInstance;
@@ -28,12 +28,21 @@ class RenX_Ladder_Daily_TimePlugin : public RenX::Plugin
 {
 public:
 	virtual bool initialize() override;
+	~RenX_Ladder_Daily_TimePlugin();
+
+	int think() override;
+
+	/**
+	* @brief Archives the ladder and starts a new one, if the ladder's day has ended.
+	*
+	* @param current_time Current time
+	*/
+	void checkRollover(time_t current_time);
 
-	int last_sorted_day = 0;
 private:
-	RenX::LadderDatabase database;
+	int64_t period = 0;
+	time_t last_check_time = 0;
+	RenX::LadderDatabase *database = new RenX::LadderDatabase(); /** Released when unloaded; see RenX::releaseLadderDatabase() */
 };
 
-void OnPreUpdateLadder(RenX::LadderDatabase &database, RenX::Server &server, const RenX::TeamType &team);
-
 #endif // _RENX_LADDER_ALL_TIME
\ No newline at end of file
@@ -16,6 +16,9 @@
  * Written by Jessica James <jessica.aj@outlook.com>
  */
 
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
 #include "Jupiter/IRC_Client.h"
 #include "Jupiter/HTTP.h"
 #include "Jupiter/HTTP_QueryString.h"
@@ -25,52 +28,76 @@
 
 using namespace Jupiter::literals;
 
+static STRING_LITERAL_AS_NAMED_REFERENCE(CONTENT_TYPE_APPLICATION_JSON, "application/json");
+
 bool RenX_Ladder_WebPlugin::initialize()
 {
 	RenX_Ladder_WebPlugin::ladder_page_name = this->config.get("LadderPageName"_jrs, ""_jrs);
 	RenX_Ladder_WebPlugin::search_page_name = this->config.get("SearchPageName"_jrs, "search"_jrs);
 	RenX_Ladder_WebPlugin::profile_page_name = this->config.get("ProfilePageName"_jrs, "profile"_jrs);
+	RenX_Ladder_WebPlugin::ladder_json_page_name = this->config.get("JsonLadderPageName"_jrs, "ladder.json"_jrs);
+	RenX_Ladder_WebPlugin::search_json_page_name = this->config.get("JsonSearchPageName"_jrs, "search.json"_jrs);
+	RenX_Ladder_WebPlugin::profile_json_page_name = this->config.get("JsonProfilePageName"_jrs, "profile.json"_jrs);
 	RenX_Ladder_WebPlugin::web_hostname = this->config.get("Hostname"_jrs, ""_jrs);
 	RenX_Ladder_WebPlugin::web_path = this->config.get("Path"_jrs, "/"_jrs);
 
 	this->init();
 
-	/** Initialize content */
-	Jupiter::HTTP::Server &server = getHTTPServer();
+	/** Initialize content; pages lock their database, and may be served from worker threads */
+	HTTPServerPlugin &server = getHTTPServerPlugin();
 
-	Jupiter::HTTP::Server::Content *content = new Jupiter::HTTP::Server::Content(RenX_Ladder_WebPlugin::ladder_page_name, handle_ladder_page);
+	Jupiter::HTTP::Server::Content *content = new HTTPServerPlugin::Page(RenX_Ladder_WebPlugin::ladder_page_name, handle_ladder_page);
 	content->language = &Jupiter::HTTP::Content::Language::ENGLISH;
 	content->type = &Jupiter::HTTP::Content::Type::Text::HTML;
 	content->charset = &Jupiter::HTTP::Content::Type::Text::Charset::UTF8;
-	server.hook(RenX_Ladder_WebPlugin::web_hostname, RenX_Ladder_WebPlugin::web_path, content);
+	server.hook(RenX_Ladder_WebPlugin::web_hostname, RenX_Ladder_WebPlugin::web_path, content, true);
 
-	content = new Jupiter::HTTP::Server::Content(RenX_Ladder_WebPlugin::search_page_name, handle_search_page);
+	content = new HTTPServerPlugin::Page(RenX_Ladder_WebPlugin::search_page_name, handle_search_page);
 	content->language = &Jupiter::HTTP::Content::Language::ENGLISH;
 	content->type = &Jupiter::HTTP::Content::Type::Text::HTML;
 	content->charset = &Jupiter::HTTP::Content::Type::Text::Charset::UTF8;
-	server.hook(RenX_Ladder_WebPlugin::web_hostname, RenX_Ladder_WebPlugin::web_path, content);
+	server.hook(RenX_Ladder_WebPlugin::web_hostname, RenX_Ladder_WebPlugin::web_path, content, true);
 
-	content = new Jupiter::HTTP::Server::Content(RenX_Ladder_WebPlugin::profile_page_name, handle_profile_page);
+	content = new HTTPServerPlugin::Page(RenX_Ladder_WebPlugin::profile_page_name, handle_profile_page);
 	content->language = &Jupiter::HTTP::Content::Language::ENGLISH;
 	content->type = &Jupiter::HTTP::Content::Type::Text::HTML;
 	content->charset = &Jupiter::HTTP::Content::Type::Text::Charset::UTF8;
-	server.hook(RenX_Ladder_WebPlugin::web_hostname, RenX_Ladder_WebPlugin::web_path, content);
+	server.hook(RenX_Ladder_WebPlugin::web_hostname, RenX_Ladder_WebPlugin::web_path, content, true);
+
+	content = new HTTPServerPlugin::Page(RenX_Ladder_WebPlugin::ladder_json_page_name, handle_ladder_json);
+	content->type = &CONTENT_TYPE_APPLICATION_JSON;
+	content->charset = &Jupiter::HTTP::Content::Type::Text::Charset::UTF8;
+	server.hook(RenX_Ladder_WebPlugin::web_hostname, RenX_Ladder_WebPlugin::web_path, content, true);
+
+	content = new HTTPServerPlugin::Page(RenX_Ladder_WebPlugin::search_json_page_name, handle_search_json);
+	content->type = &CONTENT_TYPE_APPLICATION_JSON;
+	content->charset = &Jupiter::HTTP::Content::Type::Text::Charset::UTF8;
+	server.hook(RenX_Ladder_WebPlugin::web_hostname, RenX_Ladder_WebPlugin::web_path, content, true);
+
+	content = new HTTPServerPlugin::Page(RenX_Ladder_WebPlugin::profile_json_page_name, handle_profile_json);
+	content->type = &CONTENT_TYPE_APPLICATION_JSON;
+	content->charset = &Jupiter::HTTP::Content::Type::Text::Charset::UTF8;
+	server.hook(RenX_Ladder_WebPlugin::web_hostname, RenX_Ladder_WebPlugin::web_path, content, true);
 
 	return true;
 }
 
 RenX_Ladder_WebPlugin::~RenX_Ladder_WebPlugin()
 {
-	Jupiter::HTTP::Server &server = getHTTPServer();
+	HTTPServerPlugin &server = getHTTPServerPlugin();
 	server.remove(RenX_Ladder_WebPlugin::web_hostname, RenX_Ladder_WebPlugin::web_path, RenX_Ladder_WebPlugin::ladder_page_name);
 	server.remove(RenX_Ladder_WebPlugin::web_hostname, RenX_Ladder_WebPlugin::web_path, RenX_Ladder_WebPlugin::search_page_name);
 	server.remove(RenX_Ladder_WebPlugin::web_hostname, RenX_Ladder_WebPlugin::web_path, RenX_Ladder_WebPlugin::profile_page_name);
+	server.remove(RenX_Ladder_WebPlugin::web_hostname, RenX_Ladder_WebPlugin::web_path, RenX_Ladder_WebPlugin::ladder_json_page_name);
+	server.remove(RenX_Ladder_WebPlugin::web_hostname, RenX_Ladder_WebPlugin::web_path, RenX_Ladder_WebPlugin::search_json_page_name);
+	server.remove(RenX_Ladder_WebPlugin::web_hostname, RenX_Ladder_WebPlugin::web_path, RenX_Ladder_WebPlugin::profile_json_page_name);
 }
 
 void RenX_Ladder_WebPlugin::init()
 {
 	FILE *file;
 	int chr;
+	std::lock_guard<std::mutex> template_guard(RenX_Ladder_WebPlugin::template_mutex);
 
 	RenX_Ladder_WebPlugin::web_header_filename = static_cast<std::string>(this->config.get("HeaderFilename"_jrs, "RenX.Ladder.Web.Header.html"_jrs));
 	RenX_Ladder_WebPlugin::web_footer_filename = static_cast<std::string>(this->config.get("FooterFilename"_jrs, "RenX.Ladder.Web.Footer.html"_jrs));
@@ -79,6 +106,10 @@ void RenX_Ladder_WebPlugin::init()
 	RenX_Ladder_WebPlugin::web_ladder_table_footer_filename = static_cast<std::string>(this->config.get("LadderTableFooterFilename"_jrs, "RenX.Ladder.Web.Ladder.Table.Footer.html"_jrs));
 	RenX_Ladder_WebPlugin::entries_per_page = this->config.get<size_t>("EntriesPerPage"_jrs, 50);
 	RenX_Ladder_WebPlugin::min_search_name_length = this->config.get<size_t>("MinSearchNameLength"_jrs, 3);
+	RenX_Ladder_WebPlugin::archive_cache_size = this->config.get<size_t>("ArchiveCacheSize"_jrs, 4);
+	RenX_Ladder_WebPlugin::response_cache_size = this->config.get<size_t>("ResponseCacheSize"_jrs, 256);
+	RenX_Ladder_WebPlugin::max_json_entries = this->config.get<size_t>("MaxJsonEntries"_jrs, 500);
+	RenX_Ladder_WebPlugin::max_cached_entries = this->config.get<size_t>("MaxCachedEntries"_jrs, 500);
 
 	RenX_Ladder_WebPlugin::entry_table_row = this->config.get("EntryTableRow"_jrs, R"html(<tr><td class="data-col-a">{RANK}</td><td class="data-col-b"><a href="profile?id={STEAM}&database={OBJECT}">{NAME}</a></td><td class="data-col-a">{SCORE}</td><td class="data-col-b">{SPM}</td><td class="data-col-a">{GAMES}</td><td class="data-col-b">{WINS}</td><td class="data-col-a">{LOSSES}</td><td class="data-col-b">{WLR}</td><td class="data-col-a">{KILLS}</td><td class="data-col-b">{DEATHS}</td><td class="data-col-a">{KDR}</td></tr>)html"_jrs);
 	RenX_Ladder_WebPlugin::entry_profile_previous = this->config.get("EntryProfilePrevious"_jrs, R"html(<form class="profile-previous"><input type="hidden" name="database" value="{OBJECT}"/><input type="hidden" name="id" value="{WEAPON}"/><input class="profile-previous-submit" type="submit" value="&#x21A9 Previous" /></form>)html"_jrs);
@@ -154,6 +185,21 @@ void RenX_Ladder_WebPlugin::init()
 			fclose(file);
 		}
 	}
+
+	/** Compile entry templates */
+	RenX_Ladder_WebPlugin::entry_table_row_template.compile(RenX_Ladder_WebPlugin::entry_table_row, { &RenX::tags->INTERNAL_OBJECT_TAG });
+	RenX_Ladder_WebPlugin::entry_profile_template.compile(RenX_Ladder_WebPlugin::entry_profile);
+	RenX_Ladder_WebPlugin::entry_profile_previous_template.compile(RenX_Ladder_WebPlugin::entry_profile_previous, { &RenX::tags->INTERNAL_OBJECT_TAG, &RenX::tags->INTERNAL_WEAPON_TAG });
+	RenX_Ladder_WebPlugin::entry_profile_next_template.compile(RenX_Ladder_WebPlugin::entry_profile_next, { &RenX::tags->INTERNAL_OBJECT_TAG, &RenX::tags->INTERNAL_VICTIM_STEAM_TAG });
+
+	// pages generated from the old templates are stale; the generation starts from the load time so that ETags differ across restarts
+	std::lock_guard<std::mutex> guard(RenX_Ladder_WebPlugin::response_cache_mutex);
+	if (RenX_Ladder_WebPlugin::response_cache_generation == 0)
+		RenX_Ladder_WebPlugin::response_cache_generation = static_cast<uint64_t>(time(nullptr));
+	else
+		++RenX_Ladder_WebPlugin::response_cache_generation;
+	RenX_Ladder_WebPlugin::response_cache.clear();
+	RenX_Ladder_WebPlugin::response_cache_index.clear();
 }
 
 int RenX_Ladder_WebPlugin::OnRehash()
@@ -166,17 +212,59 @@ int RenX_Ladder_WebPlugin::OnRehash()
 // Plugin instantiation and entry point.
 RenX_Ladder_WebPlugin pluginInstance;
 
+/** Value of the "database" parameter which refers to a ladder; empty for the default database */
+Jupiter::ReferenceString get_database_param(const RenX::LadderDatabase *db)
+{
+	if (db == nullptr || RenX::isDefaultLadderDatabase(db))
+		return Jupiter::ReferenceString::empty;
+	return db->getName();
+}
+
+Jupiter::ReferenceString get_database_param(const RenX::LadderArchive *archive)
+{
+	return archive->getName();
+}
+
+/** Appends text to a page, escaping characters which are special in HTML */
+void append_html_escaped(Jupiter::String &out, const Jupiter::ReadableString &text)
+{
+	for (size_t index = 0; index != text.size(); ++index)
+	{
+		switch (text.get(index))
+		{
+		case '&':
+			out += "&amp;"_jrs;
+			break;
+		case '<':
+			out += "&lt;"_jrs;
+			break;
+		case '>':
+			out += "&gt;"_jrs;
+			break;
+		case '"':
+			out += "&quot;"_jrs;
+			break;
+		case '\'':
+			out += "&#39;"_jrs;
+			break;
+		default:
+			out += text.get(index);
+			break;
+		}
+	}
+}
+
 /** Search bar */
-Jupiter::String generate_search(RenX::LadderDatabase *db)
+Jupiter::String generate_search(const Jupiter::ReadableString &database_param)
 {
 	Jupiter::String result(256);
 
 	result = R"database-search(<form action="search" method="get" class="leaderboard-search"><input type="text" class="leaderboard-search-input" name="name" size="30" placeholder="Player name" value=""/>)database-search"_jrs;
 
-	if (db != nullptr && db != RenX::default_ladder_database)
+	if (database_param.isNotEmpty())
 	{
 		result += R"database-search(<input type="hidden" name="database" value=")database-search"_jrs;
-		result += db->getName();
+		result += database_param;
 		result += R"database-search("/>)database-search"_jrs;
 	}
 	result += R"database-search(<input type="submit"  class="leaderboard-button" value="Search"/></form>)database-search"_jrs;
@@ -184,9 +272,9 @@ Jupiter::String generate_search(RenX::LadderDatabase *db)
 }
 
 /** Database selector */
-Jupiter::String generate_database_selector(RenX::LadderDatabase *db, const Jupiter::HTTP::HTMLFormResponse::TableType &query_params)
+Jupiter::String generate_database_selector(RenX::LadderDatabase *db, const RenX::LadderArchive *archive, const Jupiter::HTTP::HTMLFormResponse::TableType &query_params)
 {
-	RenX::LadderDatabase *db_ptr;
+	std::vector<std::shared_ptr<RenX::LadderDatabase>> databases = RenX::acquireLadderDatabases();
 	Jupiter::String result(256);
 
 	result = R"database-select(<form method="get" class="database-select-form"><select name="database" class="database-select">)database-select"_jrs;
@@ -198,19 +286,17 @@ Jupiter::String generate_database_selector(RenX::LadderDatabase *db, const Jupit
 		result += db->getName();
 		result += "</option>"_jrs;
 	}
-	else if (RenX::ladder_databases.size() == 0)
+	else if (databases.empty())
 		return Jupiter::String::empty;
 
-	for (size_t index = 0; index != RenX::ladder_databases.size(); ++index)
+	for (auto &database : databases)
 	{
-		db_ptr = RenX::ladder_databases.get(index);
-		if (db_ptr != db)
+		if (database.get() != db)
 		{
-			db_ptr = RenX::ladder_databases.get(index);
 			result += "<option value=\""_jrs;
-			result += db_ptr->getName();
+			result += database->getName();
 			result += "\">"_jrs;
-			result += db_ptr->getName();
+			result += database->getName();
 			result += "</option>"_jrs;
 		}
 	}
@@ -219,19 +305,51 @@ Jupiter::String generate_database_selector(RenX::LadderDatabase *db, const Jupit
 	if (value != query_params.end())
 	{
 		result += R"html(<input type="hidden" name="id" value=")html"_jrs;
-		result += value->second;
+		append_html_escaped(result, value->second);
 		result += R"html("/>)html"_jrs;
 	}
 
 	result += R"database-select(</select><input type="submit" class="leaderboard-button" value="Go"/></form>)database-select"_jrs;
+
+	// archived periods of the selected database, newest first
+	if (db != nullptr && db->getArchives().empty() == false)
+	{
+		result += R"archive-select(<form method="get" class="archive-select-form"><select name="database" class="archive-select"><option value=")archive-select"_jrs;
+		result += db->getName();
+		result += "\">Current</option>"_jrs;
+
+		const std::vector<Jupiter::StringS> &archives = db->getArchives();
+		for (auto itr = archives.rbegin(); itr != archives.rend(); ++itr)
+		{
+			result += "<option value=\""_jrs;
+			result += db->getName();
+			result += '/';
+			result += *itr;
+			if (archive != nullptr && archive->getLabel().equals(*itr))
+				result += "\" selected>"_jrs;
+			else
+				result += "\">"_jrs;
+			result += *itr;
+			result += "</option>"_jrs;
+		}
+
+		if (value != query_params.end())
+		{
+			result += R"html(<input type="hidden" name="id" value=")html"_jrs;
+			append_html_escaped(result, value->second);
+			result += R"html("/>)html"_jrs;
+		}
+
+		result += R"archive-select(</select><input type="submit" class="leaderboard-button" value="Go"/></form>)archive-select"_jrs;
+	}
+
 	return result;
 }
 
 /** Page buttons */
-Jupiter::String generate_page_buttons(RenX::LadderDatabase *db)
+Jupiter::String generate_page_buttons(size_t entry_count, const Jupiter::ReadableString &database_param, const RenX::LadderDatabase::SortIndex *sort)
 {
 	Jupiter::String result(256);
-	size_t entry_count = db->getEntries();
 	size_t entries_per_page = pluginInstance.getEntriesPerPage();
 
 	result = R"html(<div id="leaderboard-paging">)html"_jrs;
@@ -242,10 +360,15 @@ Jupiter::String generate_page_buttons(RenX::LadderDatabase *db)
 		// Add page
 		result += R"html(<span class="leaderboard-page"><a href="?start=)html"_jrs;
 		result += Jupiter::StringS::Format("%u", entry_index);
-		if (db != RenX::default_ladder_database)
+		if (database_param.isNotEmpty())
 		{
 			result += "&database="_jrs;
-			result += db->getName();
+			result += database_param;
+		}
+		if (sort != nullptr)
+		{
+			result += "&sort="_jrs;
+			result += sort->name;
 		}
 		result += R"html(">)html"_jrs;
 		result += Jupiter::StringS::Format("%u", page_index);
@@ -262,7 +385,7 @@ Jupiter::String generate_page_buttons(RenX::LadderDatabase *db)
 
 /** Ladder page */
 
-Jupiter::String RenX_Ladder_WebPlugin::generate_entry_table(RenX::LadderDatabase *db, uint8_t format, size_t index, size_t count)
+template<typename L> Jupiter::String RenX_Ladder_WebPlugin::generate_entry_table(L *db, uint8_t format, size_t index, size_t count, const RenX::LadderDatabase::SortIndex *sort)
 {
 	if (db->getEntries() == 0) // No ladder data
 		return Jupiter::String("Error: No ladder data"_jrs);
@@ -273,30 +396,21 @@ Jupiter::String RenX_Ladder_WebPlugin::generate_entry_table(RenX::LadderDatabase
 	if (index + count > db->getEntries()) // Invalid entry range; use valid portion of range
 		count = db->getEntries() - index;
 
-	RenX::LadderDatabase::Entry *node = db->getHead();
+	RenX::LadderDatabase::Entry *node;
 
-	// iterate to requested index
-	while (index != 0)
-	{
-		node = node->next;
-		--index;
-	}
-
-	// table header
-	Jupiter::String result(2048);
+	// table header; rows are appended straight into the result, so reserve room for them up front
+	Jupiter::String result(RenX_Ladder_WebPlugin::ladder_table_header.size() + RenX_Ladder_WebPlugin::entry_table_row.size() * count + 2048);
 
 	if ((format & this->FLAG_INCLUDE_DATA_HEADER) != 0) // Data Header
 		result = RenX_Ladder_WebPlugin::ladder_table_header;
 
 	// append rows
-	Jupiter::String row(256);
+	Jupiter::ReferenceString db_name(db->getName());
 	while (count != 0)
 	{
-		row = RenX_Ladder_WebPlugin::entry_table_row;
-		row.replace(RenX::tags->INTERNAL_OBJECT_TAG, db->getName());
-		RenX::processTags(row, *node);
-		result += row;
-		node = node->next;
+		node = db->getPlayerEntryByIndex(index, sort);
+		RenX_Ladder_WebPlugin::entry_table_row_template.render(result, *node, sort != nullptr ? index + 1 : 0, { db_name });
+		++index;
 		--count;
 	}
 
@@ -304,12 +418,12 @@ Jupiter::String RenX_Ladder_WebPlugin::generate_entry_table(RenX::LadderDatabase
 	result += RenX_Ladder_WebPlugin::ladder_table_footer;
 
 	// search buttons
-	result += generate_page_buttons(db);
+	result += generate_page_buttons(db->getEntries(), get_database_param(db), sort);
 
 	return result;
 }
 
-Jupiter::String *RenX_Ladder_WebPlugin::generate_ladder_page(RenX::LadderDatabase *db, uint8_t format, size_t index, size_t count, const Jupiter::HTTP::HTMLFormResponse::TableType &query_params)
+Jupiter::String *RenX_Ladder_WebPlugin::generate_ladder_page(RenX::LadderDatabase *db, const RenX::LadderArchive *archive, uint8_t format, size_t index, size_t count, const RenX::LadderDatabase::SortIndex *sort, const Jupiter::HTTP::HTMLFormResponse::TableType &query_params)
 {
 	Jupiter::String *result = new Jupiter::String(2048);
 
@@ -317,12 +431,15 @@ Jupiter::String *RenX_Ladder_WebPlugin::generate_ladder_page(RenX::LadderDatabas
 		result->concat(RenX_Ladder_WebPlugin::header);
 
 	if ((format & this->FLAG_INCLUDE_SEARCH) != 0) // Search
-		result->concat(generate_search(db));
+		result->concat(archive == nullptr ? generate_search(get_database_param(db)) : generate_search(get_database_param(archive)));
 
 	if ((format & this->FLAG_INCLUDE_SELECTOR) != 0) // Selector
-		result->concat(generate_database_selector(db, query_params));
+		result->concat(generate_database_selector(db, archive, query_params));
 
-	result->concat(this->generate_entry_table(db, format, index, count));
+	if (archive == nullptr)
+		result->concat(this->generate_entry_table(db, format, index, count, sort));
+	else
+		result->concat(this->generate_entry_table(archive, format, index, count, sort));
 
 	if ((format & this->FLAG_INCLUDE_PAGE_FOOTER) != 0) // Footer
 		result->concat(RenX_Ladder_WebPlugin::footer);
@@ -330,11 +447,120 @@ Jupiter::String *RenX_Ladder_WebPlugin::generate_ladder_page(RenX::LadderDatabas
 	return result;
 }
 
+/** Number of rows rendered between writes of a streamed ladder page */
+constexpr size_t LADDER_STREAM_BATCH = 64;
+
+void RenX_Ladder_WebPlugin::stream_ladder_page(HTTPServerPlugin::OutputStream &out, RenX::LadderDatabase *db, const RenX::LadderArchive *archive, uint8_t format, size_t index, size_t count, const Jupiter::ReadableString &sort_name, const Jupiter::HTTP::HTMLFormResponse::TableType &query_params)
+{
+	// archives never change, so only the current period needs its database locked
+	auto lock_ladder = [db, archive]()
+	{
+		return archive == nullptr ? db->lock() : std::unique_lock<std::mutex>();
+	};
+
+	Jupiter::ReferenceString db_name(archive == nullptr ? db->getName() : archive->getName());
+	Jupiter::String buffer(RenX_Ladder_WebPlugin::entry_table_row.size() * LADDER_STREAM_BATCH + 4096);
+	bool include_table = false;
+
+	// page header, search and selector; everything is rendered into the buffer with locks held, and written after they are released
+	{
+		std::lock_guard<std::mutex> template_guard(RenX_Ladder_WebPlugin::template_mutex);
+		std::unique_lock<std::mutex> guard = lock_ladder();
+		size_t entries = archive == nullptr ? db->getEntries() : archive->getEntries();
+
+		if ((format & this->FLAG_INCLUDE_PAGE_HEADER) != 0) // Header
+			buffer += RenX_Ladder_WebPlugin::header;
+
+		if ((format & this->FLAG_INCLUDE_SEARCH) != 0) // Search
+			buffer += archive == nullptr ? generate_search(get_database_param(db)) : generate_search(get_database_param(archive));
+
+		if ((format & this->FLAG_INCLUDE_SELECTOR) != 0) // Selector
+			buffer += generate_database_selector(db, archive, query_params);
+
+		if (entries == 0) // No ladder data
+			buffer += "Error: No ladder data"_jrs;
+		else if (index >= entries || count == 0) // Invalid entry range
+			buffer += "Error: Invalid range"_jrs;
+		else
+		{
+			include_table = true;
+			if ((format & this->FLAG_INCLUDE_DATA_HEADER) != 0) // Data Header
+				buffer += RenX_Ladder_WebPlugin::ladder_table_header;
+		}
+	}
+	out.write(buffer);
+	buffer.erase();
+
+	// rows, a batch at a time; the ladder may be updated between batches
+	while (include_table && count != 0)
+	{
+		{
+			std::lock_guard<std::mutex> template_guard(RenX_Ladder_WebPlugin::template_mutex);
+			std::unique_lock<std::mutex> guard = lock_ladder();
+			const RenX::LadderDatabase::SortIndex *sort = archive == nullptr ? db->getSort(sort_name) : nullptr;
+			size_t entries = archive == nullptr ? db->getEntries() : archive->getEntries();
+			if (index >= entries)
+				break;
+
+			for (size_t batch = 0; batch != LADDER_STREAM_BATCH && count != 0 && index != entries; ++batch, ++index, --count)
+			{
+				RenX::LadderDatabase::Entry *node = archive == nullptr ? db->getPlayerEntryByIndex(index, sort) : archive->getPlayerEntryByIndex(index);
+				RenX_Ladder_WebPlugin::entry_table_row_template.render(buffer, *node, sort != nullptr ? index + 1 : 0, { db_name });
+			}
+		}
+		out.write(buffer);
+		buffer.erase();
+	}
+
+	// table footer, page buttons and page footer
+	{
+		std::lock_guard<std::mutex> template_guard(RenX_Ladder_WebPlugin::template_mutex);
+		std::unique_lock<std::mutex> guard = lock_ladder();
+
+		if (include_table)
+		{
+			if ((format & this->FLAG_INCLUDE_DATA_FOOTER) != 0) // Data footer
+				buffer += RenX_Ladder_WebPlugin::ladder_table_footer;
+
+			if (archive == nullptr)
+				buffer += generate_page_buttons(db->getEntries(), get_database_param(db), db->getSort(sort_name));
+			else
+				buffer += generate_page_buttons(archive->getEntries(), get_database_param(archive), nullptr);
+		}
+
+		if ((format & this->FLAG_INCLUDE_PAGE_FOOTER) != 0) // Footer
+			buffer += RenX_Ladder_WebPlugin::footer;
+	}
+	out.write(buffer);
+}
+
 // format:
 //	include_header | include_footer | include_any_headers | include_any_footers
 
 /** Search page */
-Jupiter::String *RenX_Ladder_WebPlugin::generate_search_page(RenX::LadderDatabase *db, uint8_t format, size_t start_index, size_t count, const Jupiter::ReadableString &name, const Jupiter::HTTP::HTMLFormResponse::TableType &query_params)
+
+template<typename L> Jupiter::String RenX_Ladder_WebPlugin::generate_search_table(L *db, uint8_t format, const Jupiter::ReadableString &name, const RenX::LadderDatabase::SortIndex *sort)
+{
+	if (db->getEntries() == 0) // No ladder data
+		return Jupiter::String("Error: No ladder data"_jrs);
+
+	Jupiter::String result(2048);
+
+	if ((format & this->FLAG_INCLUDE_DATA_HEADER) != 0) // Data header
+		result = RenX_Ladder_WebPlugin::ladder_table_header;
+
+	// append rows
+	Jupiter::ReferenceString db_name(db->getName());
+	for (RenX::LadderDatabase::Entry *node : db->findPlayerEntriesByPartName(name, 0))
+		RenX_Ladder_WebPlugin::entry_table_row_template.render(result, *node, sort != nullptr ? db->getRank(*node, sort) : 0, { db_name });
+
+	if ((format & this->FLAG_INCLUDE_DATA_FOOTER) != 0) // Data footer
+		result += RenX_Ladder_WebPlugin::ladder_table_footer;
+
+	return result;
+}
+
+Jupiter::String *RenX_Ladder_WebPlugin::generate_search_page(RenX::LadderDatabase *db, const RenX::LadderArchive *archive, uint8_t format, size_t start_index, size_t count, const Jupiter::ReadableString &name, const RenX::LadderDatabase::SortIndex *sort, const Jupiter::HTTP::HTMLFormResponse::TableType &query_params)
 {
 	Jupiter::String *result = new Jupiter::String(2048);
 
@@ -342,50 +568,55 @@ Jupiter::String *RenX_Ladder_WebPlugin::generate_search_page(RenX::LadderDatabas
 		result->concat(RenX_Ladder_WebPlugin::header);
 
 	if ((format & this->FLAG_INCLUDE_SEARCH) != 0) // Search
-		result->concat(generate_search(db));
+		result->concat(archive == nullptr ? generate_search(get_database_param(db)) : generate_search(get_database_param(archive)));
 
 	if ((format & this->FLAG_INCLUDE_SELECTOR) != 0) // Selector
-		result->concat(generate_database_selector(db, query_params));
+		result->concat(generate_database_selector(db, archive, query_params));
 
+	if (archive == nullptr)
+		result->concat(this->generate_search_table(db, format, name, sort));
+	else
+		result->concat(this->generate_search_table(archive, format, name, sort));
+
+	if ((format & this->FLAG_INCLUDE_PAGE_FOOTER) != 0) // Footer
+		result->concat(RenX_Ladder_WebPlugin::footer);
+
+	return result;
+}
+
+/** Profile page */
+
+template<typename L> Jupiter::String RenX_Ladder_WebPlugin::generate_profile(L *db, uint64_t steam_id)
+{
 	if (db->getEntries() == 0) // No ladder data
-	{
-		result->concat("Error: No ladder data"_jrs);
+		return Jupiter::String("Error: No ladder data"_jrs);
 
-		if ((format & this->FLAG_INCLUDE_PAGE_FOOTER) != 0) // Footer
-			result->concat(RenX_Ladder_WebPlugin::footer);
+	RenX::LadderDatabase::Entry *entry = db->getPlayerEntry(steam_id);
 
-		return result;
-	}
+	if (entry == nullptr)
+		return Jupiter::String("Error: Player not found"_jrs);
 
-	if ((format & this->FLAG_INCLUDE_DATA_HEADER) != 0) // Data header
-		result->concat(RenX_Ladder_WebPlugin::ladder_table_header);
+	Jupiter::String result(RenX_Ladder_WebPlugin::entry_profile.size() + 1024);
+	RenX_Ladder_WebPlugin::entry_profile_template.render(result, *entry);
 
-	// append rows
-	Jupiter::String row(256);
-	RenX::LadderDatabase::Entry *node = db->getHead();
-	while (node != nullptr)
+	Jupiter::ReferenceString db_name(db->getName());
+	result += "<div class=\"profile-navigation\">"_jrs;
+	if (entry->prev != nullptr)
 	{
-		if (node->most_recent_name.findi(name) != Jupiter::INVALID_INDEX) // match found
-		{
-			row = RenX_Ladder_WebPlugin::entry_table_row;
-			row.replace(RenX::tags->INTERNAL_OBJECT_TAG, db->getName());
-			RenX::processTags(row, *node);
-			result->concat(row);
-		}
-		node = node->next;
+		Jupiter::StringS steam_id = Jupiter::StringS::Format("%llu", entry->prev->steam_id);
+		RenX_Ladder_WebPlugin::entry_profile_previous_template.render(result, *entry->prev, 0, { db_name, Jupiter::ReferenceString(steam_id) });
 	}
-	
-	if ((format & this->FLAG_INCLUDE_DATA_FOOTER) != 0) // Data footer
-		result->concat(RenX_Ladder_WebPlugin::ladder_table_footer);
-
-	if ((format & this->FLAG_INCLUDE_PAGE_FOOTER) != 0) // Footer
-		result->concat(RenX_Ladder_WebPlugin::footer);
+	if (entry->next != nullptr)
+	{
+		Jupiter::StringS steam_id = Jupiter::StringS::Format("%llu", entry->next->steam_id);
+		RenX_Ladder_WebPlugin::entry_profile_next_template.render(result, *entry->next, 0, { db_name, Jupiter::ReferenceString(steam_id) });
+	}
+	result += "</div>"_jrs;
 
 	return result;
 }
 
-/** Profile page */
-Jupiter::String *RenX_Ladder_WebPlugin::generate_profile_page(RenX::LadderDatabase *db, uint8_t format, uint64_t steam_id, const Jupiter::HTTP::HTMLFormResponse::TableType &query_params)
+Jupiter::String *RenX_Ladder_WebPlugin::generate_profile_page(RenX::LadderDatabase *db, const RenX::LadderArchive *archive, uint8_t format, uint64_t steam_id, const Jupiter::HTTP::HTMLFormResponse::TableType &query_params)
 {
 	Jupiter::String *result = new Jupiter::String(2048);
 
@@ -393,61 +624,179 @@ Jupiter::String *RenX_Ladder_WebPlugin::generate_profile_page(RenX::LadderDataba
 		result->concat(RenX_Ladder_WebPlugin::header);
 
 	if ((format & this->FLAG_INCLUDE_SEARCH) != 0) // Search
-		result->concat(generate_search(db));
+		result->concat(archive == nullptr ? generate_search(get_database_param(db)) : generate_search(get_database_param(archive)));
 
 	if ((format & this->FLAG_INCLUDE_SELECTOR) != 0) // Selector
-		result->concat(generate_database_selector(db, query_params));
+		result->concat(generate_database_selector(db, archive, query_params));
 
-	if (db->getEntries() == 0) // No ladder data
-	{
-		result->concat("Error: No ladder data"_jrs);
+	if (archive == nullptr)
+		result->concat(this->generate_profile(db, steam_id));
+	else
+		result->concat(this->generate_profile(archive, steam_id));
 
-		if ((format & this->FLAG_INCLUDE_PAGE_FOOTER) != 0) // Footer
-			result->concat(RenX_Ladder_WebPlugin::footer);
+	if ((format & this->FLAG_INCLUDE_PAGE_FOOTER) != 0) // Footer
+		result->concat(RenX_Ladder_WebPlugin::footer);
 
-		return result;
-	}
+	return result;
+}
 
-	RenX::LadderDatabase::Entry *entry = db->getHead();
-	while (entry != nullptr)
+/** Archives */
+
+std::shared_ptr<const RenX::LadderArchive> RenX_Ladder_WebPlugin::getArchive(RenX::LadderDatabase *db, const Jupiter::ReadableString &label)
+{
+	std::string filename;
 	{
-		if (entry->steam_id == steam_id) // match found
-			break;
-		entry = entry->next;
+		std::unique_lock<std::mutex> guard = db->lock();
+		filename = db->getArchiveFilename(label);
 	}
 
-	if (entry == nullptr)
-		result->concat("Error: Player not found"_jrs);
-	else
-	{
-		Jupiter::String profile_data(RenX_Ladder_WebPlugin::entry_profile);
-		RenX::processTags(profile_data, *entry);
-		result->concat(profile_data);
+	if (filename.empty())
+		return nullptr;
 
-		result->concat("<div class=\"profile-navigation\">"_jrs);
-		if (entry->prev != nullptr)
+	// archives never change once written, so recently viewed ones are kept decoded
+	std::lock_guard<std::mutex> guard(RenX_Ladder_WebPlugin::archive_cache_mutex);
+	for (auto itr = RenX_Ladder_WebPlugin::archive_cache.begin(); itr != RenX_Ladder_WebPlugin::archive_cache.end(); ++itr)
+		if (itr->first == filename)
 		{
-			profile_data = RenX_Ladder_WebPlugin::entry_profile_previous;
-			profile_data.replace(RenX::tags->INTERNAL_OBJECT_TAG, db->getName());
-			profile_data.replace(RenX::tags->INTERNAL_WEAPON_TAG, Jupiter::StringS::Format("%llu", entry->prev->steam_id));
-			RenX::processTags(profile_data, *entry->prev);
-			result->concat(profile_data);
+			RenX_Ladder_WebPlugin::archive_cache.splice(RenX_Ladder_WebPlugin::archive_cache.begin(), RenX_Ladder_WebPlugin::archive_cache, itr);
+			return RenX_Ladder_WebPlugin::archive_cache.front().second;
 		}
-		if (entry->next != nullptr)
+
+	std::shared_ptr<RenX::LadderArchive> archive = std::make_shared<RenX::LadderArchive>();
+	if (archive->load(filename) == false)
+		return nullptr;
+
+	RenX_Ladder_WebPlugin::archive_cache.emplace_front(filename, archive);
+	while (RenX_Ladder_WebPlugin::archive_cache.size() > RenX_Ladder_WebPlugin::archive_cache_size)
+		RenX_Ladder_WebPlugin::archive_cache.pop_back();
+
+	return archive;
+}
+
+/** Response cache */
+
+std::shared_ptr<const RenX_Ladder_WebPlugin::CachedPage> RenX_Ladder_WebPlugin::getCachedPage(RenX::LadderDatabase *db, const RenX::LadderArchive *archive, const std::string &key, const std::function<void(CachedPage &page)> &generate)
+{
+	// archives never change once written, so their pages are versioned by the archive alone, and outlive updates to the current period
+	auto get_version = [db, archive]()
+	{
+		return archive == nullptr ? db->getVersion() : static_cast<uint64_t>(archive->getArchiveTime());
+	};
+
+	{
+		std::lock_guard<std::mutex> guard(RenX_Ladder_WebPlugin::response_cache_mutex);
+		auto itr = RenX_Ladder_WebPlugin::response_cache_index.find(key);
+		if (itr != RenX_Ladder_WebPlugin::response_cache_index.end() && itr->second->second->version == get_version())
 		{
-			profile_data = RenX_Ladder_WebPlugin::entry_profile_next;
-			profile_data.replace(RenX::tags->INTERNAL_OBJECT_TAG, db->getName());
-			profile_data.replace(RenX::tags->INTERNAL_VICTIM_STEAM_TAG, Jupiter::StringS::Format("%llu", entry->next->steam_id));
-			RenX::processTags(profile_data, *entry->next);
-			result->concat(profile_data);
+			RenX_Ladder_WebPlugin::response_cache.splice(RenX_Ladder_WebPlugin::response_cache.begin(), RenX_Ladder_WebPlugin::response_cache, itr->second);
+			return itr->second->second;
 		}
-		result->concat("</div>"_jrs);
 	}
 
-	if ((format & this->FLAG_INCLUDE_PAGE_FOOTER) != 0) // Footer
-		result->concat(RenX_Ladder_WebPlugin::footer);
+	std::shared_ptr<CachedPage> page = std::make_shared<CachedPage>();
+	{
+		std::lock_guard<std::mutex> template_guard(RenX_Ladder_WebPlugin::template_mutex);
+		std::unique_lock<std::mutex> guard = db->lock();
+		page->version = get_version();
+		generate(*page);
 
-	return result;
+		std::lock_guard<std::mutex> cache_guard(RenX_Ladder_WebPlugin::response_cache_mutex);
+		page->generation = RenX_Ladder_WebPlugin::response_cache_generation;
+	}
+
+	std::lock_guard<std::mutex> guard(RenX_Ladder_WebPlugin::response_cache_mutex);
+
+	if (archive != nullptr)
+		page->last_modified = formatHTTPDate(archive->getArchiveTime());
+	else
+	{
+		// pages are modified when their version is first seen
+		std::pair<uint64_t, time_t> &version_time = RenX_Ladder_WebPlugin::version_times[db];
+		if (version_time.second == 0 || page->version > version_time.first)
+			version_time = std::make_pair(page->version, time(nullptr));
+
+		page->last_modified = formatHTTPDate(version_time.second);
+	}
+	page->etag = '"' + std::to_string(page->version) + '-' + std::to_string(page->generation) + '"';
+
+	if (page->generation != RenX_Ladder_WebPlugin::response_cache_generation) // templates were reloaded while generating
+		return page;
+
+	auto itr = RenX_Ladder_WebPlugin::response_cache_index.find(key);
+	if (itr != RenX_Ladder_WebPlugin::response_cache_index.end())
+	{
+		if (itr->second->second->version > page->version) // a newer page was cached while generating
+			return page;
+		RenX_Ladder_WebPlugin::response_cache.erase(itr->second);
+	}
+
+	RenX_Ladder_WebPlugin::response_cache.emplace_front(key, page);
+	RenX_Ladder_WebPlugin::response_cache_index[key] = RenX_Ladder_WebPlugin::response_cache.begin();
+	while (RenX_Ladder_WebPlugin::response_cache.size() > RenX_Ladder_WebPlugin::response_cache_size)
+	{
+		RenX_Ladder_WebPlugin::response_cache_index.erase(RenX_Ladder_WebPlugin::response_cache.back().first);
+		RenX_Ladder_WebPlugin::response_cache.pop_back();
+	}
+
+	return page;
+}
+
+std::string RenX_Ladder_WebPlugin::generateUncachedPage(const std::function<Jupiter::ReadableString *()> &generate)
+{
+	std::lock_guard<std::mutex> template_guard(RenX_Ladder_WebPlugin::template_mutex);
+	std::unique_ptr<Jupiter::ReadableString> body(generate());
+	return std::string(body->ptr(), body->size());
+}
+
+/** Key identifying a page in the response cache */
+std::string make_cache_key(char page, const RenX::LadderDatabase *db, const RenX::LadderArchive *archive, uint8_t format, size_t start_index, size_t count, const RenX::LadderDatabase::SortIndex *sort, const Jupiter::ReadableString &query, const Jupiter::HTTP::HTMLFormResponse::TableType &query_params)
+{
+	std::string key;
+	key += page;
+	key += static_cast<std::string>(archive == nullptr ? db->getName() : archive->getName());
+	key += '\n';
+	key += std::to_string(format);
+	key += '\n';
+	key += std::to_string(start_index);
+	key += '\n';
+	key += std::to_string(count);
+	key += '\n';
+	if (sort != nullptr)
+		key += static_cast<std::string>(sort->name);
+	key += '\n';
+	key += static_cast<std::string>(query);
+
+	// the database selector carries the id parameter through
+	auto value = query_params.find("id"_jrs);
+	if (value != query_params.end())
+	{
+		key += '\n';
+		key += static_cast<std::string>(value->second);
+	}
+
+	return key;
+}
+
+/** Sends a cached page, or 304 Not Modified if the client's copy is current */
+void send_cached_page(const HTTPServerPlugin::Request &request, HTTPServerPlugin::Response &response, const std::shared_ptr<const RenX_Ladder_WebPlugin::CachedPage> &cached_page)
+{
+	const RenX_Ladder_WebPlugin::CachedPage &page = *cached_page;
+	response.status = page.status;
+	response.shared_body = std::shared_ptr<const HTTPServerPlugin::SharedBody>(cached_page, &page.body);
+	response.headers = "ETag: ";
+	response.headers += page.etag;
+	response.headers += "\r\nLast-Modified: ";
+	response.headers += page.last_modified;
+	response.headers += "\r\nCache-Control: no-cache\r\n";
+
+	if (page.status == 200)
+	{
+		const std::string *if_none_match = request.getHeader("If-None-Match");
+		const std::string *if_modified_since = request.getHeader("If-Modified-Since");
+		if (if_none_match != nullptr ? (*if_none_match == "*" || if_none_match->find(page.etag) != std::string::npos)
+			: (if_modified_since != nullptr && *if_modified_since == page.last_modified))
+			response.status = 304; // the body is not sent
+	}
 }
 
 /** Content functions */
@@ -455,10 +804,10 @@ Jupiter::String *RenX_Ladder_WebPlugin::generate_profile_page(RenX::LadderDataba
 Jupiter::ReadableString *generate_no_db_page(const Jupiter::HTTP::HTMLFormResponse::TableType &query_params)
 {
 	Jupiter::String *result = new Jupiter::String(pluginInstance.header);
-	if (RenX::ladder_databases.size() != 0)
+	if (RenX::acquireDefaultLadderDatabase() != nullptr)
 	{
-		result->concat(generate_search(nullptr));
-		result->concat(generate_database_selector(nullptr, query_params));
+		result->concat(generate_search(Jupiter::ReferenceString::empty));
+		result->concat(generate_database_selector(nullptr, nullptr, query_params));
 		result->concat("Error: No such database exists"_jrs);
 	}
 	else
@@ -467,45 +816,93 @@ Jupiter::ReadableString *generate_no_db_page(const Jupiter::HTTP::HTMLFormRespon
 	return result;
 }
 
-Jupiter::ReadableString *handle_ladder_page(const Jupiter::ReadableString &query_string)
+/** Finds a database by name; names of the form "database/label" refer to one of the database's archives */
+std::shared_ptr<RenX::LadderDatabase> find_database(const Jupiter::ReadableString &db_name, Jupiter::ReferenceString &archive_label)
 {
+	Jupiter::ReferenceString name(db_name);
+	for (size_t index = 0; index != db_name.size(); ++index)
+		if (db_name.get(index) == '/')
+		{
+			name = Jupiter::ReferenceString(db_name.ptr(), index);
+			archive_label = Jupiter::ReferenceString(db_name.ptr() + index + 1, db_name.size() - index - 1);
+			break;
+		}
+
+	return RenX::acquireLadderDatabase(name);
+}
+
+void handle_ladder_page(const HTTPServerPlugin::Request &request, HTTPServerPlugin::Response &response)
+{
+	Jupiter::ReferenceString query_string(request.query_string.data(), request.query_string.size());
 	Jupiter::HTTP::HTMLFormResponse html_form_response(query_string);
-	RenX::LadderDatabase *db = RenX::default_ladder_database;
+	std::shared_ptr<RenX::LadderDatabase> db = RenX::acquireDefaultLadderDatabase();
 	size_t start_index = 0, count = pluginInstance.getEntriesPerPage();
 	uint8_t format = 0xFF;
+	Jupiter::ReferenceString sort_name;
+	Jupiter::ReferenceString archive_label;
 
 	if (html_form_response.table.size() != 0)
 	{
 		format = html_form_response.tableGetCast<uint8_t>("format"_jrs, format);
 		start_index = html_form_response.tableGetCast<size_t>("start"_jrs, start_index);
 		count = html_form_response.tableGetCast<size_t>("count"_jrs, count);
+		sort_name = html_form_response.tableGet("sort"_jrs, sort_name);
 		
 		const Jupiter::ReadableString &db_name = html_form_response.tableGet("database"_jrs, Jupiter::ReferenceString::empty);
 		if (db_name.isNotEmpty())
+			db = find_database(db_name, archive_label);
+	}
+
+	if (db == nullptr)
+	{
+		response.body = pluginInstance.generateUncachedPage([&html_form_response]() { return generate_no_db_page(html_form_response.table); });
+		return;
+	}
+
+	std::shared_ptr<const RenX::LadderArchive> archive;
+	if (archive_label.isNotEmpty())
+	{
+		archive = pluginInstance.getArchive(db.get(), archive_label);
+		if (archive == nullptr)
 		{
-			db = nullptr;
-			for (size_t index = 0; index != RenX::ladder_databases.size(); ++index)
-				if (RenX::ladder_databases.get(index)->getName().equalsi(db_name))
-				{
-					db = RenX::ladder_databases.get(index);
-					break;
-				}
+			response.body = pluginInstance.generateUncachedPage([&html_form_response]() { return generate_no_db_page(html_form_response.table); });
+			return;
 		}
 	}
 
-	if (db == nullptr)
-		return generate_no_db_page(html_form_response.table);
+	if (count > pluginInstance.getMaxCachedEntries())
+	{
+		// too large to keep cached; streamed to the client as it is generated instead, and the handle keeps the database loaded until then
+		std::string query = request.query_string;
+		std::string sort = archive == nullptr ? std::string(sort_name.ptr(), sort_name.size()) : std::string();
+		response.stream = [db, archive, format, start_index, count, sort, query](HTTPServerPlugin::OutputStream &out)
+		{
+			Jupiter::ReferenceString query_string(query.data(), query.size());
+			Jupiter::HTTP::HTMLFormResponse query_params(query_string);
+			pluginInstance.stream_ladder_page(out, db.get(), archive.get(), format, start_index, count, Jupiter::ReferenceString(sort.data(), sort.size()), query_params.table);
+		};
+		return;
+	}
 
-	return pluginInstance.generate_ladder_page(db, format, start_index, count, html_form_response.table);
+	const RenX::LadderDatabase::SortIndex *sort = archive == nullptr ? db->getSort(sort_name) : nullptr;
+	std::shared_ptr<const RenX_Ladder_WebPlugin::CachedPage> page = pluginInstance.getCachedPage(db.get(), archive.get(), make_cache_key('l', db.get(), archive.get(), format, start_index, count, sort, Jupiter::ReferenceString::empty, html_form_response.table), [&](RenX_Ladder_WebPlugin::CachedPage &cached_page)
+	{
+		std::unique_ptr<Jupiter::String> body(pluginInstance.generate_ladder_page(db.get(), archive.get(), format, start_index, count, sort, html_form_response.table));
+		cached_page.body.plain.assign(body->ptr(), body->size());
+	});
+	send_cached_page(request, response, page);
 }
 
-Jupiter::ReadableString *handle_search_page(const Jupiter::ReadableString &query_string)
+void handle_search_page(const HTTPServerPlugin::Request &request, HTTPServerPlugin::Response &response)
 {
+	Jupiter::ReferenceString query_string(request.query_string.data(), request.query_string.size());
 	Jupiter::HTTP::HTMLFormResponse html_form_response(query_string);
-	RenX::LadderDatabase *db = RenX::default_ladder_database;
+	std::shared_ptr<RenX::LadderDatabase> db = RenX::acquireDefaultLadderDatabase();
 	uint8_t format = 0xFF;
 	size_t start_index = 0, count = pluginInstance.getEntriesPerPage();
 	Jupiter::ReferenceString name;
+	Jupiter::ReferenceString sort_name;
+	Jupiter::ReferenceString archive_label;
 
 	if (html_form_response.table.size() != 0)
 	{
@@ -513,35 +910,53 @@ Jupiter::ReadableString *handle_search_page(const Jupiter::ReadableString &query
 		start_index = html_form_response.tableGetCast<size_t>("start"_jrs, start_index);
 		count = html_form_response.tableGetCast<size_t>("count"_jrs, count);
 		name = html_form_response.tableGet("name"_jrs, name);
+		sort_name = html_form_response.tableGet("sort"_jrs, sort_name);
 
 		const Jupiter::ReadableString &db_name = html_form_response.tableGet("database"_jrs, Jupiter::ReferenceString::empty);
 		if (db_name.isNotEmpty())
-		{
-			db = nullptr;
-			for (size_t index = 0; index != RenX::ladder_databases.size(); ++index)
-				if (RenX::ladder_databases.get(index)->getName().equalsi(db_name))
-				{
-					db = RenX::ladder_databases.get(index);
-					break;
-				}
-		}
+			db = find_database(db_name, archive_label);
 	}
 
 	if (db == nullptr)
-		return generate_no_db_page(html_form_response.table);
+	{
+		response.body = pluginInstance.generateUncachedPage([&html_form_response]() { return generate_no_db_page(html_form_response.table); });
+		return;
+	}
 
 	if (name.size() < pluginInstance.getMinSearchNameLength()) // Generate ladder page when no name specified
-		return handle_ladder_page(query_string);
+	{
+		handle_ladder_page(request, response);
+		return;
+	}
 
-	return pluginInstance.generate_search_page(db, format, start_index, count, name, html_form_response.table);
+	std::shared_ptr<const RenX::LadderArchive> archive;
+	if (archive_label.isNotEmpty())
+	{
+		archive = pluginInstance.getArchive(db.get(), archive_label);
+		if (archive == nullptr)
+		{
+			response.body = pluginInstance.generateUncachedPage([&html_form_response]() { return generate_no_db_page(html_form_response.table); });
+			return;
+		}
+	}
+
+	const RenX::LadderDatabase::SortIndex *sort = archive == nullptr ? db->getSort(sort_name) : nullptr;
+	std::shared_ptr<const RenX_Ladder_WebPlugin::CachedPage> page = pluginInstance.getCachedPage(db.get(), archive.get(), make_cache_key('s', db.get(), archive.get(), format, start_index, count, sort, name, html_form_response.table), [&](RenX_Ladder_WebPlugin::CachedPage &cached_page)
+	{
+		std::unique_ptr<Jupiter::String> body(pluginInstance.generate_search_page(db.get(), archive.get(), format, start_index, count, name, sort, html_form_response.table));
+		cached_page.body.plain.assign(body->ptr(), body->size());
+	});
+	send_cached_page(request, response, page);
 }
 
-Jupiter::ReadableString *handle_profile_page(const Jupiter::ReadableString &query_string)
+void handle_profile_page(const HTTPServerPlugin::Request &request, HTTPServerPlugin::Response &response)
 {
+	Jupiter::ReferenceString query_string(request.query_string.data(), request.query_string.size());
 	Jupiter::HTTP::HTMLFormResponse html_form_response(query_string);
-	RenX::LadderDatabase *db = RenX::default_ladder_database;
+	std::shared_ptr<RenX::LadderDatabase> db = RenX::acquireDefaultLadderDatabase();
 	uint64_t steam_id = 0;
 	uint8_t format = 0xFF;
+	Jupiter::ReferenceString archive_label;
 
 	if (html_form_response.table.size() != 0)
 	{
@@ -550,21 +965,460 @@ Jupiter::ReadableString *handle_profile_page(const Jupiter::ReadableString &quer
 
 		const Jupiter::ReadableString &db_name = html_form_response.tableGet("database"_jrs, Jupiter::ReferenceString::empty);
 		if (db_name.isNotEmpty())
+			db = find_database(db_name, archive_label);
+	}
+
+	if (db == nullptr)
+	{
+		response.body = pluginInstance.generateUncachedPage([&html_form_response]() { return generate_no_db_page(html_form_response.table); });
+		return;
+	}
+
+	std::shared_ptr<const RenX::LadderArchive> archive;
+	if (archive_label.isNotEmpty())
+	{
+		archive = pluginInstance.getArchive(db.get(), archive_label);
+		if (archive == nullptr)
+		{
+			response.body = pluginInstance.generateUncachedPage([&html_form_response]() { return generate_no_db_page(html_form_response.table); });
+			return;
+		}
+	}
+
+	std::shared_ptr<const RenX_Ladder_WebPlugin::CachedPage> page = pluginInstance.getCachedPage(db.get(), archive.get(), make_cache_key('p', db.get(), archive.get(), format, 0, 0, nullptr, Jupiter::ReferenceString::empty, html_form_response.table), [&](RenX_Ladder_WebPlugin::CachedPage &cached_page)
+	{
+		std::unique_ptr<Jupiter::String> body(pluginInstance.generate_profile_page(db.get(), archive.get(), format, steam_id, html_form_response.table));
+		cached_page.body.plain.assign(body->ptr(), body->size());
+	});
+	send_cached_page(request, response, page);
+}
+
+/** JSON */
+
+/** Writes JSON straight into a preallocated string; commas are inserted between values automatically */
+class JsonWriter
+{
+public:
+	JsonWriter(std::string &in_out, size_t reserve) : out(in_out)
+	{
+		out.reserve(reserve);
+	}
+
+	void beginObject()
+	{
+		separate();
+		out += '{';
+		first = true;
+	}
+
+	void endObject()
+	{
+		out += '}';
+		first = false;
+	}
+
+	void beginArray()
+	{
+		separate();
+		out += '[';
+		first = true;
+	}
+
+	void endArray()
+	{
+		out += ']';
+		first = false;
+	}
+
+	void key(const char *name)
+	{
+		separate();
+		out += '"';
+		out += name;
+		out += "\":";
+		first = true;
+	}
+
+	void value(uint64_t number)
+	{
+		char buffer[24];
+		separate();
+		out.append(buffer, snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(number)));
+	}
+
+	void value(double number)
+	{
+		char buffer[64];
+		separate();
+		out.append(buffer, snprintf(buffer, sizeof(buffer), "%.2f", number));
+	}
+
+	void value(const char *str, size_t length)
+	{
+		separate();
+		out += '"';
+		for (const char *end = str + length; str != end; ++str)
 		{
-			db = nullptr;
-			for (size_t index = 0; index != RenX::ladder_databases.size(); ++index)
-				if (RenX::ladder_databases.get(index)->getName().equalsi(db_name))
+			switch (*str)
+			{
+			case '"':
+				out += "\\\"";
+				break;
+			case '\\':
+				out += "\\\\";
+				break;
+			default:
+				if (static_cast<unsigned char>(*str) < 0x20)
 				{
-					db = RenX::ladder_databases.get(index);
-					break;
+					char buffer[8];
+					out.append(buffer, snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned int>(*str)));
 				}
+				else
+					out += *str;
+				break;
+			}
 		}
+		out += '"';
 	}
 
+	void value(const Jupiter::ReadableString &str)
+	{
+		this->value(str.ptr(), str.size());
+	}
+
+	void value(const char *str)
+	{
+		this->value(str, strlen(str));
+	}
+
+	void null()
+	{
+		separate();
+		out += "null";
+	}
+
+	template<typename T> void field(const char *name, T in_value)
+	{
+		this->key(name);
+		this->value(in_value);
+	}
+
+private:
+	void separate()
+	{
+		if (first)
+			first = false;
+		else
+			out += ',';
+	}
+
+	std::string &out;
+	bool first = true;
+};
+
+double get_json_ratio(double num, double denom)
+{
+	if (denom == 0.0)
+		return num;
+	return num / denom;
+}
+
+/** Writes an entry's rank, totals, per-team totals and best games; IP addresses are never included */
+void write_entry_json(JsonWriter &json, const RenX::LadderDatabase::Entry &entry, size_t rank)
+{
+	uint32_t total_ties = entry.total_gdi_ties + entry.total_nod_ties;
+
+	json.beginObject();
+	json.field<uint64_t>("rank", rank);
+	json.key("steam_id");
+	json.value(std::to_string(entry.steam_id).c_str());
+	json.field<const Jupiter::ReadableString &>("name", entry.most_recent_name);
+	json.field<uint64_t>("last_game", static_cast<uint64_t>(entry.last_game));
+	json.field<uint64_t>("score", entry.total_score);
+	json.field<uint64_t>("games", entry.total_games);
+	json.field<uint64_t>("wins", entry.total_wins);
+	json.field<uint64_t>("ties", total_ties);
+	json.field<uint64_t>("losses", entry.total_games - total_ties - entry.total_wins);
+	json.field<uint64_t>("game_time", entry.total_game_time);
+	json.field<uint64_t>("kills", entry.total_kills);
+	json.field<uint64_t>("deaths", entry.total_deaths);
+	json.field<uint64_t>("headshot_kills", entry.total_headshot_kills);
+	json.field<uint64_t>("vehicle_kills", entry.total_vehicle_kills);
+	json.field<uint64_t>("building_kills", entry.total_building_kills);
+	json.field<uint64_t>("defence_kills", entry.total_defence_kills);
+	json.field<uint64_t>("captures", entry.total_captures);
+	json.field<uint64_t>("beacon_placements", entry.total_beacon_placements);
+	json.field<uint64_t>("beacon_disarms", entry.total_beacon_disarms);
+	json.field<uint64_t>("proxy_placements", entry.total_proxy_placements);
+	json.field<uint64_t>("proxy_disarms", entry.total_proxy_disarms);
+	json.field<double>("kdr", get_json_ratio(static_cast<double>(entry.total_kills), static_cast<double>(entry.total_deaths)));
+	json.field<double>("spm", get_json_ratio(static_cast<double>(entry.total_score), static_cast<double>(entry.total_game_time) / 60.0));
+	json.field<double>("wlr", get_json_ratio(static_cast<double>(entry.total_wins), static_cast<double>(entry.total_games - entry.total_wins)));
+
+	json.key("gdi");
+	json.beginObject();
+	json.field<uint64_t>("score", entry.total_gdi_score);
+	json.field<uint64_t>("games", entry.total_gdi_games);
+	json.field<uint64_t>("wins", entry.total_gdi_wins);
+	json.field<uint64_t>("ties", entry.total_gdi_ties);
+	json.field<uint64_t>("losses", entry.total_gdi_games - entry.total_gdi_ties - entry.total_gdi_wins);
+	json.field<uint64_t>("game_time", entry.total_gdi_game_time);
+	json.field<uint64_t>("kills", entry.total_gdi_kills);
+	json.field<uint64_t>("deaths", entry.total_gdi_deaths);
+	json.field<uint64_t>("headshots", entry.total_gdi_headshots);
+	json.field<uint64_t>("vehicle_kills", entry.total_gdi_vehicle_kills);
+	json.field<uint64_t>("building_kills", entry.total_gdi_building_kills);
+	json.field<uint64_t>("defence_kills", entry.total_gdi_defence_kills);
+	json.field<uint64_t>("beacon_placements", entry.total_gdi_beacon_placements);
+	json.field<uint64_t>("beacon_disarms", entry.total_gdi_beacon_disarms);
+	json.field<uint64_t>("proxy_placements", entry.total_gdi_proxy_placements);
+	json.field<uint64_t>("proxy_disarms", entry.total_gdi_proxy_disarms);
+	json.field<double>("kdr", get_json_ratio(static_cast<double>(entry.total_gdi_kills), static_cast<double>(entry.total_gdi_deaths)));
+	json.field<double>("spm", get_json_ratio(static_cast<double>(entry.total_gdi_score), static_cast<double>(entry.total_gdi_game_time) / 60.0));
+	json.field<double>("wlr", get_json_ratio(static_cast<double>(entry.total_gdi_wins), static_cast<double>(entry.total_gdi_games - entry.total_gdi_wins - entry.total_gdi_ties)));
+	json.endObject();
+
+	json.key("nod");
+	json.beginObject();
+	json.field<uint64_t>("score", entry.total_nod_score);
+	json.field<uint64_t>("games", entry.total_nod_games);
+	json.field<uint64_t>("wins", entry.total_nod_wins);
+	json.field<uint64_t>("ties", entry.total_nod_ties);
+	json.field<uint64_t>("losses", entry.total_nod_games - entry.total_nod_ties - entry.total_nod_wins);
+	json.field<uint64_t>("game_time", entry.total_nod_game_time);
+	json.field<uint64_t>("kills", entry.total_nod_kills);
+	json.field<uint64_t>("deaths", entry.total_nod_deaths);
+	json.field<uint64_t>("headshots", entry.total_nod_headshots);
+	json.field<uint64_t>("vehicle_kills", entry.total_nod_vehicle_kills);
+	json.field<uint64_t>("building_kills", entry.total_nod_building_kills);
+	json.field<uint64_t>("defence_kills", entry.total_nod_defence_kills);
+	json.field<uint64_t>("beacon_placements", entry.total_nod_beacon_placements);
+	json.field<uint64_t>("beacon_disarms", entry.total_nod_beacon_disarms);
+	json.field<uint64_t>("proxy_placements", entry.total_nod_proxy_placements);
+	json.field<uint64_t>("proxy_disarms", entry.total_nod_proxy_disarms);
+	json.field<double>("kdr", get_json_ratio(static_cast<double>(entry.total_nod_kills), static_cast<double>(entry.total_nod_deaths)));
+	json.field<double>("spm", get_json_ratio(static_cast<double>(entry.total_nod_score), static_cast<double>(entry.total_nod_game_time) / 60.0));
+	json.field<double>("wlr", get_json_ratio(static_cast<double>(entry.total_nod_wins), static_cast<double>(entry.total_nod_games - entry.total_nod_wins - entry.total_nod_ties)));
+	json.endObject();
+
+	json.key("top");
+	json.beginObject();
+	json.field<uint64_t>("score", entry.top_score);
+	json.field<uint64_t>("kills", entry.top_kills);
+	json.field<uint64_t>("deaths", entry.most_deaths);
+	json.field<uint64_t>("headshot_kills", entry.top_headshot_kills);
+	json.field<uint64_t>("vehicle_kills", entry.top_vehicle_kills);
+	json.field<uint64_t>("building_kills", entry.top_building_kills);
+	json.field<uint64_t>("defence_kills", entry.top_defence_kills);
+	json.field<uint64_t>("captures", entry.top_captures);
+	json.field<uint64_t>("game_time", entry.top_game_time);
+	json.field<uint64_t>("beacon_placements", entry.top_beacon_placements);
+	json.field<uint64_t>("beacon_disarms", entry.top_beacon_disarms);
+	json.field<uint64_t>("proxy_placements", entry.top_proxy_placements);
+	json.field<uint64_t>("proxy_disarms", entry.top_proxy_disarms);
+	json.endObject();
+
+	json.endObject();
+}
+
+/** Rough size of a written entry, used to preallocate responses */
+constexpr size_t JSON_ENTRY_SIZE = 1536;
+
+void write_json_header(JsonWriter &json, const Jupiter::ReadableString &database, size_t entries, const RenX::LadderDatabase::SortIndex *sort)
+{
+	json.field<const Jupiter::ReadableString &>("database", database);
+	json.field<uint64_t>("entries", entries);
+	json.key("sort");
+	if (sort != nullptr)
+		json.value(sort->name);
+	else
+		json.null();
+}
+
+template<typename L> void generate_ladder_json(RenX_Ladder_WebPlugin::CachedPage &page, L *db, size_t index, size_t count, const RenX::LadderDatabase::SortIndex *sort)
+{
+	if (index >= db->getEntries())
+		count = 0;
+	else if (index + count > db->getEntries())
+		count = db->getEntries() - index;
+
+	JsonWriter json(page.body.plain, JSON_ENTRY_SIZE * count + 256);
+	json.beginObject();
+	write_json_header(json, db->getName(), db->getEntries(), sort);
+	json.field<uint64_t>("start", index);
+	json.key("players");
+	json.beginArray();
+	while (count != 0)
+	{
+		RenX::LadderDatabase::Entry *node = db->getPlayerEntryByIndex(index, sort);
+		write_entry_json(json, *node, sort != nullptr ? index + 1 : node->rank);
+		++index;
+		--count;
+	}
+	json.endArray();
+	json.endObject();
+}
+
+template<typename L> void generate_search_json(RenX_Ladder_WebPlugin::CachedPage &page, L *db, size_t index, size_t count, const Jupiter::ReadableString &name, const RenX::LadderDatabase::SortIndex *sort)
+{
+	std::vector<RenX::LadderDatabase::Entry *> matches = db->findPlayerEntriesByPartName(name, 0);
+	if (index >= matches.size())
+		count = 0;
+	else if (index + count > matches.size())
+		count = matches.size() - index;
+
+	JsonWriter json(page.body.plain, JSON_ENTRY_SIZE * count + 256);
+	json.beginObject();
+	write_json_header(json, db->getName(), db->getEntries(), sort);
+	json.field<const Jupiter::ReadableString &>("name", name);
+	json.field<uint64_t>("matches", matches.size());
+	json.field<uint64_t>("start", index);
+	json.key("players");
+	json.beginArray();
+	for (auto itr = matches.begin() + index, end = itr + count; itr != end; ++itr)
+		write_entry_json(json, **itr, db->getRank(**itr, sort));
+	json.endArray();
+	json.endObject();
+}
+
+template<typename L> void generate_profile_json(RenX_Ladder_WebPlugin::CachedPage &page, L *db, uint64_t steam_id)
+{
+	RenX::LadderDatabase::Entry *entry = db->getPlayerEntry(steam_id);
+	JsonWriter json(page.body.plain, JSON_ENTRY_SIZE + 256);
+	json.beginObject();
+	if (entry == nullptr)
+	{
+		page.status = 404;
+		json.field("error", "Player not found");
+		json.endObject();
+		return;
+	}
+
+	json.field<const Jupiter::ReadableString &>("database", db->getName());
+	json.key("player");
+	write_entry_json(json, *entry, entry->rank);
+	json.key("previous");
+	if (entry->prev != nullptr)
+		json.value(std::to_string(entry->prev->steam_id).c_str());
+	else
+		json.null();
+	json.key("next");
+	if (entry->next != nullptr)
+		json.value(std::to_string(entry->next->steam_id).c_str());
+	else
+		json.null();
+	json.endObject();
+}
+
+void send_json_error(HTTPServerPlugin::Response &response, int status, const char *message)
+{
+	JsonWriter json(response.body, 64);
+	response.status = status;
+	json.beginObject();
+	json.field("error", message);
+	json.endObject();
+}
+
+/** Resolves the "database" parameter of a JSON request; sends an error and returns nullptr if it does not exist */
+std::shared_ptr<RenX::LadderDatabase> find_json_database(Jupiter::HTTP::HTMLFormResponse &html_form_response, HTTPServerPlugin::Response &response, std::shared_ptr<const RenX::LadderArchive> &archive)
+{
+	std::shared_ptr<RenX::LadderDatabase> db = RenX::acquireDefaultLadderDatabase();
+	Jupiter::ReferenceString archive_label;
+
+	const Jupiter::ReadableString &db_name = html_form_response.tableGet("database"_jrs, Jupiter::ReferenceString::empty);
+	if (db_name.isNotEmpty())
+		db = find_database(db_name, archive_label);
+
 	if (db == nullptr)
-		return generate_no_db_page(html_form_response.table);
+	{
+		send_json_error(response, 404, RenX::acquireDefaultLadderDatabase() != nullptr ? "No such database exists" : "No ladder databases loaded");
+		return nullptr;
+	}
+
+	if (archive_label.isNotEmpty())
+	{
+		archive = pluginInstance.getArchive(db.get(), archive_label);
+		if (archive == nullptr)
+		{
+			send_json_error(response, 404, "No such archive exists");
+			return nullptr;
+		}
+	}
 
-	return pluginInstance.generate_profile_page(db, format, steam_id, html_form_response.table);
+	return db;
+}
+
+void handle_ladder_json(const HTTPServerPlugin::Request &request, HTTPServerPlugin::Response &response)
+{
+	Jupiter::ReferenceString query_string(request.query_string.data(), request.query_string.size());
+	Jupiter::HTTP::HTMLFormResponse html_form_response(query_string);
+	std::shared_ptr<const RenX::LadderArchive> archive;
+	std::shared_ptr<RenX::LadderDatabase> db = find_json_database(html_form_response, response, archive);
+	if (db == nullptr)
+		return;
+
+	size_t start_index = html_form_response.tableGetCast<size_t>("start"_jrs, 0);
+	size_t count = std::min(html_form_response.tableGetCast<size_t>("count"_jrs, pluginInstance.getEntriesPerPage()), pluginInstance.getMaxJsonEntries());
+	const RenX::LadderDatabase::SortIndex *sort = archive == nullptr ? db->getSort(html_form_response.tableGet("sort"_jrs, Jupiter::ReferenceString::empty)) : nullptr;
+
+	std::shared_ptr<const RenX_Ladder_WebPlugin::CachedPage> page = pluginInstance.getCachedPage(db.get(), archive.get(), make_cache_key('L', db.get(), archive.get(), 0, start_index, count, sort, Jupiter::ReferenceString::empty, Jupiter::HTTP::HTMLFormResponse::TableType()), [&](RenX_Ladder_WebPlugin::CachedPage &cached_page)
+	{
+		if (archive == nullptr)
+			generate_ladder_json(cached_page, db.get(), start_index, count, sort);
+		else
+			generate_ladder_json(cached_page, archive.get(), start_index, count, sort);
+	});
+	send_cached_page(request, response, page);
+}
+
+void handle_search_json(const HTTPServerPlugin::Request &request, HTTPServerPlugin::Response &response)
+{
+	Jupiter::ReferenceString query_string(request.query_string.data(), request.query_string.size());
+	Jupiter::HTTP::HTMLFormResponse html_form_response(query_string);
+	std::shared_ptr<const RenX::LadderArchive> archive;
+	std::shared_ptr<RenX::LadderDatabase> db = find_json_database(html_form_response, response, archive);
+	if (db == nullptr)
+		return;
+
+	Jupiter::ReferenceString name(html_form_response.tableGet("name"_jrs, Jupiter::ReferenceString::empty));
+	if (name.size() < pluginInstance.getMinSearchNameLength())
+	{
+		send_json_error(response, 400, "Name is too short");
+		return;
+	}
+
+	size_t start_index = html_form_response.tableGetCast<size_t>("start"_jrs, 0);
+	size_t count = std::min(html_form_response.tableGetCast<size_t>("count"_jrs, pluginInstance.getEntriesPerPage()), pluginInstance.getMaxJsonEntries());
+	const RenX::LadderDatabase::SortIndex *sort = archive == nullptr ? db->getSort(html_form_response.tableGet("sort"_jrs, Jupiter::ReferenceString::empty)) : nullptr;
+
+	std::shared_ptr<const RenX_Ladder_WebPlugin::CachedPage> page = pluginInstance.getCachedPage(db.get(), archive.get(), make_cache_key('S', db.get(), archive.get(), 0, start_index, count, sort, name, Jupiter::HTTP::HTMLFormResponse::TableType()), [&](RenX_Ladder_WebPlugin::CachedPage &cached_page)
+	{
+		if (archive == nullptr)
+			generate_search_json(cached_page, db.get(), start_index, count, name, sort);
+		else
+			generate_search_json(cached_page, archive.get(), start_index, count, name, sort);
+	});
+	send_cached_page(request, response, page);
+}
+
+void handle_profile_json(const HTTPServerPlugin::Request &request, HTTPServerPlugin::Response &response)
+{
+	Jupiter::ReferenceString query_string(request.query_string.data(), request.query_string.size());
+	Jupiter::HTTP::HTMLFormResponse html_form_response(query_string);
+	std::shared_ptr<const RenX::LadderArchive> archive;
+	std::shared_ptr<RenX::LadderDatabase> db = find_json_database(html_form_response, response, archive);
+	if (db == nullptr)
+		return;
+
+	uint64_t steam_id = html_form_response.tableGetCast<uint64_t>("id"_jrs, 0);
+	std::shared_ptr<const RenX_Ladder_WebPlugin::CachedPage> page = pluginInstance.getCachedPage(db.get(), archive.get(), make_cache_key('P', db.get(), archive.get(), 0, 0, 0, nullptr, Jupiter::ReferenceString::empty, Jupiter::HTTP::HTMLFormResponse::TableType()) + '\n' + std::to_string(steam_id), [&](RenX_Ladder_WebPlugin::CachedPage &cached_page)
+	{
+		if (archive == nullptr)
+			generate_profile_json(cached_page, db.get(), steam_id);
+		else
+			generate_profile_json(cached_page, archive.get(), steam_id);
+	});
+	send_cached_page(request, response, page);
 }
 
 extern "C" JUPITER_EXPORT Jupiter::Plugin *getPlugin()
@@ -19,15 +19,25 @@
 #if !defined _RENX_LADDER_WEB_H
 #define _RENX_LADDER_WEB_H
 
+#include <list>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <unordered_map>
 #include "Jupiter/Plugin.h"
 #include "Jupiter/Reference_String.h"
 #include "Jupiter/String.hpp"
 #include "RenX_Plugin.h"
+#include "RenX_LadderDatabase.h"
+#include "RenX_Tags.h"
+#include "HTTPServer.h"
 
 class RenX_Ladder_WebPlugin : public RenX::Plugin
 {
 protected:
-	Jupiter::String generate_entry_table(RenX::LadderDatabase *db, uint8_t format, size_t index, size_t count);
+	template<typename L> Jupiter::String generate_entry_table(L *db, uint8_t format, size_t index, size_t count, const RenX::LadderDatabase::SortIndex *sort);
+	template<typename L> Jupiter::String generate_search_table(L *db, uint8_t format, const Jupiter::ReadableString &name, const RenX::LadderDatabase::SortIndex *sort);
+	template<typename L> Jupiter::String generate_profile(L *db, uint64_t steam_id);
 
 public:
 	const uint8_t FLAG_INCLUDE_PAGE_HEADER = 0x01;
@@ -39,11 +49,70 @@ public:
 
 	Jupiter::StringS header;
 	Jupiter::StringS footer;
-	Jupiter::String *generate_ladder_page(RenX::LadderDatabase *db, uint8_t format, size_t start_index, size_t count, const Jupiter::HTTP::HTMLFormResponse::TableType &query_params);
-	Jupiter::String *generate_search_page(RenX::LadderDatabase *db, uint8_t format, size_t start_index, size_t count, const Jupiter::ReadableString &name, const Jupiter::HTTP::HTMLFormResponse::TableType &query_params);
-	Jupiter::String *generate_profile_page(RenX::LadderDatabase *db, uint8_t format, uint64_t steam_id, const Jupiter::HTTP::HTMLFormResponse::TableType &query_params);
+	Jupiter::String *generate_ladder_page(RenX::LadderDatabase *db, const RenX::LadderArchive *archive, uint8_t format, size_t start_index, size_t count, const RenX::LadderDatabase::SortIndex *sort, const Jupiter::HTTP::HTMLFormResponse::TableType &query_params);
+	Jupiter::String *generate_search_page(RenX::LadderDatabase *db, const RenX::LadderArchive *archive, uint8_t format, size_t start_index, size_t count, const Jupiter::ReadableString &name, const RenX::LadderDatabase::SortIndex *sort, const Jupiter::HTTP::HTMLFormResponse::TableType &query_params);
+	Jupiter::String *generate_profile_page(RenX::LadderDatabase *db, const RenX::LadderArchive *archive, uint8_t format, uint64_t steam_id, const Jupiter::HTTP::HTMLFormResponse::TableType &query_params);
+
+	/**
+	* @brief Writes a ladder page to a stream as it is generated, instead of caching it.
+	* Locks are only held while a batch of rows is rendered, so the ladder may be updated while the page is sent.
+	*
+	* @param out Stream to write the page to
+	* @param db Database to list
+	* @param archive Archive of the database to list instead, or nullptr for the current period
+	* @param format Sections of the page to include (FLAG_INCLUDE_*)
+	* @param start_index Index of the first entry to list
+	* @param count Number of entries to list
+	* @param sort_name Name of the ordering to list the entries in, or empty for total score
+	* @param query_params Parameters of the request
+	*/
+	void stream_ladder_page(HTTPServerPlugin::OutputStream &out, RenX::LadderDatabase *db, const RenX::LadderArchive *archive, uint8_t format, size_t start_index, size_t count, const Jupiter::ReadableString &sort_name, const Jupiter::HTTP::HTMLFormResponse::TableType &query_params);
+
+	/**
+	* @brief Fetches one of a database's archives, loading it if it isn't cached.
+	*
+	* @param db Database which was archived
+	* @param label Label of the archived period
+	* @return Archive if it exists and could be loaded, nullptr otherwise.
+	*/
+	std::shared_ptr<const RenX::LadderArchive> getArchive(RenX::LadderDatabase *db, const Jupiter::ReadableString &label);
+
+	/**
+	* @brief Page body generated from one version of a ladder database, or from an archive.
+	*/
+	struct CachedPage
+	{
+		int status = 200;
+		uint64_t version;
+		uint64_t generation;
+		std::string etag;
+		std::string last_modified;
+		HTTPServerPlugin::SharedBody body; /** Compressed for clients which accept it, once per version */
+	};
+
+	/**
+	* @brief Fetches a page from the response cache, generating it if it is missing or its database has since been updated.
+	* Pages of archives are only regenerated when they are evicted, or templates are reloaded.
+	*
+	* @param db Database the page is generated from
+	* @param archive Archive of db the page is generated from, or nullptr for the current period
+	* @param key Key identifying the page and its parameters
+	* @param generate Function which fills in the page's body (and status, if not 200); called with the database locked
+	* @return Cached page
+	*/
+	std::shared_ptr<const CachedPage> getCachedPage(RenX::LadderDatabase *db, const RenX::LadderArchive *archive, const std::string &key, const std::function<void(CachedPage &page)> &generate);
+
+	/**
+	* @brief Generates a page outside of the response cache.
+	*
+	* @param generate Function which generates the page
+	* @return Generated page
+	*/
+	std::string generateUncachedPage(const std::function<Jupiter::ReadableString *()> &generate);
 	inline size_t getEntriesPerPage() const { return this->entries_per_page; }
 	inline size_t getMinSearchNameLength() const { return this->min_search_name_length; };
+	inline size_t getMaxJsonEntries() const { return this->max_json_entries; };
+	inline size_t getMaxCachedEntries() const { return this->max_cached_entries; };
 
 	virtual bool initialize() override;
 	~RenX_Ladder_WebPlugin();
@@ -57,7 +126,12 @@ private:
 	/** Configuration variables */
 	size_t entries_per_page;
 	size_t min_search_name_length;
+	size_t archive_cache_size;
+	size_t response_cache_size;
+	size_t max_json_entries;
+	size_t max_cached_entries;
 	Jupiter::StringS ladder_page_name, search_page_name, profile_page_name, ladder_table_header, ladder_table_footer;
+	Jupiter::StringS ladder_json_page_name, search_json_page_name, profile_json_page_name;
 	Jupiter::StringS web_hostname;
 	Jupiter::StringS web_path;
 	std::string web_header_filename;
@@ -67,10 +141,26 @@ private:
 	std::string web_ladder_table_footer_filename;
 
 	Jupiter::StringS entry_table_row, entry_profile, entry_profile_previous, entry_profile_next;
+	RenX::LadderEntryTemplate entry_table_row_template, entry_profile_template, entry_profile_previous_template, entry_profile_next_template;
+
+	/** Recently viewed archives, most recent first */
+	std::mutex archive_cache_mutex;
+	std::list<std::pair<std::string, std::shared_ptr<const RenX::LadderArchive>>> archive_cache;
+
+	/** Generated pages, most recently used first; templates are only read or reloaded while holding template_mutex */
+	std::mutex template_mutex;
+	std::mutex response_cache_mutex;
+	uint64_t response_cache_generation = 0;
+	std::list<std::pair<std::string, std::shared_ptr<const CachedPage>>> response_cache;
+	std::unordered_map<std::string, std::list<std::pair<std::string, std::shared_ptr<const CachedPage>>>::iterator> response_cache_index;
+	std::unordered_map<const RenX::LadderDatabase *, std::pair<uint64_t, time_t>> version_times;
 };
 
-Jupiter::ReadableString *handle_ladder_page(const Jupiter::ReadableString &parameters);
-Jupiter::ReadableString *handle_search_page(const Jupiter::ReadableString &parameters);
-Jupiter::ReadableString *handle_profile_page(const Jupiter::ReadableString &parameters);
+void handle_ladder_page(const HTTPServerPlugin::Request &request, HTTPServerPlugin::Response &response);
+void handle_search_page(const HTTPServerPlugin::Request &request, HTTPServerPlugin::Response &response);
+void handle_profile_page(const HTTPServerPlugin::Request &request, HTTPServerPlugin::Response &response);
+void handle_ladder_json(const HTTPServerPlugin::Request &request, HTTPServerPlugin::Response &response);
+void handle_search_json(const HTTPServerPlugin::Request &request, HTTPServerPlugin::Response &response);
+void handle_profile_json(const HTTPServerPlugin::Request &request, HTTPServerPlugin::Response &response);
 
 #endif // _RENX_LADDER_WEB_H
\ No newline at end of file
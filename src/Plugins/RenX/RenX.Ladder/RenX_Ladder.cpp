@@ -17,6 +17,7 @@
  */
 
 #include <cinttypes>
+#include <cmath>
 #include "Console_Command.h"
 #include "RenX_Ladder.h"
 #include "RenX_Server.h"
@@ -72,12 +73,21 @@ void RenX_LadderPlugin::RenX_OnCommand(RenX::Server &server, const Jupiter::Read
 		{
 			server.varData[this->name].set("w"_jrs, "0"_jrs);
 			RenX::TeamType team = static_cast<RenX::TeamType>(server.varData[this->name].get("t"_jrs, "\0"_jrs).get(0));
-			for (size_t index = 0; index != RenX::ladder_databases.size(); ++index)
-				RenX::ladder_databases.get(index)->updateLadder(server, team);
+
+			// aggregation, sorting, and writing happen on the ingest worker thread, in one pass for every ladder
+			RenX::LadderDatabase::submitMatch(server, RenX::LadderDatabase::snapshotMatch(server, team));
 		}
 	}
 }
 
+int RenX_LadderPlugin::think()
+{
+	for (size_t index = 0; index != RenX::ladder_databases.size(); ++index)
+		RenX::ladder_databases.get(index)->flushOutput();
+
+	return Jupiter::Plugin::think();
+}
+
 size_t RenX_LadderPlugin::getMaxLadderCommandPartNameOutput() const
 {
 	return RenX_LadderPlugin::max_ladder_command_part_name_output;
@@ -93,6 +103,17 @@ Jupiter::StringS FormatLadderResponse(RenX::LadderDatabase::Entry *entry, size_t
 	return Jupiter::StringS::Format("#%" PRIuPTR ": \"%.*s\" - Score: %" PRIu64 " - Kills: %" PRIu32 " - Deaths: %" PRIu32 " - KDR: %.2f - SPM: %.2f", rank, entry->most_recent_name.size(), entry->most_recent_name.ptr(), entry->total_score, entry->total_kills, entry->total_deaths, static_cast<double>(entry->total_kills) / (entry->total_deaths == 0 ? 1 : static_cast<double>(entry->total_deaths)), static_cast<double>(entry->total_score) / (entry->total_game_time == 0 ? 1.0 : static_cast<double>(entry->total_game_time)) * 60.0);
 }
 
+Jupiter::StringS FormatLadderResponse(RenX::LadderDatabase::Entry *entry, size_t rank, const RenX::LadderDatabase::SortIndex *sort)
+{
+	Jupiter::StringS result = FormatLadderResponse(entry, rank);
+	if (sort != nullptr)
+	{
+		double value = sort->value(*entry);
+		result += Jupiter::StringS::Format(" - Sorted by %.*s: %.*f", sort->name.size(), sort->name.ptr(), value == std::floor(value) ? 0 : 2, value);
+	}
+	return result;
+}
+
 // Ladder Command
 
 LadderGenericCommand::LadderGenericCommand()
@@ -101,27 +122,67 @@ LadderGenericCommand::LadderGenericCommand()
 	this->addTrigger("rank"_jrs);
 }
 
-Jupiter::GenericCommand::ResponseLine *LadderGenericCommand::trigger(const Jupiter::ReadableString &parameters)
+Jupiter::GenericCommand::ResponseLine *LadderGenericCommand::trigger(const Jupiter::ReadableString &in_parameters)
 {
-	if (parameters.isEmpty())
-		return new Jupiter::GenericCommand::ResponseLine("Error: Too few parameters. Syntax: ladder <name | rank>"_jrs, GenericCommand::DisplayType::PrivateError);
+	if (in_parameters.isEmpty())
+		return new Jupiter::GenericCommand::ResponseLine("Error: Too few parameters. Syntax: ladder [sort=<stat>] <name | rank>"_jrs, GenericCommand::DisplayType::PrivateError);
 
 	if (RenX::default_ladder_database == nullptr)
 		return new Jupiter::GenericCommand::ResponseLine("Error: No default ladder database specified."_jrs, GenericCommand::DisplayType::PrivateError);
 
+	// sort=<stat> ranks by a secondary ordering instead of by score
+	Jupiter::ReferenceString parameters = in_parameters;
+	Jupiter::ReferenceString sort_name;
+	Jupiter::ReferenceString first_word = Jupiter::ReferenceString::getWord(in_parameters, 0, WHITESPACE);
+	if (first_word.size() > 5 && Jupiter::ReferenceString(first_word.ptr(), 5).equalsi("sort="_jrs))
+	{
+		sort_name = Jupiter::ReferenceString(first_word.ptr() + 5, first_word.size() - 5);
+		parameters = Jupiter::ReferenceString::gotoWord(in_parameters, 1, WHITESPACE);
+	}
+
+	std::unique_lock<std::mutex> guard = RenX::default_ladder_database->lock();
+	const RenX::LadderDatabase::SortIndex *sort = nullptr;
+	if (sort_name.isNotEmpty() && sort_name.equalsi("score"_jrs) == false)
+	{
+		sort = RenX::default_ladder_database->getSort(sort_name);
+		if (sort == nullptr)
+			return new Jupiter::GenericCommand::ResponseLine("Error: Unknown sort"_jrs, GenericCommand::DisplayType::PrivateError);
+	}
+
 	RenX::LadderDatabase::Entry *entry;
 	size_t rank;
+	if (parameters.isEmpty())
+	{
+		// no player specified; list the top of the ordering
+		size_t count = pluginInstance.getMaxLadderCommandPartNameOutput();
+		if (count == 0)
+			count = 5;
+
+		entry = RenX::default_ladder_database->getPlayerEntryByIndex(0, sort);
+		if (entry == nullptr)
+			return new Jupiter::GenericCommand::ResponseLine("Error: No ladder data"_jrs, GenericCommand::DisplayType::PrivateError);
+
+		Jupiter::GenericCommand::ResponseLine *response_head = new Jupiter::GenericCommand::ResponseLine(FormatLadderResponse(entry, 1, sort), GenericCommand::DisplayType::PublicSuccess);
+		Jupiter::GenericCommand::ResponseLine *response_end = response_head;
+		for (rank = 2; rank <= count && (entry = RenX::default_ladder_database->getPlayerEntryByIndex(rank - 1, sort)) != nullptr; ++rank)
+		{
+			response_end->next = new Jupiter::GenericCommand::ResponseLine(FormatLadderResponse(entry, rank, sort), GenericCommand::DisplayType::PublicSuccess);
+			response_end = response_end->next;
+		}
+		return response_head;
+	}
+
 	if (parameters.span("0123456789"_jrs) == parameters.size())
 	{
 		rank = parameters.asUnsignedInt(10);
 		if (rank == 0)
 			return new Jupiter::GenericCommand::ResponseLine("Error: Invalid parameters"_jrs, GenericCommand::DisplayType::PrivateError);
 
-		entry = RenX::default_ladder_database->getPlayerEntryByIndex(rank - 1);
+		entry = RenX::default_ladder_database->getPlayerEntryByIndex(rank - 1, sort);
 		if (entry == nullptr)
 			return new Jupiter::GenericCommand::ResponseLine("Error: Player not found"_jrs, GenericCommand::DisplayType::PrivateError);
 
-		return new Jupiter::GenericCommand::ResponseLine(FormatLadderResponse(entry, rank), GenericCommand::DisplayType::PublicSuccess);
+		return new Jupiter::GenericCommand::ResponseLine(FormatLadderResponse(entry, rank, sort), GenericCommand::DisplayType::PublicSuccess);
 	}
 	
 	std::forward_list<std::pair<RenX::LadderDatabase::Entry, size_t>> list = RenX::default_ladder_database->getPlayerEntriesAndIndexByPartName(parameters, pluginInstance.getMaxLadderCommandPartNameOutput());
@@ -129,14 +190,16 @@ Jupiter::GenericCommand::ResponseLine *LadderGenericCommand::trigger(const Jupit
 		return new Jupiter::GenericCommand::ResponseLine("Error: Player not found"_jrs, GenericCommand::DisplayType::PrivateError);
 
 	std::pair<RenX::LadderDatabase::Entry, size_t> &head_pair = list.front();
-	Jupiter::GenericCommand::ResponseLine *response_head = new Jupiter::GenericCommand::ResponseLine(FormatLadderResponse(std::addressof(head_pair.first), head_pair.second + 1), GenericCommand::DisplayType::PrivateSuccess);
+	rank = sort == nullptr ? head_pair.second + 1 : RenX::default_ladder_database->getRank(head_pair.first, sort);
+	Jupiter::GenericCommand::ResponseLine *response_head = new Jupiter::GenericCommand::ResponseLine(FormatLadderResponse(std::addressof(head_pair.first), rank, sort), GenericCommand::DisplayType::PrivateSuccess);
 	Jupiter::GenericCommand::ResponseLine *response_end = response_head;
 	list.pop_front();
 
 	while (list.empty() == false)
 	{
 		std::pair<RenX::LadderDatabase::Entry, size_t> &pair = list.front();
-		response_end->next = new Jupiter::GenericCommand::ResponseLine(FormatLadderResponse(std::addressof(pair.first), pair.second + 1), GenericCommand::DisplayType::PrivateSuccess);
+		rank = sort == nullptr ? pair.second + 1 : RenX::default_ladder_database->getRank(pair.first, sort);
+		response_end->next = new Jupiter::GenericCommand::ResponseLine(FormatLadderResponse(std::addressof(pair.first), rank, sort), GenericCommand::DisplayType::PrivateSuccess);
 		response_end = response_end->next;
 		list.pop_front();
 	}
@@ -145,7 +208,7 @@ Jupiter::GenericCommand::ResponseLine *LadderGenericCommand::trigger(const Jupit
 
 const Jupiter::ReadableString &LadderGenericCommand::getHelp(const Jupiter::ReadableString &)
 {
-	static STRING_LITERAL_AS_NAMED_REFERENCE(defaultHelp, "Fetches ladder information about a player. Syntax: ladder <name | rank>");
+	static STRING_LITERAL_AS_NAMED_REFERENCE(defaultHelp, "Fetches ladder information about a player, or the top of a ladder ordering. Syntax: ladder [sort=<stat>] <name | rank>");
 	return defaultHelp;
 }
 
@@ -168,6 +231,7 @@ void LadderGameCommand::trigger(RenX::Server *source, RenX::PlayerInfo *player,
 		{
 			if (RenX::default_ladder_database != nullptr)
 			{
+				std::unique_lock<std::mutex> guard = RenX::default_ladder_database->lock();
 				std::pair<RenX::LadderDatabase::Entry *, size_t> pair = RenX::default_ladder_database->getPlayerEntryAndIndex(player->steamid);
 				if (pair.first != nullptr)
 					source->sendMessage(FormatLadderResponse(pair.first, pair.second + 1));
@@ -196,7 +260,7 @@ void LadderGameCommand::trigger(RenX::Server *source, RenX::PlayerInfo *player,
 
 const Jupiter::ReadableString &LadderGameCommand::getHelp(const Jupiter::ReadableString &)
 {
-	static STRING_LITERAL_AS_NAMED_REFERENCE(defaultHelp, "Displays ladder information about yourself, or another player. Syntax: ladder [name / rank]");
+	static STRING_LITERAL_AS_NAMED_REFERENCE(defaultHelp, "Displays ladder information about yourself, or another player. Syntax: ladder [sort=<stat>] [name / rank]");
 	return defaultHelp;
 }
 
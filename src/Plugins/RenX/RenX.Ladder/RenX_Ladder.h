@@ -39,6 +39,7 @@ public:
 	void RenX_OnServerFullyConnected(RenX::Server &server) override;
 	void RenX_OnGameOver(RenX::Server &server, RenX::WinType winType, const RenX::TeamType &team, int gScore, int nScore) override;
 	void RenX_OnCommand(RenX::Server &server, const Jupiter::ReadableString &) override;
+	int think() override;
 
 	size_t getMaxLadderCommandPartNameOutput() const;
 
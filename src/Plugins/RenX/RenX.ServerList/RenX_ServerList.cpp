@@ -152,24 +152,23 @@ bool RenX_ServerListPlugin::initialize()
 	RenX_ServerListPlugin::server_page_name = this->config.get("ServerPageName"_jrs, "server"_jrs);
 	RenX_ServerListPlugin::metadata_page_name = this->config.get("MetadataPageName"_jrs, "metadata"_jrs);
 	RenX_ServerListPlugin::metadata_prometheus_page_name = this->config.get("MetadataPrometheusPageName"_jrs, "metadata_prometheus"_jrs);
+	RenX_ServerListPlugin::list_update_interval = std::chrono::milliseconds(this->config.get<long long>("ListUpdateInterval"_jrs, 1000));
 
 	/** Initialize content */
-	Jupiter::HTTP::Server &server = getHTTPServer();
+	HTTPServerPlugin &server = getHTTPServerPlugin();
 
 	// Server list page
-	Jupiter::HTTP::Server::Content *content = new Jupiter::HTTP::Server::Content(RenX_ServerListPlugin::server_list_page_name, handle_server_list_page);
+	Jupiter::HTTP::Server::Content *content = new HTTPServerPlugin::Page(RenX_ServerListPlugin::server_list_page_name, handle_server_list_page);
 	content->language = &Jupiter::HTTP::Content::Language::ENGLISH;
 	content->type = &CONTENT_TYPE_APPLICATION_JSON;
 	content->charset = &Jupiter::HTTP::Content::Type::Text::Charset::UTF8;
-	content->free_result = false;
 	server.hook(RenX_ServerListPlugin::web_hostname, RenX_ServerListPlugin::web_path, content);
 
 	// Server list (long) page
-	content = new Jupiter::HTTP::Server::Content(RenX_ServerListPlugin::server_list_long_page_name, handle_server_list_long_page);
+	content = new HTTPServerPlugin::Page(RenX_ServerListPlugin::server_list_long_page_name, handle_server_list_long_page);
 	content->language = &Jupiter::HTTP::Content::Language::ENGLISH;
 	content->type = &CONTENT_TYPE_APPLICATION_JSON;
 	content->charset = &Jupiter::HTTP::Content::Type::Text::Charset::UTF8;
-	content->free_result = true;
 	server.hook(RenX_ServerListPlugin::web_hostname, RenX_ServerListPlugin::web_path, content);
 
 	// Server page (GUIDs)
@@ -196,16 +195,19 @@ bool RenX_ServerListPlugin::initialize()
 	content->free_result = false;
 	server.hook(RenX_ServerListPlugin::web_hostname, RenX_ServerListPlugin::web_path, content);
 
+	this->rebuildServerIndex();
 	this->updateServerList();
 	return true;
 }
 
 RenX_ServerListPlugin::~RenX_ServerListPlugin()
 {
-	Jupiter::HTTP::Server &server = getHTTPServer();
+	HTTPServerPlugin &server = getHTTPServerPlugin();
 	server.remove(RenX_ServerListPlugin::web_hostname, RenX_ServerListPlugin::web_path, RenX_ServerListPlugin::server_list_page_name);
 	server.remove(RenX_ServerListPlugin::web_hostname, RenX_ServerListPlugin::web_path, RenX_ServerListPlugin::server_list_long_page_name);
 	server.remove(RenX_ServerListPlugin::web_hostname, RenX_ServerListPlugin::web_path, RenX_ServerListPlugin::server_page_name);
+	server.remove(RenX_ServerListPlugin::web_hostname, RenX_ServerListPlugin::web_path, RenX_ServerListPlugin::metadata_page_name);
+	server.remove(RenX_ServerListPlugin::web_hostname, RenX_ServerListPlugin::web_path, RenX_ServerListPlugin::metadata_prometheus_page_name);
 }
 
 size_t RenX_ServerListPlugin::getListedPlayerCount(const RenX::Server& server) {
@@ -215,16 +217,77 @@ size_t RenX_ServerListPlugin::getListedPlayerCount(const RenX::Server& server) {
 
 Jupiter::ReadableString *RenX_ServerListPlugin::getServerListJSON()
 {
+	this->refreshServerList();
 	return &server_list_json;
 }
 
+std::shared_ptr<const HTTPServerPlugin::SharedBody> RenX_ServerListPlugin::getServerListBody()
+{
+	this->refreshServerList();
+	return server_list_body;
+}
+
+std::shared_ptr<const HTTPServerPlugin::SharedBody> RenX_ServerListPlugin::getServerListLongBody()
+{
+	this->refreshServerList();
+	if (server_list_long_body != nullptr)
+		return server_list_long_body;
+
+	Jupiter::ArrayList<RenX::Server> servers = RenX::getCore()->getServers();
+	RenX::Server *server;
+	Jupiter::String server_list_long_json(256 * servers.size());
+
+	// regenerate server_list_long_json; like server_list_json, only servers which have changed are serialized again
+
+	server_list_long_json = "["_jrs;
+
+	for (size_t index = 0; index != servers.size(); ++index)
+	{
+		server = servers.get(index);
+		if (server->isConnected() && server->isFullyConnected())
+		{
+			ServerFragment &fragment = RenX_ServerListPlugin::server_fragments[server];
+			if (fragment.long_dirty)
+			{
+				fragment.long_json = server_as_long_json(*server);
+				fragment.long_dirty = false;
+			}
+
+			if (server_list_long_json.size() != 1)
+				server_list_long_json += ',';
+			server_list_long_json += "\n\t"_jrs;
+			server_list_long_json += fragment.long_json;
+		}
+	}
+
+	server_list_long_json += "\n]"_jrs;
+
+	// kept (along with its compressed copies) until the list next changes
+	std::shared_ptr<HTTPServerPlugin::SharedBody> body = std::make_shared<HTTPServerPlugin::SharedBody>();
+	body->plain.assign(server_list_long_json.ptr(), server_list_long_json.size());
+	server_list_long_body = body;
+	return server_list_long_body;
+}
+
+void RenX_ServerListPlugin::publishServerList()
+{
+	std::shared_ptr<HTTPServerPlugin::SharedBody> body = std::make_shared<HTTPServerPlugin::SharedBody>();
+	body->plain.assign(server_list_json.ptr(), server_list_json.size());
+	server_list_body = body;
+
+	// the long list is regenerated when it is next requested
+	server_list_long_body.reset();
+}
+
 Jupiter::ReadableString *RenX_ServerListPlugin::getMetadataJSON()
 {
+	this->refreshServerList();
 	return &metadata_json;
 }
 
 Jupiter::ReadableString *RenX_ServerListPlugin::getMetadataPrometheus()
 {
+	this->refreshServerList();
 	return &metadata_prometheus;
 }
 
@@ -456,20 +519,8 @@ void RenX_ServerListPlugin::addServerToServerList(RenX::Server &server)
 {
 	Jupiter::String server_json_block(256);
 
-	// append to server_list_json
-	server_json_block = server_as_json(server);
-	if (RenX_ServerListPlugin::server_list_json.size() <= 2)
-	{
-		RenX_ServerListPlugin::server_list_json = '[';
-	}
-	else
-	{
-		RenX_ServerListPlugin::server_list_json.truncate(1); // remove trailing ']'.
-		RenX_ServerListPlugin::server_list_json += ',';
-	}
-	RenX_ServerListPlugin::server_list_json += server_json_block;
-	RenX_ServerListPlugin::server_list_json += ']';
-	server_json_block.erase();
+	// add to server_list_json when it is next assembled
+	this->markServerDirty(server);
 
 	// add to individual listing
 
@@ -557,46 +608,68 @@ void RenX_ServerListPlugin::addServerToServerList(RenX::Server &server)
 	server_json_block += '}';
 
 	server.varData[this->name].set("j"_jrs, server_json_block);
-
-	// Also update metadata so it reflects the now added server
-	updateMetadata();
 }
 
 void RenX_ServerListPlugin::updateServerList()
+{
+	// every entry is regenerated
+	RenX_ServerListPlugin::server_fragments.clear();
+	this->assembleServerList();
+}
+
+void RenX_ServerListPlugin::markServerDirty(const RenX::Server &server)
+{
+	ServerFragment &fragment = RenX_ServerListPlugin::server_fragments[&server];
+	fragment.dirty = true;
+	fragment.long_dirty = true;
+	RenX_ServerListPlugin::server_list_dirty = true;
+}
+
+void RenX_ServerListPlugin::refreshServerList()
+{
+	if (RenX_ServerListPlugin::server_list_dirty)
+		this->assembleServerList();
+}
+
+void RenX_ServerListPlugin::assembleServerList()
 {
 	Jupiter::ArrayList<RenX::Server> servers = RenX::getCore()->getServers();
-	size_t index = 0;
+	std::unordered_map<const RenX::Server *, ServerFragment> fragments;
 	RenX::Server *server;
 
-	// regenerate server_list_json
+	// regenerate server_list_json from each listed server's entry, only serializing servers which have changed
 
 	RenX_ServerListPlugin::server_list_json = '[';
 
-	while (index != servers.size())
+	for (size_t index = 0; index != servers.size(); ++index)
 	{
 		server = servers.get(index);
 		if (server->isConnected() && server->isFullyConnected())
 		{
-			RenX_ServerListPlugin::server_list_json += server_as_json(*server);
+			ServerFragment &fragment = fragments[server];
+			auto node = RenX_ServerListPlugin::server_fragments.find(server);
+			if (node != RenX_ServerListPlugin::server_fragments.end() && node->second.dirty == false)
+				fragment = std::move(node->second);
+			else
+			{
+				fragment.json = server_as_json(*server);
+				fragment.dirty = false;
+			}
 
-			++index;
-			break;
+			if (RenX_ServerListPlugin::server_list_json.size() != 1)
+				RenX_ServerListPlugin::server_list_json += ',';
+			RenX_ServerListPlugin::server_list_json += fragment.json;
 		}
-		++index;
-	}
-	while (index != servers.size())
-	{
-		server = servers.get(index);
-		if (server->isConnected() && server->isFullyConnected())
-		{
-			RenX_ServerListPlugin::server_list_json += ',';
-			RenX_ServerListPlugin::server_list_json += server_as_json(*server);
-		}
-		++index;
 	}
 
 	RenX_ServerListPlugin::server_list_json += ']';
 
+	// entries of servers which are no longer listed are dropped
+	RenX_ServerListPlugin::server_fragments = std::move(fragments);
+	RenX_ServerListPlugin::server_list_dirty = false;
+	RenX_ServerListPlugin::last_list_update = std::chrono::steady_clock::now();
+	this->publishServerList();
+
 	// Also update metadata so that it reflects any changes
 	updateMetadata();
 }
@@ -622,6 +695,54 @@ void RenX_ServerListPlugin::updateMetadata() {
 		player_count, server_count);
 }
 
+static std::string make_server_key(const Jupiter::ReadableString &address, unsigned short port)
+{
+	std::string key(address.ptr(), address.size());
+	key += ':';
+	key += std::to_string(port);
+	return key;
+}
+
+RenX::Server *RenX_ServerListPlugin::getListServer(const Jupiter::ReadableString &address, unsigned short port) const
+{
+	auto node = RenX_ServerListPlugin::server_index.find(make_server_key(address, port));
+	if (node == RenX_ServerListPlugin::server_index.end())
+		return nullptr;
+
+	return node->second;
+}
+
+void RenX_ServerListPlugin::indexServer(RenX::Server &server)
+{
+	RenX_ServerListPlugin::server_index[make_server_key(this->getListServerAddress(server), server.getPort())] = &server;
+}
+
+void RenX_ServerListPlugin::unindexServer(const RenX::Server &server)
+{
+	// searched by value, since the server's ListAddress may have changed since it was indexed
+	for (auto node = RenX_ServerListPlugin::server_index.begin(); node != RenX_ServerListPlugin::server_index.end();)
+	{
+		if (node->second == &server)
+			node = RenX_ServerListPlugin::server_index.erase(node);
+		else
+			++node;
+	}
+}
+
+void RenX_ServerListPlugin::rebuildServerIndex()
+{
+	Jupiter::ArrayList<RenX::Server> servers = RenX::getCore()->getServers();
+	RenX::Server *server;
+
+	RenX_ServerListPlugin::server_index.clear();
+	for (size_t index = 0; index != servers.size(); ++index)
+	{
+		server = servers.get(index);
+		if (server->isConnected() && server->isFullyConnected())
+			this->indexServer(*server);
+	}
+}
+
 Jupiter::ReferenceString RenX_ServerListPlugin::getListServerAddress(const RenX::Server& server) {
 	Jupiter::ReferenceString serverHostname;
 	serverHostname = server.getSocketHostname();
@@ -672,77 +793,67 @@ RenX_ServerListPlugin::ListServerInfo RenX_ServerListPlugin::getListServerInfo(c
 void RenX_ServerListPlugin::RenX_OnServerFullyConnected(RenX::Server &server)
 {
 	this->addServerToServerList(server);
+	this->indexServer(server);
 }
 
 void RenX_ServerListPlugin::RenX_OnServerDisconnect(RenX::Server &server, RenX::DisconnectReason)
 {
-	this->updateServerList();
+	// removed from server_list_json when it is next assembled
+	RenX_ServerListPlugin::server_fragments.erase(&server);
+	RenX_ServerListPlugin::server_list_dirty = true;
+	this->unindexServer(server);
 
 	// remove from individual listing
 	server.varData[this->name].remove("j"_jrs);
 }
 
-void RenX_ServerListPlugin::RenX_OnJoin(RenX::Server &, const RenX::PlayerInfo &)
+void RenX_ServerListPlugin::RenX_OnJoin(RenX::Server &server, const RenX::PlayerInfo &)
 {
-	this->updateServerList();
+	this->markServerDirty(server);
 }
 
 void RenX_ServerListPlugin::RenX_OnPart(RenX::Server &server, const RenX::PlayerInfo &)
 {
 	if (server.isTravelling() == false || server.isSeamless())
-		this->updateServerList();
+		this->markServerDirty(server);
 }
 
 void RenX_ServerListPlugin::RenX_OnMapLoad(RenX::Server &server, const Jupiter::ReadableString &map)
 {
-	this->updateServerList();
+	this->markServerDirty(server);
 }
 
-// Plugin instantiation and entry point.
-RenX_ServerListPlugin pluginInstance;
-
-Jupiter::ReadableString *handle_server_list_page(const Jupiter::ReadableString &)
+int RenX_ServerListPlugin::think()
 {
-	return pluginInstance.getServerListJSON();
+	// changes are batched; the list is reassembled at most once per interval, unless it is requested sooner
+	if (RenX_ServerListPlugin::server_list_dirty && std::chrono::steady_clock::now() - RenX_ServerListPlugin::last_list_update >= RenX_ServerListPlugin::list_update_interval)
+		this->assembleServerList();
+
+	return Jupiter::Plugin::think();
 }
 
-Jupiter::ReadableString *handle_server_list_long_page(const Jupiter::ReadableString &)
+int RenX_ServerListPlugin::OnRehash()
 {
-	Jupiter::ArrayList<RenX::Server> servers = RenX::getCore()->getServers();
-	size_t index = 0;
-	RenX::Server *server;
-	Jupiter::String *server_list_long_json = new Jupiter::String(256 * servers.size());
+	int result = RenX::Plugin::OnRehash();
 
-	// regenerate server_list_json
+	// list addresses and server info may have changed
+	this->rebuildServerIndex();
+	this->updateServerList();
 
-	*server_list_long_json = "["_jrs;
+	return result;
+}
 
-	while (index != servers.size())
-	{
-		server = servers.get(index);
-		if (server->isConnected() && server->isFullyConnected())
-		{
-			*server_list_long_json += "\n\t"_jrs;
-			*server_list_long_json += pluginInstance.server_as_long_json(*server);
-			++index;
-			break;
-		}
-		++index;
-	}
-	while (index != servers.size())
-	{
-		server = servers.get(index);
-		if (server->isConnected() && server->isFullyConnected())
-		{
-			*server_list_long_json += ",\n\t"_jrs;
-			*server_list_long_json += pluginInstance.server_as_long_json(*server);
-		}
-		++index;
-	}
+// Plugin instantiation and entry point.
+RenX_ServerListPlugin pluginInstance;
 
-	*server_list_long_json += "\n]"_jrs;
+void handle_server_list_page(const HTTPServerPlugin::Request &, HTTPServerPlugin::Response &response)
+{
+	response.shared_body = pluginInstance.getServerListBody();
+}
 
-	return server_list_long_json;
+void handle_server_list_long_page(const HTTPServerPlugin::Request &, HTTPServerPlugin::Response &response)
+{
+	response.shared_body = pluginInstance.getServerListLongBody();
 }
 
 Jupiter::ReadableString *handle_server_page(const Jupiter::ReadableString &query_string)
@@ -763,21 +874,13 @@ Jupiter::ReadableString *handle_server_page(const Jupiter::ReadableString &query
 		port = html_form_response.tableGetCast<int>("port"_jrs, port);
 	}
 
-	// search for server
-	Jupiter::ArrayList<RenX::Server> servers = RenX::getCore()->getServers();
-	size_t index = 0;
-
-	while (true)
-	{
-		if (index == servers.size())
-			return new Jupiter::ReferenceString();
-
-		server = servers.get(index);
-		if (address.equals(pluginInstance.getListServerAddress(*server)) && server->getPort() == port)
-			break;
+	if (port <= 0 || port > 65535)
+		return new Jupiter::ReferenceString();
 
-		++index;
-	}
+	// search for server
+	server = pluginInstance.getListServer(address, static_cast<unsigned short>(port));
+	if (server == nullptr)
+		return new Jupiter::ReferenceString();
 
 	// return server data
 	return new Jupiter::ReferenceString(server->varData[pluginInstance.getName()].get("j"_jrs));
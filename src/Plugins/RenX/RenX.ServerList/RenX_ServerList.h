@@ -19,9 +19,14 @@
 #if !defined _RENX_SERVERLIST_H_HEADER
 #define _RENX_SERVERLIST_H_HEADER
 
+#include <memory>
+#include <chrono>
+#include <string>
+#include <unordered_map>
 #include "Jupiter/Plugin.h"
 #include "Jupiter/Reference_String.h"
 #include "RenX_Plugin.h"
+#include "HTTPServer.h"
 
 class RenX_ServerListPlugin : public RenX::Plugin
 {
@@ -36,12 +41,54 @@ public: // RenX_ServerListPlugin
 	size_t getListedPlayerCount(const RenX::Server& server);
 
 	Jupiter::ReadableString *getServerListJSON();
+
+	/**
+	* @brief Fetches the server list as a shareable response body, which is compressed at most once per version.
+	*
+	* @return Server list
+	*/
+	std::shared_ptr<const HTTPServerPlugin::SharedBody> getServerListBody();
+
+	/**
+	* @brief Fetches the long (human-readable) server list, generating it if the list has changed since it was last requested.
+	*
+	* @return Long server list
+	*/
+	std::shared_ptr<const HTTPServerPlugin::SharedBody> getServerListLongBody();
 	Jupiter::ReadableString* getMetadataJSON();
 	Jupiter::ReadableString* getMetadataPrometheus();
 
 	void addServerToServerList(RenX::Server &server);
+
+	/**
+	* @brief Regenerates every server's entry and the server list immediately.
+	*/
 	void updateServerList();
+
+	/**
+	* @brief Marks a server's entry as out of date. The server list is reassembled after at most one ListUpdateInterval,
+	* or earlier if it is requested first.
+	*
+	* @param server Server which has changed
+	*/
+	void markServerDirty(const RenX::Server &server);
+
+	/**
+	* @brief Reassembles the server list if any server has changed since it was last assembled.
+	*/
+	void refreshServerList();
+
 	void updateMetadata();
+
+	/**
+	* @brief Fetches a listed server by the address and port it is listed under.
+	*
+	* @param address Address of the server, as listed (ListAddress)
+	* @param port Port of the server
+	* @return Listed server if one exists, nullptr otherwise.
+	*/
+	RenX::Server *getListServer(const Jupiter::ReadableString &address, unsigned short port) const;
+
 	Jupiter::ReferenceString getListServerAddress(const RenX::Server& server);
 	ListServerInfo getListServerInfo(const RenX::Server& server);
 	Jupiter::StringS server_as_json(const RenX::Server &server);
@@ -57,14 +104,40 @@ public: // RenX::Plugin
 	void RenX_OnPart(RenX::Server &server, const RenX::PlayerInfo &player) override;
 	void RenX_OnMapLoad(RenX::Server &server, const Jupiter::ReadableString &map) override;
 
+public: // Jupiter::Plugin
+	int think() override;
+	int OnRehash() override;
+
 private:
+	/** Server list entry of a single server; only regenerated once the server changes */
+	struct ServerFragment
+	{
+		Jupiter::StringS json;
+		Jupiter::StringS long_json;
+		bool dirty = true;
+		bool long_dirty = true;
+	};
+
+	void assembleServerList();
+	void publishServerList();
+	void indexServer(RenX::Server &server);
+	void unindexServer(const RenX::Server &server);
+	void rebuildServerIndex();
+
+	std::unordered_map<const RenX::Server *, ServerFragment> server_fragments;
+	std::unordered_map<std::string, RenX::Server *> server_index;
+	bool server_list_dirty = false;
+	std::chrono::steady_clock::time_point last_list_update;
+	std::chrono::milliseconds list_update_interval;
+
 	Jupiter::StringS server_list_json, metadata_json, metadata_prometheus;
+	std::shared_ptr<const HTTPServerPlugin::SharedBody> server_list_body, server_list_long_body;
 	Jupiter::StringS web_hostname, web_path;
 	Jupiter::StringS server_list_page_name, server_list_long_page_name, server_page_name, metadata_page_name, metadata_prometheus_page_name;
 };
 
-Jupiter::ReadableString *handle_server_list_page(const Jupiter::ReadableString &);
-Jupiter::ReadableString *handle_server_list_long_page(const Jupiter::ReadableString &);
+void handle_server_list_page(const HTTPServerPlugin::Request &, HTTPServerPlugin::Response &response);
+void handle_server_list_long_page(const HTTPServerPlugin::Request &, HTTPServerPlugin::Response &response);
 Jupiter::ReadableString *handle_server_page(const Jupiter::ReadableString &);
 Jupiter::ReadableString *handle_metadata_page(const Jupiter::ReadableString &);
 Jupiter::ReadableString *handle_metadata_prometheus_page(const Jupiter::ReadableString&);